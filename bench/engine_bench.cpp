@@ -0,0 +1,266 @@
+#include "../include/matching_engine.h"
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace {
+    using HeapMatchingEngine = BasicMatchingEngine<BookConfig<LevelMap, std::allocator>>;
+
+    constexpr OrderId BATCH_SIZE = 1024;
+
+    Order makePassiveOrder(Order::Side side, OrderId id) {
+        // Bids rest at or below 1000 and asks above it, so nothing ever crosses
+        Price offset = static_cast<Price>(id % 64);
+        Price price = (side == Order::Side::BUY) ? 1000 - offset : 1001 + offset;
+        return Order{
+            .side = side,
+            .type = Order::Type::LIMIT,
+            .id = id,
+            .price = price,
+            .visible_qty = 100,
+            .peak_qty = 100,
+            .hidden_qty = 0
+        };
+    }
+
+    std::vector<Order> makePassiveBatch() {
+        std::vector<Order> orders;
+        orders.reserve(BATCH_SIZE);
+        for (OrderId id = 0; id < BATCH_SIZE; ++id)
+            orders.push_back(makePassiveOrder(id % 2 ? Order::Side::SELL : Order::Side::BUY, id));
+        return orders;
+    }
+
+    // Nearest-rank percentile of an already sorted sample set
+    double percentile(const std::vector<int64_t>& sorted, double rank) {
+        auto idx = static_cast<size_t>(rank * static_cast<double>(sorted.size() - 1));
+        return static_cast<double>(sorted[idx]);
+    }
+}
+
+template <class Engine>
+static void BM_AddPassiveOrder(benchmark::State& state) {
+    Engine engine;
+    auto orders = makePassiveBatch();
+    for (auto _ : state) {
+        for (const auto& order : orders)
+            benchmark::DoNotOptimize(engine.process(order));
+
+        state.PauseTiming();
+        for (const auto& order : orders)
+            engine.cancel(order.id);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+}
+BENCHMARK_TEMPLATE(BM_AddPassiveOrder, HeapMatchingEngine);
+BENCHMARK_TEMPLATE(BM_AddPassiveOrder, MatchingEngine);
+BENCHMARK_TEMPLATE(BM_AddPassiveOrder, LadderMatchingEngine);
+
+template <class Engine>
+static void BM_CancelOrder(benchmark::State& state) {
+    Engine engine;
+    auto orders = makePassiveBatch();
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (const auto& order : orders)
+            engine.process(order);
+        state.ResumeTiming();
+
+        // Cancel from the middle of each level outwards to exercise the unlink path
+        for (OrderId id = BATCH_SIZE / 2; id < BATCH_SIZE; ++id)
+            benchmark::DoNotOptimize(engine.cancel(id));
+        for (OrderId id = 0; id < BATCH_SIZE / 2; ++id)
+            benchmark::DoNotOptimize(engine.cancel(id));
+    }
+    state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+}
+BENCHMARK_TEMPLATE(BM_CancelOrder, MatchingEngine);
+BENCHMARK_TEMPLATE(BM_CancelOrder, LadderMatchingEngine);
+BENCHMARK_TEMPLATE(BM_CancelOrder, RingMatchingEngine);
+
+template <class Engine>
+static void BM_FillIcebergs(benchmark::State& state) {
+    Engine engine;
+    auto orders = makePassiveBatch();
+    for (auto& order : orders) {
+        order.type = Order::Type::ICEBERG;
+        order.peak_qty = 10;
+        order.visible_qty = 10;
+        order.hidden_qty = 90;
+    }
+
+    OrderId next_id = BATCH_SIZE;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (const auto& order : orders)
+            engine.process(order);
+        state.ResumeTiming();
+
+        // Every fill of a peak refills the iceberg at the back of its level
+        for (auto side : {Order::Side::BUY, Order::Side::SELL}) {
+            auto sweep = makePassiveOrder(side, next_id++);
+            sweep.price = (side == Order::Side::BUY) ? 2000 : 0;
+            sweep.visible_qty = sweep.peak_qty = 100 * BATCH_SIZE / 2;
+            benchmark::DoNotOptimize(engine.process(sweep));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * BATCH_SIZE * 10);
+}
+BENCHMARK_TEMPLATE(BM_FillIcebergs, HeapMatchingEngine);
+BENCHMARK_TEMPLATE(BM_FillIcebergs, MatchingEngine);
+BENCHMARK_TEMPLATE(BM_FillIcebergs, RingMatchingEngine);
+
+// One aggressive order sweeping state.range(0) resting asks spread over 64 levels.
+// The larger book no longer fits in cache, so each fill pays for the lines its
+// resting node spans. With state.range(1) set the asks are icebergs that the
+// sweep takes one peak of, so every node is refilled in place rather than freed.
+template <class Engine>
+static void BM_DeepSweep(benchmark::State& state) {
+    auto resting_count = static_cast<OrderId>(state.range(0));
+    auto engine = std::make_unique<Engine>(static_cast<size_t>(resting_count));
+    bool icebergs = state.range(1) != 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (OrderId id = 0; id < resting_count; ++id) {
+            // Swept icebergs still rest with their refilled peak
+            engine->cancel(id);
+            auto order = makePassiveOrder(Order::Side::SELL, id);
+            if (icebergs) {
+                order.type = Order::Type::ICEBERG;
+                order.hidden_qty = order.visible_qty;
+            }
+            engine->process(order);
+        }
+        auto sweep = makePassiveOrder(Order::Side::BUY, resting_count);
+        sweep.price = 2000;
+        sweep.visible_qty = sweep.peak_qty = 100 * resting_count;
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(engine->process(sweep));
+    }
+    state.SetItemsProcessed(state.iterations() * resting_count);
+}
+BENCHMARK_TEMPLATE(BM_DeepSweep, MatchingEngine)->ArgsProduct({{1 << 12, 1 << 20}, {0, 1}});
+BENCHMARK_TEMPLATE(BM_DeepSweep, LadderMatchingEngine)->ArgsProduct({{1 << 12, 1 << 20}, {0, 1}});
+BENCHMARK_TEMPLATE(BM_DeepSweep, RingMatchingEngine)->ArgsProduct({{1 << 12, 1 << 20}, {0, 1}});
+
+// Per-order latency of quotes that rest without crossing. Each insert is timed on
+// its own, so the percentiles include clock overhead of a few tens of ns.
+template <class Engine>
+static void BM_PassiveInsertLatency(benchmark::State& state) {
+    using Clock = std::chrono::steady_clock;
+
+    Engine engine;
+    auto orders = makePassiveBatch();
+    std::vector<int64_t> samples;
+    samples.reserve(size_t{1} << 22);
+    for (auto _ : state) {
+        for (const auto& order : orders) {
+            auto start = Clock::now();
+            benchmark::DoNotOptimize(engine.process(order));
+            auto stop = Clock::now();
+            if (samples.size() < samples.capacity())
+                samples.push_back(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        }
+
+        state.PauseTiming();
+        for (const auto& order : orders)
+            engine.cancel(order.id);
+        state.ResumeTiming();
+    }
+
+    std::sort(samples.begin(), samples.end());
+    state.counters["p50_ns"] = percentile(samples, 0.50);
+    state.counters["p99_ns"] = percentile(samples, 0.99);
+    state.counters["p999_ns"] = percentile(samples, 0.999);
+    state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+}
+BENCHMARK_TEMPLATE(BM_PassiveInsertLatency, MatchingEngine);
+BENCHMARK_TEMPLATE(BM_PassiveInsertLatency, LadderMatchingEngine);
+
+// IOC orders that find nothing to trade against a resting book. Arg 1 sends them
+// with IOC, arg 0 emulates it the way a gateway without one would, sending a GTC
+// order and cancelling whatever rests.
+static void BM_ImmediateOrCancel(benchmark::State& state) {
+    MatchingEngine engine;
+    for (OrderId id = 1; id < BATCH_SIZE; id += 2)
+        engine.process(makePassiveOrder(Order::Side::SELL, id));
+
+    bool native = state.range(0);
+    std::vector<Order> orders;
+    for (OrderId id = BATCH_SIZE; id < 2 * BATCH_SIZE; ++id) {
+        orders.push_back(makePassiveOrder(Order::Side::BUY, id));
+        if (native)
+            orders.back().tif = Order::TimeInForce::IOC;
+    }
+
+    for (auto _ : state) {
+        for (const auto& order : orders) {
+            benchmark::DoNotOptimize(engine.process(order));
+            if (!native)
+                benchmark::DoNotOptimize(engine.cancel(order.id));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+}
+BENCHMARK(BM_ImmediateOrCancel)->Arg(0)->Arg(1);
+
+// FOK orders for more than the whole ask side, so the pre-check sums every level
+// before rejecting them
+template <class Engine>
+static void BM_RejectFillOrKill(benchmark::State& state) {
+    Engine engine;
+    for (OrderId id = 1; id < BATCH_SIZE; id += 2)
+        engine.process(makePassiveOrder(Order::Side::SELL, id));
+
+    auto order = makePassiveOrder(Order::Side::BUY, BATCH_SIZE);
+    order.price = 2000;
+    order.visible_qty = order.peak_qty = 100 * BATCH_SIZE;
+    order.tif = Order::TimeInForce::FOK;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(engine.process(order));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_RejectFillOrKill, MatchingEngine);
+BENCHMARK_TEMPLATE(BM_RejectFillOrKill, LadderMatchingEngine);
+
+// A cascade of 64 buy stops, one per ask level, each sweeping the level above the
+// one whose trade fired it. Arg is the number of sell stops far below the book that
+// never fire, the collect cost shouldn't grow with it.
+static void BM_StopCascade(benchmark::State& state) {
+    constexpr OrderId LEVELS = 64;
+    auto idle_stops = static_cast<OrderId>(state.range(0));
+    MatchingEngine engine(size_t{1} << 20);
+    for (OrderId id = 0; id < idle_stops; ++id) {
+        auto stop = makePassiveOrder(Order::Side::SELL, BATCH_SIZE + id);
+        stop.type = Order::Type::STOP;
+        stop.stop_price = static_cast<Price>(-1 - id % 1000);
+        engine.process(stop);
+    }
+
+    OrderId next_id = 2 * BATCH_SIZE + idle_stops;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (Price offset = 0; offset < LEVELS; ++offset) {
+            auto ask = makePassiveOrder(Order::Side::SELL, next_id++);
+            ask.price = 1001 + offset;
+            engine.process(ask);
+            auto stop = makePassiveOrder(Order::Side::BUY, next_id++);
+            stop.type = Order::Type::STOP;
+            stop.stop_price = 1000 + offset;
+            engine.process(stop);
+        }
+        auto trigger = makePassiveOrder(Order::Side::BUY, next_id++);
+        trigger.type = Order::Type::MARKET;
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(engine.process(trigger));
+    }
+    state.SetItemsProcessed(state.iterations() * LEVELS);
+}
+BENCHMARK(BM_StopCascade)->Arg(0)->Arg(1 << 16);
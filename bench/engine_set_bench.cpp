@@ -0,0 +1,53 @@
+#include "../include/matching_engine_set.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr SymbolId SYMBOL_COUNT = 256;
+    constexpr int FEED_SIZE = 1 << 18;
+
+    // Orders spread uniformly over the symbols, half of which cross
+    const std::vector<SymbolOrder>& multiSymbolFeed() {
+        static const auto feed = [] {
+            std::mt19937 gen(42);
+            std::uniform_int_distribution<SymbolId> symbol_dist(0, SYMBOL_COUNT - 1);
+            std::uniform_int_distribution<int> price_dist(990, 1010);
+            std::uniform_int_distribution<int> qty_dist(1, 100);
+
+            std::vector<SymbolOrder> orders;
+            orders.reserve(FEED_SIZE);
+            for (OrderId id = 0; id < FEED_SIZE; ++id) {
+                auto qty = qty_dist(gen);
+                orders.push_back(SymbolOrder{
+                    .symbol = symbol_dist(gen),
+                    .order = Order{
+                        .side = (gen() % 2) ? Order::Side::BUY : Order::Side::SELL,
+                        .type = Order::Type::LIMIT,
+                        .id = id,
+                        .price = static_cast<Price>(price_dist(gen)),
+                        .visible_qty = qty,
+                        .peak_qty = qty,
+                        .hidden_qty = 0
+                    }
+                });
+            }
+            return orders;
+        }();
+        return feed;
+    }
+}
+
+// Throughput of the whole feed against the number of pinned worker threads
+static void BM_MultiSymbolFeed(benchmark::State& state) {
+    const auto& feed = multiSymbolFeed();
+    for (auto _ : state) {
+        MatchingEngineSet engine_set(static_cast<size_t>(state.range(0)), {}, true);
+        for (const auto& [symbol, order] : feed)
+            engine_set.submit(symbol, order);
+        engine_set.drain();
+    }
+    state.SetItemsProcessed(state.iterations() * FEED_SIZE);
+}
+BENCHMARK(BM_MultiSymbolFeed)->RangeMultiplier(2)->Range(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
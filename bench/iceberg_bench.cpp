@@ -0,0 +1,82 @@
+#include "../include/matching_engine.h"
+
+#include <benchmark/benchmark.h>
+#include <memory>
+
+namespace {
+    constexpr Quantity ICEBERG_QTY = 100000;
+    constexpr Quantity ICEBERG_PEAK = 10;
+    constexpr Quantity REFILL_COUNT = ICEBERG_QTY / ICEBERG_PEAK;
+
+    Order makeIceberg(Order::Side side, OrderId id, Price price) {
+        return Order{
+            .side = side,
+            .type = Order::Type::ICEBERG,
+            .id = id,
+            .price = price,
+            .visible_qty = ICEBERG_PEAK,
+            .peak_qty = ICEBERG_PEAK,
+            .hidden_qty = ICEBERG_QTY - ICEBERG_PEAK
+        };
+    }
+
+    // Refills a peak the way the book side used to: copy to a new node, free the old one
+    template <class Level>
+    void refillByReallocation(Level& level) {
+        level.pushBack(level.front().order(Order::Side::SELL, level.price()));
+        level.popFront();
+    }
+
+    template <class Level>
+    void refillByRotation(Level& level) {
+        level.rotateFront();
+    }
+}
+
+template <class Allocator, void (*Refill)(PriceLevel<Allocator>&)>
+static void BM_IcebergRefill(benchmark::State& state) {
+    Allocator alloc;
+    PriceLevel<Allocator> level(100, alloc);
+    level.pushBack(makeIceberg(Order::Side::SELL, 1, 100));
+    level.pushBack(makeIceberg(Order::Side::SELL, 2, 100));
+
+    for (auto _ : state) {
+        for (Quantity refill = 0; refill < REFILL_COUNT; ++refill) {
+            auto& order = level.front();
+            order.hidden_qty += order.visible_qty;
+            Refill(level);
+        }
+        benchmark::DoNotOptimize(level.front());
+    }
+    state.SetItemsProcessed(state.iterations() * REFILL_COUNT);
+}
+BENCHMARK_TEMPLATE(BM_IcebergRefill,
+    std::allocator<OrderNode>, refillByReallocation<PriceLevel<std::allocator<OrderNode>>>);
+BENCHMARK_TEMPLATE(BM_IcebergRefill,
+    PoolAllocator<OrderNode>, refillByReallocation<PriceLevel<PoolAllocator<OrderNode>>>);
+BENCHMARK_TEMPLATE(BM_IcebergRefill,
+    PoolAllocator<OrderNode>, refillByRotation<PriceLevel<PoolAllocator<OrderNode>>>);
+
+// A single aggressive order sweeping a 100k-qty iceberg with a peak of 10
+template <class Engine>
+static void BM_SweepIceberg(benchmark::State& state) {
+    Engine engine;
+    auto aggressive_order = makeIceberg(Order::Side::BUY, 0, 100);
+    aggressive_order.type = Order::Type::LIMIT;
+    aggressive_order.visible_qty = aggressive_order.peak_qty = ICEBERG_QTY;
+    aggressive_order.hidden_qty = 0;
+
+    OrderId next_id = 1;
+    for (auto _ : state) {
+        state.PauseTiming();
+        engine.process(makeIceberg(Order::Side::SELL, next_id++, 100));
+        engine.process(makeIceberg(Order::Side::SELL, next_id++, 100));
+        aggressive_order.id = next_id++;
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(engine.process(aggressive_order));
+    }
+    state.SetItemsProcessed(state.iterations() * REFILL_COUNT);
+}
+BENCHMARK_TEMPLATE(BM_SweepIceberg, MatchingEngine);
+BENCHMARK_TEMPLATE(BM_SweepIceberg, LadderMatchingEngine);
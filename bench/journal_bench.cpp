@@ -0,0 +1,142 @@
+#include "../include/journaled_engine.h"
+#include "../include/matching_engine.h"
+#include "../include/order_flow.h"
+
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr size_t FLOW_SIZE = size_t{1} << 16;
+    // Every CANCEL_EVERY-th message cancels an older order, so long logs keep a bounded book
+    constexpr OrderId CANCEL_EVERY = 3;
+    constexpr OrderId CANCEL_LAG = 1000;
+
+    std::vector<Order> makeFlow(size_t count) {
+        OrderFlowParams params;
+        params.seed = 42;
+        OrderFlowGenerator generator(params);
+        std::vector<Order> orders;
+        orders.reserve(count);
+        for (size_t idx = 0; idx < count; ++idx)
+            orders.push_back(generator.next());
+        return orders;
+    }
+
+    std::string journalPath(const char* name) {
+        return (std::filesystem::temp_directory_path() / (std::string("lob_bench_") + name + ".jrnl"))
+            .string();
+    }
+
+    // Journals message_count messages of generated flow, returns the journal size in records
+    size_t writeJournal(const std::string& path, size_t message_count) {
+        std::filesystem::remove(path);
+        JournalWriter writer;
+        if (!writer.open(path, message_count * 2, 0))
+            return 0;
+
+        auto engine = std::make_unique<MatchingEngine>(size_t{1} << 20);
+        JournaledEngine journaled(*engine, writer);
+        OrderFlowParams params;
+        params.seed = 42;
+        OrderFlowGenerator generator(params);
+        OrderId last_id = 0;
+        for (size_t idx = 1; idx <= message_count; ++idx) {
+            if (idx % CANCEL_EVERY == 0 && last_id > CANCEL_LAG) {
+                journaled.cancel(last_id - CANCEL_LAG);
+            } else {
+                auto order = generator.next();
+                last_id = order.id;
+                journaled.process(order);
+            }
+        }
+        writer.sync();
+        return writer.size();
+    }
+}
+
+// The flow of BM_Workload, unjournaled as a baseline
+static void BM_Unjournaled(benchmark::State& state) {
+    auto orders = makeFlow(FLOW_SIZE);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto engine = std::make_unique<MatchingEngine>(FLOW_SIZE);
+        state.ResumeTiming();
+
+        for (const auto& order : orders)
+            benchmark::DoNotOptimize(engine->process(order));
+
+        state.PauseTiming();
+        engine.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * FLOW_SIZE);
+    state.counters["per_order"] = benchmark::Counter(static_cast<double>(FLOW_SIZE),
+        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+BENCHMARK(BM_Unjournaled);
+
+// Same flow with every order and trade journaled. The argument is the sync
+// interval in records, zero leaves flushing to the kernel.
+static void BM_Journaled(benchmark::State& state) {
+    auto orders = makeFlow(FLOW_SIZE);
+    auto path = journalPath("journaled");
+    auto sync_interval = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::filesystem::remove(path);
+        auto engine = std::make_unique<MatchingEngine>(FLOW_SIZE);
+        auto writer = std::make_unique<JournalWriter>();
+        if (!writer->open(path, FLOW_SIZE * 2, sync_interval)) {
+            state.SkipWithError("cannot open journal");
+            break;
+        }
+        JournaledEngine journaled(*engine, *writer);
+        state.ResumeTiming();
+
+        for (const auto& order : orders)
+            benchmark::DoNotOptimize(journaled.process(order));
+
+        state.PauseTiming();
+        writer.reset();
+        engine.reset();
+        state.ResumeTiming();
+    }
+    std::filesystem::remove(path);
+    state.SetItemsProcessed(state.iterations() * FLOW_SIZE);
+    state.counters["per_order"] = benchmark::Counter(static_cast<double>(FLOW_SIZE),
+        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+BENCHMARK(BM_Journaled)->Arg(0)->Arg(4096)->Arg(256);
+
+// Replays a journal of state.range(0) messages into a fresh engine. The journal
+// is written once up front, and only the replay is timed.
+static void BM_Recover(benchmark::State& state) {
+    auto path = journalPath("recover");
+    auto message_count = static_cast<size_t>(state.range(0));
+    auto record_count = writeJournal(path, message_count);
+    if (!record_count) {
+        state.SkipWithError("cannot write journal");
+        return;
+    }
+
+    RecoveryResult result;
+    for (auto _ : state) {
+        auto engine = std::make_unique<MatchingEngine>(size_t{1} << 20);
+        JournalReader reader;
+        reader.open(path);
+        result = recover(reader, *engine);
+
+        state.PauseTiming();
+        engine.reset();
+        state.ResumeTiming();
+    }
+    std::filesystem::remove(path);
+    if (!result.consistent || result.messages != message_count)
+        state.SkipWithError("replay diverged from the journal");
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(message_count));
+    state.counters["records"] = static_cast<double>(record_count);
+}
+BENCHMARK(BM_Recover)->Arg(100'000)->Arg(10'000'000)->Iterations(1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,68 @@
+#include "../include/market_data.h"
+
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <thread>
+
+namespace {
+    // Both sides 64 levels deep with a few orders each
+    void fillBook(MatchingEngine& engine) {
+        for (OrderId id = 0; id < 1024; ++id) {
+            auto side = (id % 2) ? Order::Side::SELL : Order::Side::BUY;
+            auto offset = static_cast<Price>(id / 2 % 64);
+            auto price = (side == Order::Side::BUY) ? 1000 - offset : 1001 + offset;
+            engine.process(Order{
+                .side = side,
+                .type = Order::Type::LIMIT,
+                .id = id,
+                .price = static_cast<Price>(price),
+                .visible_qty = 100,
+                .peak_qty = 100,
+                .hidden_qty = 0
+            });
+        }
+    }
+}
+
+// What the matching thread pays per message to keep the view current
+static void BM_PublishTopOfBook(benchmark::State& state) {
+    MatchingEngine engine;
+    fillBook(engine);
+    auto view = std::make_unique<MarketDataView>();
+    for (auto _ : state)
+        view->publish(engine);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PublishTopOfBook);
+
+// The same with a reader thread polling the view throughout
+static void BM_PublishTopOfBookWhileRead(benchmark::State& state) {
+    MatchingEngine engine;
+    fillBook(engine);
+    auto view = std::make_unique<MarketDataView>();
+    std::atomic<bool> running{true};
+    std::thread reader([&view, &running] {
+        while (running.load(std::memory_order_relaxed)) {
+            benchmark::DoNotOptimize(view->read());
+            std::this_thread::yield();
+        }
+    });
+    for (auto _ : state)
+        view->publish(engine);
+    running.store(false, std::memory_order_relaxed);
+    reader.join();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PublishTopOfBookWhileRead);
+
+static void BM_ReadTopOfBook(benchmark::State& state) {
+    MatchingEngine engine;
+    fillBook(engine);
+    auto view = std::make_unique<MarketDataView>();
+    view->publish(engine);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(view->read());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ReadTopOfBook);
@@ -0,0 +1,101 @@
+#include "../include/order_io.h"
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr int ORDER_COUNT = 4096;
+
+    std::vector<Order> makeOrders() {
+        std::vector<Order> orders;
+        for (OrderId id = 0; id < ORDER_COUNT; ++id) {
+            bool iceberg = id % 4 == 0;
+            orders.push_back(Order{
+                .side = (id % 2) ? Order::Side::SELL : Order::Side::BUY,
+                .type = iceberg ? Order::Type::ICEBERG : Order::Type::LIMIT,
+                .id = 100000 + id,
+                .price = static_cast<Price>(5000 + id % 100),
+                .visible_qty = iceberg ? 1000 : 7500,
+                .peak_qty = iceberg ? 1000 : 7500,
+                .hidden_qty = iceberg ? 99000 : 0
+            });
+        }
+        return orders;
+    }
+
+    std::string makeCsv() {
+        std::string csv;
+        char line[order_io::MAX_CSV_LINE_SIZE];
+        for (const auto& order : makeOrders())
+            csv.append(line, order_io::formatCsv(order, line));
+        return csv;
+    }
+
+    // The line parsing main used before the buffered reader
+    Order parseCsvWithStreams(std::string input) {
+        input.erase(std::remove_if(std::begin(input), std::end(input), ::isspace), std::end(input));
+        std::vector<std::string> tokens;
+        std::istringstream iss(input);
+        std::string token;
+        while (std::getline(iss, token, ','))
+            tokens.push_back(token);
+
+        Quantity qty = std::stoi(tokens[3]);
+        Quantity peak_qty = (tokens.size() > 4) ? std::stoi(tokens[4]) : qty;
+        return Order{
+            .side = (tokens[0] == "B") ? Order::Side::BUY : Order::Side::SELL,
+            .type = (tokens.size() > 4) ? Order::Type::ICEBERG : Order::Type::LIMIT,
+            .id = std::stoi(tokens[1]),
+            .price = static_cast<Price>(std::stoi(tokens[2])),
+            .visible_qty = std::min(qty, peak_qty),
+            .peak_qty = peak_qty,
+            .hidden_qty = qty - std::min(qty, peak_qty)
+        };
+    }
+}
+
+static void BM_ParseCsvWithStreams(benchmark::State& state) {
+    auto csv = makeCsv();
+    for (auto _ : state) {
+        std::istringstream input(csv);
+        std::string line;
+        while (std::getline(input, line))
+            benchmark::DoNotOptimize(parseCsvWithStreams(line));
+    }
+    state.SetItemsProcessed(state.iterations() * ORDER_COUNT);
+}
+BENCHMARK(BM_ParseCsvWithStreams);
+
+static void BM_ParseCsvFromChars(benchmark::State& state) {
+    auto csv = makeCsv();
+    for (auto _ : state) {
+        const auto* it = csv.data();
+        const auto* end = it + csv.size();
+        Order order;
+        while (it != end) {
+            const auto* line_end = static_cast<const char*>(std::memchr(it, '\n', end - it));
+            benchmark::DoNotOptimize(order_io::parseCsv(it, line_end, order));
+            it = line_end + 1;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * ORDER_COUNT);
+}
+BENCHMARK(BM_ParseCsvFromChars);
+
+static void BM_DecodeBinary(benchmark::State& state) {
+    std::vector<char> records(ORDER_COUNT * order_io::BINARY_RECORD_SIZE);
+    auto orders = makeOrders();
+    for (size_t idx = 0; idx < orders.size(); ++idx)
+        order_io::encodeBinary(orders[idx], records.data() + idx * order_io::BINARY_RECORD_SIZE);
+
+    Order order;
+    for (auto _ : state)
+        for (size_t offset = 0; offset < records.size(); offset += order_io::BINARY_RECORD_SIZE)
+            benchmark::DoNotOptimize(order_io::decodeBinary(records.data() + offset, order));
+    state.SetItemsProcessed(state.iterations() * ORDER_COUNT);
+}
+BENCHMARK(BM_DecodeBinary);
@@ -0,0 +1,102 @@
+#include "../include/matching_engine.h"
+#include "../include/output_thread.h"
+#include "../include/printer.h"
+
+#include <benchmark/benchmark.h>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+namespace {
+    // Resting orders in the book dumped, split evenly between the sides
+    constexpr OrderId BOOK_SIZE = 50'000;
+
+    // Swallows whatever it's given, so only the formatting is measured
+    class NullBuffer : public std::streambuf {
+    protected:
+        int_type overflow(int_type ch) override { return ch; }
+        std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+    };
+
+    void fillBook(MatchingEngine& engine) {
+        for (OrderId id = 0; id < BOOK_SIZE; ++id) {
+            auto side = (id % 2) ? Order::Side::SELL : Order::Side::BUY;
+            auto offset = static_cast<Price>(id % 500);
+            auto price = (side == Order::Side::BUY) ? 1000 - offset : 1001 + offset;
+            engine.process(Order{
+                .side = side,
+                .type = Order::Type::LIMIT,
+                .id = id,
+                .price = static_cast<Price>(price),
+                .visible_qty = 100 + id % 100'000,
+                .peak_qty = 100 + id % 100'000,
+                .hidden_qty = 0
+            });
+        }
+    }
+}
+
+// Dumping the book through the stream formatting of Printer::print
+static void BM_PrintBook(benchmark::State& state) {
+    MatchingEngine engine(BOOK_SIZE);
+    fillBook(engine);
+    NullBuffer null_buffer;
+    std::ostream os(&null_buffer);
+    for (auto _ : state)
+        Printer::print(engine, os);
+    state.SetItemsProcessed(state.iterations() * BOOK_SIZE);
+}
+BENCHMARK(BM_PrintBook)->Unit(benchmark::kMillisecond);
+
+// The same dump rendered into a reused buffer and written at once
+static void BM_PrintBookFast(benchmark::State& state) {
+    MatchingEngine engine(BOOK_SIZE);
+    fillBook(engine);
+    NullBuffer null_buffer;
+    std::ostream os(&null_buffer);
+    std::vector<char> buffer;
+    for (auto _ : state)
+        Printer::printFast(engine, buffer, os);
+    state.SetItemsProcessed(state.iterations() * BOOK_SIZE);
+}
+BENCHMARK(BM_PrintBookFast)->Unit(benchmark::kMillisecond);
+
+// Dumping the book from the matching thread through the output thread, which
+// formats and writes while the next dump is being copied out
+static void BM_PublishBook(benchmark::State& state) {
+    MatchingEngine engine(BOOK_SIZE);
+    fillBook(engine);
+    NullBuffer null_buffer;
+    std::ostream os(&null_buffer);
+    OutputThread output(os);
+    for (auto _ : state)
+        output.publishBook(engine);
+    state.SetItemsProcessed(state.iterations() * BOOK_SIZE);
+}
+BENCHMARK(BM_PublishBook)->Unit(benchmark::kMillisecond);
+
+// Printing trades one by one on the matching thread, as main used to
+static void BM_PrintTrades(benchmark::State& state) {
+    NullBuffer null_buffer;
+    std::ostream os(&null_buffer);
+    Trade trade{.buy_id = 1, .sell_id = 100'000, .price = 1000, .qty = 0};
+    for (auto _ : state) {
+        ++trade.qty;
+        Printer::print(trade, os);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PrintTrades);
+
+static void BM_PublishTrades(benchmark::State& state) {
+    NullBuffer null_buffer;
+    std::ostream os(&null_buffer);
+    OutputThread output(os);
+    Trade trade{.buy_id = 1, .sell_id = 100'000, .price = 1000, .qty = 0};
+    for (auto _ : state) {
+        ++trade.qty;
+        output.publishTrades({&trade, 1});
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PublishTrades);
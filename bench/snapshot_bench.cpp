@@ -0,0 +1,104 @@
+#include "../include/matching_engine.h"
+#include "../include/order_flow.h"
+
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace {
+    // Orders older than this are cancelled, so the book stays bounded however long
+    // the history gets, the way a trading day churns through orders
+    constexpr OrderId RESTING_LIMIT = 1 << 16;
+
+    std::vector<Order> makeHistory(size_t count) {
+        OrderFlowParams params;
+        params.seed = 42;
+        params.price_range = 200;
+        params.iceberg_ratio = 0.2;
+        OrderFlowGenerator generator(params);
+        std::vector<Order> orders;
+        orders.reserve(count);
+        for (size_t idx = 0; idx < count; ++idx)
+            orders.push_back(generator.next());
+        return orders;
+    }
+
+    template <class Engine>
+    void replay(Engine& engine, const std::vector<Order>& history) {
+        for (const auto& order : history) {
+            benchmark::DoNotOptimize(engine.process(order));
+            if (order.id > RESTING_LIMIT)
+                engine.cancel(order.id - RESTING_LIMIT);
+        }
+    }
+
+    std::FILE* makeSnapshot(const std::vector<Order>& history, size_t& resting_count) {
+        auto engine = std::make_unique<MatchingEngine>(RESTING_LIMIT);
+        replay(*engine, history);
+        resting_count = static_cast<size_t>(std::distance(engine->buyBegin(), engine->buyEnd())
+            + std::distance(engine->sellBegin(), engine->sellEnd()));
+
+        auto* file = std::tmpfile();
+        if (file && !engine->saveSnapshot(file)) {
+            std::fclose(file);
+            return nullptr;
+        }
+        return file;
+    }
+}
+
+// Warm start the old way: the whole history of state.range(0) orders and their
+// cancels goes back through the engine
+static void BM_WarmStartReplay(benchmark::State& state) {
+    auto history = makeHistory(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        auto engine = std::make_unique<MatchingEngine>(RESTING_LIMIT);
+        replay(*engine, history);
+
+        state.PauseTiming();
+        engine.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_WarmStartReplay)->Arg(1 << 20)->Arg(1 << 23)->Unit(benchmark::kMillisecond);
+
+static void BM_WarmStartSnapshot(benchmark::State& state) {
+    size_t resting_count = 0;
+    auto* file = makeSnapshot(makeHistory(static_cast<size_t>(state.range(0))), resting_count);
+    if (!file) {
+        state.SkipWithError("cannot write snapshot");
+        return;
+    }
+    for (auto _ : state) {
+        std::rewind(file);
+        auto engine = std::make_unique<MatchingEngine>(RESTING_LIMIT);
+        if (!engine->loadSnapshot(file)) {
+            state.SkipWithError("cannot load snapshot");
+            break;
+        }
+
+        state.PauseTiming();
+        engine.reset();
+        state.ResumeTiming();
+    }
+    std::fclose(file);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(resting_count));
+    state.counters["resting"] = static_cast<double>(resting_count);
+}
+BENCHMARK(BM_WarmStartSnapshot)->Arg(1 << 20)->Arg(1 << 23)->Unit(benchmark::kMillisecond);
+
+static void BM_SaveSnapshot(benchmark::State& state) {
+    auto engine = std::make_unique<MatchingEngine>(RESTING_LIMIT);
+    replay(*engine, makeHistory(static_cast<size_t>(state.range(0))));
+
+    auto* file = std::tmpfile();
+    for (auto _ : state) {
+        std::rewind(file);
+        benchmark::DoNotOptimize(engine->saveSnapshot(file));
+    }
+    std::fclose(file);
+}
+BENCHMARK(BM_SaveSnapshot)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,151 @@
+#include "../include/matching_engine.h"
+#include "../include/order_flow.h"
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace {
+    constexpr size_t FLOW_SIZE = size_t{1} << 16;
+
+    enum class Workload { PASSIVE_ADD, DEEP_SWEEP, ICEBERG_HEAVY, NARROW_SPREAD, WIDE_SPREAD };
+
+    OrderFlowParams makeParams(Workload workload) {
+        OrderFlowParams params;
+        params.seed = 42;
+        switch (workload) {
+        case Workload::PASSIVE_ADD:
+            params.aggressive_ratio = 0.0;
+            break;
+        case Workload::DEEP_SWEEP:
+            params.aggressive_ratio = 0.05;
+            params.sweep_depth = 20;
+            params.sweep_size_factor = 40.0;
+            break;
+        case Workload::ICEBERG_HEAVY:
+            params.aggressive_ratio = 0.3;
+            params.iceberg_ratio = 0.6;
+            break;
+        case Workload::NARROW_SPREAD:
+            params.price_range = 4;
+            params.sweep_depth = 1;
+            break;
+        case Workload::WIDE_SPREAD:
+            params.price_range = 1000;
+            params.sweep_depth = 50;
+            params.walk_probability = 0.3;
+            break;
+        }
+        return params;
+    }
+
+    // The generated flow widened to the Traits layout, so both layouts see the same orders
+    template <class Traits = DefaultOrderTraits>
+    std::vector<BasicOrder<Traits>> makeFlow(Workload workload) {
+        using Quantity = typename Traits::Quantity;
+        OrderFlowGenerator generator(makeParams(workload));
+        std::vector<BasicOrder<Traits>> orders;
+        orders.reserve(FLOW_SIZE);
+        for (size_t idx = 0; idx < FLOW_SIZE; ++idx) {
+            auto order = generator.next();
+            orders.push_back(BasicOrder<Traits>{
+                .side = order.side,
+                .type = order.type,
+                .tif = order.tif,
+                .id = static_cast<typename Traits::OrderId>(order.id),
+                .price = static_cast<typename Traits::Price>(order.price),
+                .visible_qty = static_cast<Quantity>(order.visible_qty),
+                .peak_qty = static_cast<Quantity>(order.peak_qty),
+                .hidden_qty = static_cast<Quantity>(order.hidden_qty)
+            });
+        }
+        return orders;
+    }
+}
+
+// Replays the same generated flow into a fresh engine every iteration and
+// reports orders/sec along with the time per order.
+template <class Engine, Workload WORKLOAD>
+static void BM_Workload(benchmark::State& state) {
+    auto orders = makeFlow<typename Engine::Traits>(WORKLOAD);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto engine = std::make_unique<Engine>(FLOW_SIZE);
+        state.ResumeTiming();
+
+        for (const auto& order : orders)
+            benchmark::DoNotOptimize(engine->process(order));
+
+        state.PauseTiming();
+        engine.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * FLOW_SIZE);
+    state.counters["per_order"] = benchmark::Counter(static_cast<double>(FLOW_SIZE),
+        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+BENCHMARK_TEMPLATE(BM_Workload, MatchingEngine, Workload::PASSIVE_ADD);
+BENCHMARK_TEMPLATE(BM_Workload, LadderMatchingEngine, Workload::PASSIVE_ADD);
+BENCHMARK_TEMPLATE(BM_Workload, WideMatchingEngine, Workload::PASSIVE_ADD);
+BENCHMARK_TEMPLATE(BM_Workload, MatchingEngine, Workload::DEEP_SWEEP);
+BENCHMARK_TEMPLATE(BM_Workload, LadderMatchingEngine, Workload::DEEP_SWEEP);
+BENCHMARK_TEMPLATE(BM_Workload, RingMatchingEngine, Workload::DEEP_SWEEP);
+BENCHMARK_TEMPLATE(BM_Workload, WideMatchingEngine, Workload::DEEP_SWEEP);
+BENCHMARK_TEMPLATE(BM_Workload, MatchingEngine, Workload::ICEBERG_HEAVY);
+BENCHMARK_TEMPLATE(BM_Workload, LadderMatchingEngine, Workload::ICEBERG_HEAVY);
+BENCHMARK_TEMPLATE(BM_Workload, RingMatchingEngine, Workload::ICEBERG_HEAVY);
+BENCHMARK_TEMPLATE(BM_Workload, InstrumentedMatchingEngine, Workload::ICEBERG_HEAVY);
+BENCHMARK_TEMPLATE(BM_Workload, WideMatchingEngine, Workload::ICEBERG_HEAVY);
+BENCHMARK_TEMPLATE(BM_Workload, MatchingEngine, Workload::NARROW_SPREAD);
+BENCHMARK_TEMPLATE(BM_Workload, LadderMatchingEngine, Workload::NARROW_SPREAD);
+BENCHMARK_TEMPLATE(BM_Workload, RingMatchingEngine, Workload::NARROW_SPREAD);
+BENCHMARK_TEMPLATE(BM_Workload, MatchingEngine, Workload::WIDE_SPREAD);
+BENCHMARK_TEMPLATE(BM_Workload, LadderMatchingEngine, Workload::WIDE_SPREAD);
+BENCHMARK_TEMPLATE(BM_Workload, WideMatchingEngine, Workload::WIDE_SPREAD);
+
+// Same replay through processBatch, against a loop over process() handing each
+// message's trades to the same sink, so the two differ only in the batching.
+// The sink only touches each trade.
+template <class Engine, Workload WORKLOAD, bool BATCHED>
+static void BM_WorkloadBatch(benchmark::State& state) {
+    auto orders = makeFlow(WORKLOAD);
+    Quantity traded_qty = 0;
+    auto sink = [&traded_qty](uint64_t, std::span<const Trade> trades) {
+        for (const auto& trade : trades)
+            traded_qty += trade.qty;
+    };
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto engine = std::make_unique<Engine>(FLOW_SIZE);
+        state.ResumeTiming();
+
+        if constexpr (BATCHED) {
+            benchmark::DoNotOptimize(engine->processBatch(orders, sink));
+        } else {
+            for (const auto& order : orders) {
+                const auto& trades = engine->process(order);
+                if (!trades.empty())
+                    sink(engine->sequence(), std::span<const Trade>{trades});
+            }
+        }
+
+        state.PauseTiming();
+        engine.reset();
+        state.ResumeTiming();
+    }
+    benchmark::DoNotOptimize(traded_qty);
+    state.SetItemsProcessed(state.iterations() * FLOW_SIZE);
+    state.counters["per_order"] = benchmark::Counter(static_cast<double>(FLOW_SIZE),
+        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+BENCHMARK_TEMPLATE(BM_WorkloadBatch, MatchingEngine, Workload::DEEP_SWEEP, false);
+BENCHMARK_TEMPLATE(BM_WorkloadBatch, MatchingEngine, Workload::DEEP_SWEEP, true);
+BENCHMARK_TEMPLATE(BM_WorkloadBatch, LadderMatchingEngine, Workload::DEEP_SWEEP, false);
+BENCHMARK_TEMPLATE(BM_WorkloadBatch, LadderMatchingEngine, Workload::DEEP_SWEEP, true);
+BENCHMARK_TEMPLATE(BM_WorkloadBatch, MatchingEngine, Workload::ICEBERG_HEAVY, false);
+BENCHMARK_TEMPLATE(BM_WorkloadBatch, MatchingEngine, Workload::ICEBERG_HEAVY, true);
+BENCHMARK_TEMPLATE(BM_WorkloadBatch, LadderMatchingEngine, Workload::ICEBERG_HEAVY, false);
+BENCHMARK_TEMPLATE(BM_WorkloadBatch, LadderMatchingEngine, Workload::ICEBERG_HEAVY, true);
+BENCHMARK_TEMPLATE(BM_WorkloadBatch, MatchingEngine, Workload::NARROW_SPREAD, false);
+BENCHMARK_TEMPLATE(BM_WorkloadBatch, MatchingEngine, Workload::NARROW_SPREAD, true);
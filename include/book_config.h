@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+
+#include "latency_stats.h"
+#include "level_map.h"
+#include "pool_allocator.h"
+#include "price_ladder.h"
+#include "price_level.h"
+#include "ring_price_level.h"
+#include "types.h"
+
+// A book config selects the storage behind each OrderBookSide: the container of
+// price levels and the allocator of the order nodes resting in them. The levels
+// container gets the side's price ordering as a compile-time comparator. Stats
+// receives the instrumentation hooks, NullStats compiles them out. Traits fixes
+// the integer widths of prices, quantities and order ids. Level is the FIFO of
+// orders at one price, given the node allocator.
+template <
+    template <class, class> class LevelsT = LevelMap,
+    template <class> class NodeAllocatorT = PoolAllocator,
+    class StatsT = NullStats,
+    class TraitsT = DefaultOrderTraits,
+    template <class> class LevelT = PriceLevel>
+struct BookConfig {
+    template <class Level, class Compare>
+    using Levels = LevelsT<Level, Compare>;
+
+    template <class NodeAllocator>
+    using Level = LevelT<NodeAllocator>;
+
+    template <class Node>
+    using NodeAllocator = NodeAllocatorT<Node>;
+
+    using Stats = StatsT;
+    using Traits = TraitsT;
+};
+
+using MapBookConfig = BookConfig<LevelMap>;
+using LadderBookConfig = BookConfig<PriceLadder>;
+
+using InstrumentedBookConfig = BookConfig<LevelMap, PoolAllocator, LatencyStats>;
+// The ladder needs 16-bit prices, so wide books keep their levels in a tree
+using WideBookConfig = BookConfig<LevelMap, PoolAllocator, NullStats, WideOrderTraits>;
+// Ring levels keep their own buffers, so no node pool is needed
+using RingBookConfig =
+    BookConfig<LevelMap, std::allocator, NullStats, DefaultOrderTraits, RingPriceLevel>;
+
+using DefaultBookConfig = MapBookConfig;
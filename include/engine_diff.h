@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+
+#include "order_io.h"
+#include "types.h"
+
+// Where two engines fed the same messages first disagree
+struct Divergence {
+    enum class Kind : uint8_t {
+        // Different trades, or the same ones in a different order
+        TRADES,
+        // Only one engine found the order to cancel
+        CANCEL,
+        // A level the message touched ended up different
+        DELTAS,
+        // Resting orders or waiting stops differ
+        BOOK
+    };
+
+    // Position of the message in the stream, starting at 1
+    uint64_t message;
+    Kind kind;
+    std::string detail;
+};
+
+// Feeds every message to two engines in lockstep and checks they agree, so a new
+// book layout can be proven against the current one on real or generated flow.
+// After each message the trades, or whether a cancel found its order, and the
+// deltas of both must match, which covers every level the message touched, along
+// with the order and stop counts. Every
+// full_check_interval messages, and on request, the books are also compared order
+// by order.
+template <class LhsEngine, class RhsEngine>
+class EngineDiff {
+    static_assert(std::is_same_v<typename LhsEngine::Traits, typename RhsEngine::Traits>,
+        "Both engines take the same messages");
+
+public:
+    using Order = typename LhsEngine::Order;
+    using Trade = typename LhsEngine::Trade;
+    using LevelDelta = typename LhsEngine::LevelDelta;
+    using OrderId = typename LhsEngine::OrderId;
+    using Price = typename LhsEngine::Price;
+    using Quantity = typename LhsEngine::Quantity;
+
+public:
+    // Turns on delta tracking in both engines
+    EngineDiff(LhsEngine& lhs, RhsEngine& rhs, uint64_t full_check_interval = 1) noexcept;
+    ~EngineDiff() = default;
+
+    EngineDiff(const EngineDiff&) = delete;
+    EngineDiff(EngineDiff&&) = delete;
+    EngineDiff& operator=(const EngineDiff&) = delete;
+    EngineDiff& operator=(EngineDiff&&) = delete;
+
+    // Return false once the engines have diverged, after which nothing is processed
+    bool process(const Order& order);
+    bool cancel(OrderId id);
+    bool amend(OrderId id, Price new_price, Quantity new_qty);
+    // Hands a replayed message to process, cancel or amend
+    bool apply(const OrderMessage& message);
+    bool compareBooks();
+
+    [[nodiscard]] uint64_t messageCount() const noexcept;
+    [[nodiscard]] const std::optional<Divergence>& divergence() const noexcept;
+
+private:
+    LhsEngine& lhs_;
+    RhsEngine& rhs_;
+    uint64_t full_check_interval_;
+    uint64_t message_count_{0};
+    std::optional<Divergence> divergence_;
+
+    // The checks every message ends with, once its own result matched
+    bool finishMessage();
+    bool compareTrades(std::span<const Trade> lhs, std::span<const Trade> rhs);
+    bool compareDeltas(std::span<const LevelDelta> lhs, std::span<const LevelDelta> rhs);
+    bool compareCounts();
+    template <class LhsIterator, class RhsIterator>
+    bool compareSide(OrderSide side, LhsIterator lhs_begin, LhsIterator lhs_end,
+        RhsIterator rhs_begin, RhsIterator rhs_end);
+
+    bool diverge(Divergence::Kind kind, std::string detail);
+
+    [[nodiscard]] static bool sameOrder(const Order& lhs, const Order& rhs) noexcept;
+    [[nodiscard]] static std::string orderText(const Order& order);
+
+};
+
+#include "engine_diff.inl"
@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <sstream>
+#include <utility>
+
+#include "printer.h"
+
+template <class LhsEngine, class RhsEngine>
+EngineDiff<LhsEngine, RhsEngine>::EngineDiff(
+    LhsEngine& lhs, RhsEngine& rhs, uint64_t full_check_interval) noexcept
+    : lhs_(lhs)
+    , rhs_(rhs)
+    , full_check_interval_(full_check_interval) {
+    lhs_.trackDeltas(true);
+    rhs_.trackDeltas(true);
+}
+
+template <class LhsEngine, class RhsEngine>
+bool EngineDiff<LhsEngine, RhsEngine>::process(const Order& order) {
+    if (divergence_)
+        return false;
+
+    ++message_count_;
+    const auto& lhs_trades = lhs_.process(order);
+    const auto& rhs_trades = rhs_.process(order);
+    return compareTrades(lhs_trades, rhs_trades) && finishMessage();
+}
+
+template <class LhsEngine, class RhsEngine>
+bool EngineDiff<LhsEngine, RhsEngine>::cancel(OrderId id) {
+    if (divergence_)
+        return false;
+
+    ++message_count_;
+    bool lhs_cancelled = lhs_.cancel(id);
+    bool rhs_cancelled = rhs_.cancel(id);
+    if (lhs_cancelled != rhs_cancelled) {
+        auto found = [](bool cancelled) { return cancelled ? "the order" : "nothing"; };
+        return diverge(Divergence::Kind::CANCEL, "cancel of " + std::to_string(id) + " found "
+            + found(lhs_cancelled) + "\n  vs " + found(rhs_cancelled) + "\n");
+    }
+    return finishMessage();
+}
+
+template <class LhsEngine, class RhsEngine>
+bool EngineDiff<LhsEngine, RhsEngine>::amend(OrderId id, Price new_price, Quantity new_qty) {
+    if (divergence_)
+        return false;
+
+    ++message_count_;
+    const auto& lhs_trades = lhs_.amend(id, new_price, new_qty);
+    const auto& rhs_trades = rhs_.amend(id, new_price, new_qty);
+    return compareTrades(lhs_trades, rhs_trades) && finishMessage();
+}
+
+template <class LhsEngine, class RhsEngine>
+bool EngineDiff<LhsEngine, RhsEngine>::apply(const OrderMessage& message) {
+    switch (message.kind) {
+    case OrderMessage::Kind::CANCEL:
+        return cancel(message.order.id);
+    case OrderMessage::Kind::AMEND:
+        return amend(message.order.id, message.order.price, message.order.visible_qty);
+    case OrderMessage::Kind::ORDER:
+        break;
+    }
+    return process(message.order);
+}
+
+template <class LhsEngine, class RhsEngine>
+bool EngineDiff<LhsEngine, RhsEngine>::compareBooks() {
+    if (divergence_)
+        return false;
+    return compareCounts()
+        && compareSide(OrderSide::BUY, lhs_.buyBegin(), lhs_.buyEnd(),
+            rhs_.buyBegin(), rhs_.buyEnd())
+        && compareSide(OrderSide::SELL, lhs_.sellBegin(), lhs_.sellEnd(),
+            rhs_.sellBegin(), rhs_.sellEnd());
+}
+
+template <class LhsEngine, class RhsEngine>
+ALWAYS_INLINE uint64_t EngineDiff<LhsEngine, RhsEngine>::messageCount() const noexcept {
+    return message_count_;
+}
+
+template <class LhsEngine, class RhsEngine>
+ALWAYS_INLINE auto EngineDiff<LhsEngine, RhsEngine>::divergence() const noexcept
+-> const std::optional<Divergence>& {
+    return divergence_;
+}
+
+template <class LhsEngine, class RhsEngine>
+bool EngineDiff<LhsEngine, RhsEngine>::finishMessage() {
+    if (!compareDeltas(lhs_.deltas(), rhs_.deltas()) || !compareCounts())
+        return false;
+    if (full_check_interval_ && message_count_ % full_check_interval_ == 0)
+        return compareBooks();
+    return true;
+}
+
+template <class LhsEngine, class RhsEngine>
+bool EngineDiff<LhsEngine, RhsEngine>::compareTrades(
+    std::span<const Trade> lhs, std::span<const Trade> rhs) {
+    auto same = [](const Trade& lhs_trade, const Trade& rhs_trade) {
+        return lhs_trade.buy_id == rhs_trade.buy_id && lhs_trade.sell_id == rhs_trade.sell_id
+            && lhs_trade.price == rhs_trade.price && lhs_trade.qty == rhs_trade.qty;
+    };
+    auto [lhs_iter, rhs_iter] = std::mismatch(
+        std::begin(lhs), std::end(lhs), std::begin(rhs), std::end(rhs), same);
+    if (lhs_iter == std::end(lhs) && rhs_iter == std::end(rhs))
+        return true;
+
+    std::ostringstream detail;
+    detail << "trade " << (lhs_iter - std::begin(lhs) + 1) << " of the message is ";
+    if (lhs_iter != std::end(lhs))
+        Printer::print(*lhs_iter, detail);
+    else
+        detail << "missing\n";
+    detail << "  vs ";
+    if (rhs_iter != std::end(rhs))
+        Printer::print(*rhs_iter, detail);
+    else
+        detail << "missing\n";
+    return diverge(Divergence::Kind::TRADES, detail.str());
+}
+
+template <class LhsEngine, class RhsEngine>
+bool EngineDiff<LhsEngine, RhsEngine>::compareDeltas(
+    std::span<const LevelDelta> lhs, std::span<const LevelDelta> rhs) {
+    auto same = [](const LevelDelta& lhs_delta, const LevelDelta& rhs_delta) {
+        return lhs_delta.side == rhs_delta.side && lhs_delta.price == rhs_delta.price
+            && lhs_delta.qty == rhs_delta.qty && lhs_delta.order_count == rhs_delta.order_count;
+    };
+    auto [lhs_iter, rhs_iter] = std::mismatch(
+        std::begin(lhs), std::end(lhs), std::begin(rhs), std::end(rhs), same);
+    if (lhs_iter == std::end(lhs) && rhs_iter == std::end(rhs))
+        return true;
+
+    std::ostringstream detail;
+    detail << "delta " << (lhs_iter - std::begin(lhs) + 1) << " of the message is ";
+    if (lhs_iter != std::end(lhs))
+        Printer::print(*lhs_iter, detail);
+    else
+        detail << "missing\n";
+    detail << "  vs ";
+    if (rhs_iter != std::end(rhs))
+        Printer::print(*rhs_iter, detail);
+    else
+        detail << "missing\n";
+    return diverge(Divergence::Kind::DELTAS, detail.str());
+}
+
+template <class LhsEngine, class RhsEngine>
+bool EngineDiff<LhsEngine, RhsEngine>::compareCounts() {
+    if (lhs_.orderCount() != rhs_.orderCount()) {
+        return diverge(Divergence::Kind::BOOK, "resting orders " + std::to_string(lhs_.orderCount())
+            + " vs " + std::to_string(rhs_.orderCount()) + "\n");
+    }
+    if (lhs_.stopCount() != rhs_.stopCount()) {
+        return diverge(Divergence::Kind::BOOK, "waiting stops " + std::to_string(lhs_.stopCount())
+            + " vs " + std::to_string(rhs_.stopCount()) + "\n");
+    }
+    return true;
+}
+
+template <class LhsEngine, class RhsEngine>
+template <class LhsIterator, class RhsIterator>
+bool EngineDiff<LhsEngine, RhsEngine>::compareSide(OrderSide side,
+    LhsIterator lhs_begin, LhsIterator lhs_end, RhsIterator rhs_begin, RhsIterator rhs_end) {
+    size_t depth = 1;
+    auto lhs_iter = lhs_begin;
+    auto rhs_iter = rhs_begin;
+    for (; lhs_iter != lhs_end && rhs_iter != rhs_end; ++lhs_iter, ++rhs_iter, ++depth)
+        if (!sameOrder(*lhs_iter, *rhs_iter))
+            break;
+    if (lhs_iter == lhs_end && rhs_iter == rhs_end)
+        return true;
+
+    std::ostringstream detail;
+    detail << (side == OrderSide::BUY ? "buy" : "sell") << " order " << depth << " is "
+        << (lhs_iter != lhs_end ? orderText(*lhs_iter) : "missing") << "\n  vs "
+        << (rhs_iter != rhs_end ? orderText(*rhs_iter) : "missing") << '\n';
+    return diverge(Divergence::Kind::BOOK, detail.str());
+}
+
+template <class LhsEngine, class RhsEngine>
+bool EngineDiff<LhsEngine, RhsEngine>::diverge(Divergence::Kind kind, std::string detail) {
+    divergence_ = Divergence{.message = message_count_, .kind = kind, .detail = std::move(detail)};
+    return false;
+}
+
+template <class LhsEngine, class RhsEngine>
+bool EngineDiff<LhsEngine, RhsEngine>::sameOrder(const Order& lhs, const Order& rhs) noexcept {
+    return lhs.side == rhs.side && lhs.type == rhs.type && lhs.tif == rhs.tif
+        && lhs.id == rhs.id && lhs.price == rhs.price && lhs.visible_qty == rhs.visible_qty
+        && lhs.peak_qty == rhs.peak_qty && lhs.hidden_qty == rhs.hidden_qty;
+}
+
+template <class LhsEngine, class RhsEngine>
+std::string EngineDiff<LhsEngine, RhsEngine>::orderText(const Order& order) {
+    std::ostringstream text;
+    text << "id " << order.id << " at " << order.price << ", " << order.visible_qty
+        << " visible, " << order.hidden_qty << " hidden, peak " << order.peak_qty;
+    return text.str();
+}
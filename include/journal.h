@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "types.h"
+
+// Append-only write-ahead journal in a pre-sized memory-mapped file.
+//
+// The file starts with a 64-byte header: the magic "LOBJRNL1" and the record size
+// as a little-endian uint32, the rest zero. Fixed-width 32-byte little-endian
+// records fill the remainder of the file, and an all-zero record marks the end:
+//   offset  size  field
+//        0     8  sequence number of the message
+//        8     1  kind (see JournalRecord::Kind), never zero
+//        9     1  side (0 = buy, 1 = sell)
+//       10     1  type (0 = limit, 1 = iceberg, 2 = market, 3 = stop, 4 = stop-limit)
+//       11     1  time in force (0 = GTC, 1 = IOC, 2 = FOK, 3 = post-only)
+//       12     4  price
+//       16     4  order id, or buy id of a trade
+//       20     4  sell id of a trade, or stop price of an order
+//       24     4  quantity: total, amended or traded
+//       28     4  peak quantity
+//
+// Records written to the mapping survive a crash of the process. sync() and the
+// automatic sync every sync_interval records make them survive an OS crash too.
+// Only POSIX systems are supported, elsewhere opening a journal fails.
+struct JournalRecord {
+    enum class Kind : uint8_t { ORDER = 1, CANCEL = 2, AMEND = 3, TRADE = 4 };
+
+    uint64_t seq;
+    Kind kind;
+    Order::Side side;
+    Order::Type type;
+    Order::TimeInForce tif;
+    Price price;
+    OrderId id;
+    OrderId sell_id;
+    Quantity qty;
+    Quantity peak_qty;
+};
+
+class JournalWriter {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = size_t{1} << 20;
+    static constexpr size_t DEFAULT_SYNC_INTERVAL = 4096;
+
+public:
+    JournalWriter() = default;
+    ~JournalWriter();
+
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter(JournalWriter&&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+    JournalWriter& operator=(JournalWriter&&) = delete;
+
+    // Creates the file, or reopens an existing journal and appends after its last
+    // record. The file grows by doubling once capacity records are written.
+    // A sync_interval of zero leaves syncing to explicit sync() calls.
+    bool open(const std::string& path, size_t capacity = DEFAULT_CAPACITY,
+        size_t sync_interval = DEFAULT_SYNC_INTERVAL);
+    void close();
+
+    // Returns false if the record couldn't be written. The writer is then failed
+    // and every later append returns false too, so the journal never has a gap.
+    bool append(const JournalRecord& record);
+    // Flushes every record appended since the last sync to disk
+    void sync();
+
+    [[nodiscard]] bool isOpen() const noexcept;
+    [[nodiscard]] bool failed() const noexcept;
+    [[nodiscard]] size_t size() const noexcept;
+
+private:
+    int fd_{-1};
+    char* data_{nullptr};
+    size_t capacity_{0};
+    size_t size_{0};
+    size_t synced_size_{0};
+    size_t sync_interval_{0};
+    bool failed_{false};
+
+    // Replaces the current mapping, if any, only once the new one is in place
+    bool map(size_t capacity);
+    void unmap();
+
+};
+
+// Walks the records of a journal file through a read-only mapping
+class JournalReader {
+public:
+    JournalReader() = default;
+    ~JournalReader();
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader(JournalReader&&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+    JournalReader& operator=(JournalReader&&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    // Returns false at the end of the journal
+    bool next(JournalRecord& record);
+
+private:
+    int fd_{-1};
+    const char* data_{nullptr};
+    size_t mapped_size_{0};
+    size_t capacity_{0};
+    size_t position_{0};
+
+};
+
+namespace journal_io {
+    inline constexpr size_t HEADER_SIZE = 64;
+    inline constexpr size_t RECORD_SIZE = 32;
+
+    void encode(const JournalRecord& record, char* out) noexcept;
+    [[nodiscard]] JournalRecord decode(const char* in) noexcept;
+    // False for the all-zero record that ends the journal
+    [[nodiscard]] bool isRecord(const char* in) noexcept;
+}
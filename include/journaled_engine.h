@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "journal.h"
+#include "types.h"
+
+// Write-ahead journaling in front of a matching engine. Every inbound message is
+// appended before the engine sees it, followed by the trades it produced. A
+// message that can't be journaled is rejected without reaching the engine, and
+// once the writer has failed so is every later one.
+template <class Engine>
+class JournaledEngine {
+    static_assert(std::is_same_v<typename Engine::Traits, DefaultOrderTraits>,
+        "Journal records hold the default layout");
+
+public:
+    JournaledEngine(Engine& engine, JournalWriter& writer) noexcept;
+    ~JournaledEngine() = default;
+
+    JournaledEngine(const JournaledEngine&) = delete;
+    JournaledEngine(JournaledEngine&&) = delete;
+    JournaledEngine& operator=(const JournaledEngine&) = delete;
+    JournaledEngine& operator=(JournaledEngine&&) = delete;
+
+    const std::vector<Trade>& process(const Order& order);
+    bool cancel(OrderId id);
+    const std::vector<Trade>& amend(OrderId id, Price new_price, Quantity new_qty);
+
+    // True once a message was rejected, or its trades went unjournaled, because an
+    // append failed. The trades of a rejected message are always empty.
+    [[nodiscard]] bool failed() const noexcept;
+
+    [[nodiscard]] Engine& engine() noexcept;
+    [[nodiscard]] const Engine& engine() const noexcept;
+
+private:
+    Engine& engine_;
+    JournalWriter& writer_;
+    const std::vector<Trade> no_trades_;
+
+    // A failure here leaves the message applied, which recovery takes for a
+    // writer that died mid-message
+    void appendTrades(std::span<const Trade> trades);
+
+};
+
+struct RecoveryResult {
+    // Messages replayed, not counting skipped ones
+    uint64_t messages{0};
+    uint64_t trades{0};
+    uint64_t last_seq{0};
+    // False if a journaled sequence number or trade differs from the replay
+    bool consistent{true};
+};
+
+// Brings an engine up to date by replaying the journal. Messages the engine has
+// already seen, by sequence number, are skipped, so an engine loaded from a
+// snapshot only replays the tail. Journaled trades are checked against the
+// replayed ones. Trades missing after the last message are expected when the
+// writer died mid-message.
+template <class Engine>
+RecoveryResult recover(JournalReader& reader, Engine& engine);
+
+#include "journaled_engine.inl"
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <type_traits>
+
+#include "util.h"
+
+template <class Engine>
+ALWAYS_INLINE JournaledEngine<Engine>::JournaledEngine(
+    Engine& engine, JournalWriter& writer) noexcept
+    : engine_(engine)
+    , writer_(writer) {
+}
+
+template <class Engine>
+ALWAYS_INLINE const std::vector<Trade>& JournaledEngine<Engine>::process(const Order& order) {
+    // The engine only looks at the total and the peak, see BasicMatchingEngine::match
+    bool appended = writer_.append(JournalRecord{
+        .seq = engine_.sequence() + 1,
+        .kind = JournalRecord::Kind::ORDER,
+        .side = order.side,
+        .type = order.type,
+        .tif = order.tif,
+        .price = order.price,
+        .id = order.id,
+        .sell_id = order.stop_price,
+        .qty = order.visible_qty + order.hidden_qty,
+        .peak_qty = order.peak_qty
+    });
+    if (!appended)
+        return no_trades_;
+    const auto& trades = engine_.process(order);
+    appendTrades(trades);
+    return trades;
+}
+
+template <class Engine>
+ALWAYS_INLINE bool JournaledEngine<Engine>::cancel(OrderId id) {
+    bool appended = writer_.append(JournalRecord{
+        .seq = engine_.sequence() + 1,
+        .kind = JournalRecord::Kind::CANCEL,
+        .side = Order::Side::BUY,
+        .type = Order::Type::LIMIT,
+        .tif = Order::TimeInForce::GTC,
+        .price = 0,
+        .id = id,
+        .sell_id = 0,
+        .qty = 0,
+        .peak_qty = 0
+    });
+    return appended && engine_.cancel(id);
+}
+
+template <class Engine>
+ALWAYS_INLINE const std::vector<Trade>& JournaledEngine<Engine>::amend(
+    OrderId id, Price new_price, Quantity new_qty) {
+    bool appended = writer_.append(JournalRecord{
+        .seq = engine_.sequence() + 1,
+        .kind = JournalRecord::Kind::AMEND,
+        .side = Order::Side::BUY,
+        .type = Order::Type::LIMIT,
+        .tif = Order::TimeInForce::GTC,
+        .price = new_price,
+        .id = id,
+        .sell_id = 0,
+        .qty = new_qty,
+        .peak_qty = 0
+    });
+    if (!appended)
+        return no_trades_;
+    const auto& trades = engine_.amend(id, new_price, new_qty);
+    appendTrades(trades);
+    return trades;
+}
+
+template <class Engine>
+ALWAYS_INLINE bool JournaledEngine<Engine>::failed() const noexcept {
+    return writer_.failed();
+}
+
+template <class Engine>
+ALWAYS_INLINE Engine& JournaledEngine<Engine>::engine() noexcept {
+    return engine_;
+}
+
+template <class Engine>
+ALWAYS_INLINE const Engine& JournaledEngine<Engine>::engine() const noexcept {
+    return engine_;
+}
+
+template <class Engine>
+ALWAYS_INLINE void JournaledEngine<Engine>::appendTrades(std::span<const Trade> trades) {
+    for (const auto& trade : trades) {
+        bool appended = writer_.append(JournalRecord{
+            .seq = engine_.sequence(),
+            .kind = JournalRecord::Kind::TRADE,
+            .side = Order::Side::BUY,
+            .type = Order::Type::LIMIT,
+            .tif = Order::TimeInForce::GTC,
+            .price = trade.price,
+            .id = trade.buy_id,
+            .sell_id = trade.sell_id,
+            .qty = trade.qty,
+            .peak_qty = 0
+        });
+        if (!appended)
+            return;
+    }
+}
+
+template <class Engine>
+RecoveryResult recover(JournalReader& reader, Engine& engine) {
+    static_assert(std::is_same_v<typename Engine::Traits, DefaultOrderTraits>,
+        "Journal records hold the default layout");
+    RecoveryResult result;
+    result.last_seq = engine.sequence();
+    std::span<const Trade> replayed;
+    size_t trade_idx = 0;
+
+    JournalRecord record;
+    while (reader.next(record)) {
+        if (record.seq <= result.last_seq && !result.messages)
+            continue;
+        if (record.kind == JournalRecord::Kind::TRADE) {
+            ++result.trades;
+            if (record.seq != engine.sequence() || trade_idx == replayed.size()) {
+                result.consistent = false;
+                continue;
+            }
+            const auto& trade = replayed[trade_idx++];
+            if (trade.buy_id != record.id || trade.sell_id != record.sell_id
+                || trade.price != record.price || trade.qty != record.qty)
+                result.consistent = false;
+            continue;
+        }
+
+        if (trade_idx != replayed.size() && result.messages)
+            result.consistent = false;
+        trade_idx = 0;
+        replayed = {};
+        switch (record.kind) {
+        case JournalRecord::Kind::ORDER: {
+            auto visible_qty = std::min(record.qty, record.peak_qty);
+            replayed = engine.process(Order{
+                .side = record.side,
+                .type = record.type,
+                .tif = record.tif,
+                .id = record.id,
+                .price = record.price,
+                .stop_price = static_cast<Price>(record.sell_id),
+                .visible_qty = visible_qty,
+                .peak_qty = record.peak_qty,
+                .hidden_qty = record.qty - visible_qty
+            });
+            break;
+        }
+        case JournalRecord::Kind::CANCEL:
+            engine.cancel(record.id);
+            break;
+        case JournalRecord::Kind::AMEND:
+            replayed = engine.amend(record.id, record.price, record.qty);
+            break;
+        default:
+            result.consistent = false;
+            continue;
+        }
+
+        ++result.messages;
+        if (record.seq != engine.sequence())
+            result.consistent = false;
+        result.last_seq = engine.sequence();
+    }
+    return result;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Log-linear histogram in the style of HdrHistogram. Values below 32 get exact
+// buckets, and every power of two above that is split into 32 linear buckets,
+// so a reported percentile is at most ~3% above the recorded value.
+//
+// Recording is wait-free for a single writer thread. Any thread may read a
+// consistent-enough view at the same time, since every counter is atomic.
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 5;
+
+public:
+    LatencyHistogram() = default;
+    ~LatencyHistogram() = default;
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram(LatencyHistogram&&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(LatencyHistogram&&) = delete;
+
+    void record(uint64_t value) noexcept;
+    void reset() noexcept;
+
+    [[nodiscard]] uint64_t count() const noexcept;
+    [[nodiscard]] uint64_t max() const noexcept;
+    // Upper bound of the bucket holding the given quantile in [0, 1], zero if empty
+    [[nodiscard]] uint64_t percentile(double quantile) const noexcept;
+
+private:
+    static constexpr size_t SUB_BUCKET_COUNT = size_t{1} << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+    [[nodiscard]] static size_t indexOf(uint64_t value) noexcept;
+    [[nodiscard]] static uint64_t upperBoundOf(size_t idx) noexcept;
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> max_{0};
+
+};
+
+#include "latency_histogram.inl"
@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include "util.h"
+
+namespace impl {
+    // Single-writer increment, avoids a locked read-modify-write on the hot path
+    ALWAYS_INLINE void relaxedIncrement(std::atomic<uint64_t>& counter) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
+
+ALWAYS_INLINE void LatencyHistogram::record(uint64_t value) noexcept {
+    impl::relaxedIncrement(buckets_[indexOf(value)]);
+    impl::relaxedIncrement(count_);
+    if (value > max_.load(std::memory_order_relaxed))
+        max_.store(value, std::memory_order_relaxed);
+}
+
+ALWAYS_INLINE void LatencyHistogram::reset() noexcept {
+    for (auto& bucket : buckets_)
+        bucket.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+ALWAYS_INLINE uint64_t LatencyHistogram::count() const noexcept {
+    return count_.load(std::memory_order_relaxed);
+}
+
+ALWAYS_INLINE uint64_t LatencyHistogram::max() const noexcept {
+    return max_.load(std::memory_order_relaxed);
+}
+
+inline uint64_t LatencyHistogram::percentile(double quantile) const noexcept {
+    auto total = count();
+    if (total == 0)
+        return 0;
+
+    auto rank = static_cast<uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * total));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t idx = 0; idx < BUCKET_COUNT; ++idx) {
+        seen += buckets_[idx].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return std::min(upperBoundOf(idx), max());
+    }
+    return max();
+}
+
+ALWAYS_INLINE size_t LatencyHistogram::indexOf(uint64_t value) noexcept {
+    if (value < SUB_BUCKET_COUNT)
+        return static_cast<size_t>(value);
+
+    // The top bit is implied by the group, the next SUB_BUCKET_BITS pick the bucket
+    auto shift = static_cast<unsigned>(std::bit_width(value)) - SUB_BUCKET_BITS - 1;
+    return (shift + 1) * SUB_BUCKET_COUNT + ((value >> shift) & (SUB_BUCKET_COUNT - 1));
+}
+
+ALWAYS_INLINE uint64_t LatencyHistogram::upperBoundOf(size_t idx) noexcept {
+    auto group = idx / SUB_BUCKET_COUNT;
+    auto sub_bucket = idx % SUB_BUCKET_COUNT;
+    if (group == 0)
+        return sub_bucket;
+
+    auto shift = group - 1;
+    auto lower = (SUB_BUCKET_COUNT + sub_bucket) << shift;
+    return lower + ((uint64_t{1} << shift) - 1);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "latency_histogram.h"
+
+// Code paths the instrumentation times. PROCESS, CANCEL and AMEND each time a
+// whole message.
+enum class Probe { PROCESS, MATCH, CONSUME_BEST, CANCEL, AMEND };
+
+// Work done by one processed message
+struct MessageCounters {
+    uint32_t levels_touched;
+    uint32_t orders_filled;
+    uint32_t iceberg_refills;
+};
+
+// Default instrumentation. Every hook is empty, so it compiles away entirely.
+struct NullStats {
+    static constexpr bool ENABLED = false;
+
+    struct Timer {};
+
+    [[nodiscard]] static constexpr Timer time(Probe) noexcept { return {}; }
+    static constexpr void beginMessage() noexcept {}
+    static constexpr void levelTouched() noexcept {}
+    static constexpr void orderFilled() noexcept {}
+    static constexpr void icebergRefilled() noexcept {}
+};
+
+// Records steady_clock latencies of each probe and the per-message counters into
+// histograms. When a message timer stops, the message's counters are recorded too,
+// and the slowest message so far is kept for correlating spikes with sweep depth.
+class LatencyStats {
+public:
+    static constexpr bool ENABLED = true;
+
+    using Clock = std::chrono::steady_clock;
+
+    class Timer {
+    public:
+        Timer(LatencyStats& stats, Probe probe) noexcept;
+        ~Timer();
+
+        Timer(const Timer&) = delete;
+        Timer(Timer&&) = delete;
+        Timer& operator=(const Timer&) = delete;
+        Timer& operator=(Timer&&) = delete;
+
+    private:
+        LatencyStats& stats_;
+        Probe probe_;
+        Clock::time_point start_;
+
+    };
+
+    struct SlowestMessage {
+        uint64_t latency_ns;
+        MessageCounters counters;
+    };
+
+public:
+    LatencyStats() = default;
+    ~LatencyStats() = default;
+
+    LatencyStats(const LatencyStats&) = delete;
+    LatencyStats(LatencyStats&&) = delete;
+    LatencyStats& operator=(const LatencyStats&) = delete;
+    LatencyStats& operator=(LatencyStats&&) = delete;
+
+    [[nodiscard]] Timer time(Probe probe) noexcept;
+    void beginMessage() noexcept;
+    void levelTouched() noexcept;
+    void orderFilled() noexcept;
+    void icebergRefilled() noexcept;
+
+    // Latencies in nanoseconds
+    [[nodiscard]] const LatencyHistogram& latency(Probe probe) const noexcept;
+    [[nodiscard]] const LatencyHistogram& levelsTouched() const noexcept;
+    [[nodiscard]] const LatencyHistogram& ordersFilled() const noexcept;
+    [[nodiscard]] const LatencyHistogram& icebergRefills() const noexcept;
+    // Not synchronized, read it from the thread that drives the engine
+    [[nodiscard]] const SlowestMessage& slowestMessage() const noexcept;
+
+    void reset() noexcept;
+
+private:
+    static constexpr size_t PROBE_COUNT = 5;
+
+    std::array<LatencyHistogram, PROBE_COUNT> latencies_;
+    LatencyHistogram levels_touched_;
+    LatencyHistogram orders_filled_;
+    LatencyHistogram iceberg_refills_;
+    MessageCounters message_{};
+    SlowestMessage slowest_{};
+
+    void stop(Probe probe, uint64_t latency_ns) noexcept;
+
+};
+
+#include "latency_stats.inl"
@@ -0,0 +1,74 @@
+#include "util.h"
+
+ALWAYS_INLINE LatencyStats::Timer::Timer(LatencyStats& stats, Probe probe) noexcept
+    : stats_(stats)
+    , probe_(probe)
+    , start_(Clock::now()) {
+}
+
+ALWAYS_INLINE LatencyStats::Timer::~Timer() {
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_);
+    stats_.stop(probe_, static_cast<uint64_t>(elapsed.count()));
+}
+
+ALWAYS_INLINE auto LatencyStats::time(Probe probe) noexcept -> Timer {
+    return Timer{*this, probe};
+}
+
+ALWAYS_INLINE void LatencyStats::beginMessage() noexcept {
+    message_ = MessageCounters{};
+}
+
+ALWAYS_INLINE void LatencyStats::levelTouched() noexcept {
+    ++message_.levels_touched;
+}
+
+ALWAYS_INLINE void LatencyStats::orderFilled() noexcept {
+    ++message_.orders_filled;
+}
+
+ALWAYS_INLINE void LatencyStats::icebergRefilled() noexcept {
+    ++message_.iceberg_refills;
+}
+
+ALWAYS_INLINE const LatencyHistogram& LatencyStats::latency(Probe probe) const noexcept {
+    return latencies_[static_cast<size_t>(probe)];
+}
+
+ALWAYS_INLINE const LatencyHistogram& LatencyStats::levelsTouched() const noexcept {
+    return levels_touched_;
+}
+
+ALWAYS_INLINE const LatencyHistogram& LatencyStats::ordersFilled() const noexcept {
+    return orders_filled_;
+}
+
+ALWAYS_INLINE const LatencyHistogram& LatencyStats::icebergRefills() const noexcept {
+    return iceberg_refills_;
+}
+
+ALWAYS_INLINE auto LatencyStats::slowestMessage() const noexcept -> const SlowestMessage& {
+    return slowest_;
+}
+
+inline void LatencyStats::reset() noexcept {
+    for (auto& histogram : latencies_)
+        histogram.reset();
+    levels_touched_.reset();
+    orders_filled_.reset();
+    iceberg_refills_.reset();
+    message_ = MessageCounters{};
+    slowest_ = SlowestMessage{};
+}
+
+ALWAYS_INLINE void LatencyStats::stop(Probe probe, uint64_t latency_ns) noexcept {
+    latencies_[static_cast<size_t>(probe)].record(latency_ns);
+    if (probe == Probe::MATCH || probe == Probe::CONSUME_BEST)
+        return;
+
+    levels_touched_.record(message_.levels_touched);
+    orders_filled_.record(message_.orders_filled);
+    iceberg_refills_.record(message_.iceberg_refills);
+    if (latency_ns > slowest_.latency_ns)
+        slowest_ = SlowestMessage{.latency_ns = latency_ns, .counters = message_};
+}
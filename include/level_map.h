@@ -0,0 +1,92 @@
+#pragma once
+
+#include <iterator>
+#include <map>
+
+#include "types.h"
+
+namespace impl {
+    template <class MapIterator>
+    class LevelMapIterator;
+}
+
+// Price levels kept in a tree ordered from the best to the worst price, where
+// Compare(lhs, rhs) holds if lhs is the better price.
+template <class Level, class Compare>
+class LevelMap {
+private:
+    using Allocator = typename Level::allocator_type;
+    using Price = typename Level::Price;
+    using Map = std::map<Price, Level, Compare>;
+
+public:
+    using Iterator = impl::LevelMapIterator<typename Map::const_iterator>;
+
+public:
+    explicit LevelMap(Allocator& alloc);
+    ~LevelMap() = default;
+
+    LevelMap(const LevelMap&) = delete;
+    LevelMap(LevelMap&&) = delete;
+    LevelMap& operator=(const LevelMap&) = delete;
+    LevelMap& operator=(LevelMap&&) = delete;
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] Price bestPrice() const;
+    [[nodiscard]] const Level& best() const;
+    [[nodiscard]] Level& best();
+    [[nodiscard]] Level* find(Price price);
+    [[nodiscard]] const Level* find(Price price) const;
+
+    Level& levelAt(Price price);
+    // Adds a level worse than every existing one, for building a book in price order
+    Level& appendWorst(Price price);
+    void erase(const Level& level);
+
+    [[nodiscard]] Iterator begin() const noexcept;
+    [[nodiscard]] Iterator end() const noexcept;
+
+private:
+    Allocator& alloc_;
+    Map map_;
+
+};
+
+namespace impl {
+    template <class MapIterator>
+    class LevelMapIterator {
+    public:
+        using value_type = typename MapIterator::value_type::second_type;
+        using reference = const value_type&;
+        using pointer = const value_type*;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+    public:
+        LevelMapIterator() = default;
+        LevelMapIterator(const LevelMapIterator&) = default;
+        LevelMapIterator(LevelMapIterator&&) = default;
+        LevelMapIterator& operator=(const LevelMapIterator&) = default;
+        LevelMapIterator& operator=(LevelMapIterator&&) = default;
+
+        [[nodiscard]] reference operator*() const noexcept;
+        [[nodiscard]] pointer operator->() const noexcept;
+
+        LevelMapIterator& operator++() noexcept;
+        LevelMapIterator operator++(int) noexcept;
+
+        bool operator==(const LevelMapIterator&) const = default;
+        bool operator!=(const LevelMapIterator&) const = default;
+
+    private:
+        explicit LevelMapIterator(MapIterator iter);
+
+        template <class Level, class Compare>
+        friend class ::LevelMap;
+
+        MapIterator iter_{};
+
+    };
+}
+
+#include "level_map.inl"
@@ -0,0 +1,102 @@
+#include <cassert>
+#include <iterator>
+
+#include "util.h"
+
+template <class Level, class Compare>
+ALWAYS_INLINE LevelMap<Level, Compare>::LevelMap(Allocator& alloc)
+    : alloc_(alloc) {
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE bool LevelMap<Level, Compare>::empty() const noexcept {
+    return map_.empty();
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE auto LevelMap<Level, Compare>::bestPrice() const -> Price {
+    assert(!empty());
+    return map_.cbegin()->first;
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE const Level& LevelMap<Level, Compare>::best() const {
+    assert(!empty());
+    return map_.cbegin()->second;
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE Level& LevelMap<Level, Compare>::best() {
+    assert(!empty());
+    return map_.begin()->second;
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE Level* LevelMap<Level, Compare>::find(Price price) {
+    auto iter = map_.find(price);
+    return (iter != std::end(map_)) ? &(iter->second) : nullptr;
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE const Level* LevelMap<Level, Compare>::find(Price price) const {
+    auto iter = map_.find(price);
+    return (iter != std::end(map_)) ? &(iter->second) : nullptr;
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE Level& LevelMap<Level, Compare>::levelAt(Price price) {
+    auto [iter, inserted] = map_.try_emplace(price, price, alloc_);
+    return iter->second;
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE Level& LevelMap<Level, Compare>::appendWorst(Price price) {
+    assert(map_.empty() || Compare{}(std::prev(std::end(map_))->first, price));
+    return map_.try_emplace(std::end(map_), price, price, alloc_)->second;
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE void LevelMap<Level, Compare>::erase(const Level& level) {
+    assert(level.empty());
+    map_.erase(level.price());
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE auto LevelMap<Level, Compare>::begin() const noexcept -> Iterator {
+    return Iterator{std::cbegin(map_)};
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE auto LevelMap<Level, Compare>::end() const noexcept -> Iterator {
+    return Iterator{std::cend(map_)};
+}
+
+namespace impl {
+    template <class MapIterator>
+    ALWAYS_INLINE LevelMapIterator<MapIterator>::LevelMapIterator(MapIterator iter)
+        : iter_(iter) {
+    }
+
+    template <class MapIterator>
+    ALWAYS_INLINE auto LevelMapIterator<MapIterator>::operator*() const noexcept -> reference {
+        return iter_->second;
+    }
+
+    template <class MapIterator>
+    ALWAYS_INLINE auto LevelMapIterator<MapIterator>::operator->() const noexcept -> pointer {
+        return &(operator*());
+    }
+
+    template <class MapIterator>
+    ALWAYS_INLINE auto LevelMapIterator<MapIterator>::operator++() noexcept -> LevelMapIterator& {
+        ++iter_;
+        return *this;
+    }
+
+    template <class MapIterator>
+    ALWAYS_INLINE auto LevelMapIterator<MapIterator>::operator++(int) noexcept -> LevelMapIterator {
+        LevelMapIterator tmp(*this);
+        ++(*this);
+        return tmp;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "matching_engine.h"
+#include "types.h"
+
+// The best levels of both sides as of one message, best first
+template <class Traits, size_t Depth>
+struct BasicBookTop {
+    using LevelDepth = BasicLevelDepth<Traits>;
+
+    // Sequence number of the message the levels reflect, 0 before the first
+    uint64_t seq;
+    // Levels held on each side, the rest of the arrays are zeroed
+    uint32_t bid_count;
+    uint32_t ask_count;
+    std::array<LevelDepth, Depth> bids;
+    std::array<LevelDepth, Depth> asks;
+};
+
+// Top of book published by the matching thread for any number of reader threads.
+// It's a seqlock: the writer bumps a version around each update and never waits,
+// and readers copy the levels and retry if the version moved under them. So a
+// reader always sees both sides as of the same message.
+//
+// The levels are kept as relaxed atomic words, so the racing copies are well
+// defined and the fences order them against the version.
+template <class Traits, size_t Depth = 10>
+class BasicMarketDataView {
+public:
+    using BookTop = BasicBookTop<Traits, Depth>;
+
+public:
+    BasicMarketDataView() noexcept;
+    ~BasicMarketDataView() = default;
+
+    BasicMarketDataView(const BasicMarketDataView&) = delete;
+    BasicMarketDataView(BasicMarketDataView&&) = delete;
+    BasicMarketDataView& operator=(const BasicMarketDataView&) = delete;
+    BasicMarketDataView& operator=(BasicMarketDataView&&) = delete;
+
+    // Writer side, a single thread, usually right after each process()
+    template <class Config>
+    void publish(const BasicMatchingEngine<Config>& engine) noexcept;
+    void publish(const BookTop& top) noexcept;
+
+    // Reader side, any thread. read() retries until it gets a consistent copy,
+    // tryRead() gives up if the writer is mid-update.
+    [[nodiscard]] BookTop read() const noexcept;
+    bool tryRead(BookTop& top) const noexcept;
+    // Bumped twice per publish, odd while an update is in progress
+    [[nodiscard]] uint64_t version() const noexcept;
+
+private:
+    static_assert(std::is_trivially_copyable_v<BookTop>);
+
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+    static constexpr size_t WORD_COUNT = (sizeof(BookTop) + sizeof(uint64_t) - 1)
+        / sizeof(uint64_t);
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> version_{0};
+    std::array<std::atomic<uint64_t>, WORD_COUNT> words_;
+    // Only touched by the writer, so each publish builds the levels in place
+    alignas(CACHE_LINE_SIZE) BookTop scratch_{};
+
+};
+
+using MarketDataView = BasicMarketDataView<DefaultOrderTraits>;
+
+#include "market_data.inl"
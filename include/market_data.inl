@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <thread>
+
+#include "util.h"
+
+template <class Traits, size_t Depth>
+BasicMarketDataView<Traits, Depth>::BasicMarketDataView() noexcept {
+    for (auto& word : words_)
+        word.store(0, std::memory_order_relaxed);
+}
+
+template <class Traits, size_t Depth>
+template <class Config>
+ALWAYS_INLINE void BasicMarketDataView<Traits, Depth>::publish(
+    const BasicMatchingEngine<Config>& engine) noexcept {
+    static_assert(std::is_same_v<typename Config::Traits, Traits>);
+
+    auto bid_count = engine.topN(OrderSide::BUY, std::span{scratch_.bids});
+    auto ask_count = engine.topN(OrderSide::SELL, std::span{scratch_.asks});
+    // Clears what a deeper book left behind
+    std::fill(std::begin(scratch_.bids) + bid_count, std::end(scratch_.bids),
+        typename BookTop::LevelDepth{});
+    std::fill(std::begin(scratch_.asks) + ask_count, std::end(scratch_.asks),
+        typename BookTop::LevelDepth{});
+    scratch_.seq = engine.sequence();
+    scratch_.bid_count = static_cast<uint32_t>(bid_count);
+    scratch_.ask_count = static_cast<uint32_t>(ask_count);
+    publish(scratch_);
+}
+
+template <class Traits, size_t Depth>
+ALWAYS_INLINE void BasicMarketDataView<Traits, Depth>::publish(const BookTop& top) noexcept {
+    std::array<uint64_t, WORD_COUNT> words{};
+    std::memcpy(words.data(), &top, sizeof(BookTop));
+
+    auto version = version_.load(std::memory_order_relaxed);
+    version_.store(version + 1, std::memory_order_relaxed);
+    // Keeps the stores below from becoming visible before the odd version
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t idx = 0; idx < WORD_COUNT; ++idx)
+        words_[idx].store(words[idx], std::memory_order_relaxed);
+    version_.store(version + 2, std::memory_order_release);
+}
+
+template <class Traits, size_t Depth>
+ALWAYS_INLINE auto BasicMarketDataView<Traits, Depth>::read() const noexcept -> BookTop {
+    BookTop top;
+    while (!tryRead(top))
+        std::this_thread::yield();
+    return top;
+}
+
+template <class Traits, size_t Depth>
+ALWAYS_INLINE bool BasicMarketDataView<Traits, Depth>::tryRead(BookTop& top) const noexcept {
+    auto before = version_.load(std::memory_order_acquire);
+    if (before & 1)
+        return false;
+
+    std::array<uint64_t, WORD_COUNT> words;
+    for (size_t idx = 0; idx < WORD_COUNT; ++idx)
+        words[idx] = words_[idx].load(std::memory_order_relaxed);
+    // Keeps the loads above from moving past the second version check
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (version_.load(std::memory_order_relaxed) != before)
+        return false;
+
+    std::memcpy(&top, words.data(), sizeof(BookTop));
+    return true;
+}
+
+template <class Traits, size_t Depth>
+ALWAYS_INLINE uint64_t BasicMarketDataView<Traits, Depth>::version() const noexcept {
+    return version_.load(std::memory_order_acquire);
+}
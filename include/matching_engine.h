@@ -1,40 +1,184 @@
 #pragma once
 
+#include <cstdint>
+#include <cstdio>
+#include <span>
 #include <vector>
 
 #include "order_book_side.h"
+#include "snapshot.h"
+#include "trade_sink.h"
+#include "trigger_book.h"
 
-class MatchingEngine {
+template <class Config>
+class BasicMatchingEngine {
 public:
-    using Iterator = OrderBookSide::Iterator;
+    using Traits = typename Config::Traits;
+    using Order = BasicOrder<Traits>;
+    using Trade = BasicTrade<Traits>;
+    using LevelDepth = BasicLevelDepth<Traits>;
+    using LevelDelta = BasicLevelDelta<Traits>;
+    using Price = typename Traits::Price;
+    using Quantity = typename Traits::Quantity;
+    using OrderId = typename Traits::OrderId;
+
+private:
+    using BuySide = OrderBookSide<Config, Order::Side::BUY>;
+    using SellSide = OrderBookSide<Config, Order::Side::SELL>;
+    using OrderNode = typename BuySide::OrderNode;
+
+public:
+    using BuyIterator = typename BuySide::Iterator;
+    using SellIterator = typename SellSide::Iterator;
+    using NodeAllocator = typename BuySide::NodeAllocator;
+    using Stats = typename Config::Stats;
+
+    static constexpr size_t DEFAULT_ORDER_CAPACITY = size_t{1} << 14;
 
 public:
-    MatchingEngine();
-    ~MatchingEngine() = default;
+    // The capacity hint presizes the order index and, if the node allocator
+    // supports it, the node pool for that many resting orders.
+    explicit BasicMatchingEngine(size_t order_capacity = DEFAULT_ORDER_CAPACITY);
+    ~BasicMatchingEngine() = default;
 
-    MatchingEngine(MatchingEngine&) = delete;
-    MatchingEngine(MatchingEngine&&) = delete;
-    MatchingEngine& operator=(MatchingEngine&) = delete;
-    MatchingEngine& operator=(MatchingEngine&&) = delete;
+    BasicMatchingEngine(BasicMatchingEngine&) = delete;
+    BasicMatchingEngine(BasicMatchingEngine&&) = delete;
+    BasicMatchingEngine& operator=(BasicMatchingEngine&) = delete;
+    BasicMatchingEngine& operator=(BasicMatchingEngine&&) = delete;
 
+    // Matches the order and rests what's left unless its type or time in force
+    // says otherwise. A rejected FOK or post-only order leaves the book untouched
+    // and returns no trades, and so does an order whose id is already resting or
+    // waiting as a stop. The price of a market order is ignored.
+    //
+    // A stop order waits in the trigger book until a trade reaches its stop price,
+    // or enters at once if the last trade already has. Stops set off by this
+    // message's trades run within it, each after the order whose trade fired it,
+    // and the returned trades include theirs.
     const std::vector<Trade>& process(Order aggressive_order);
+    // Processes the orders in turn and hands each message's trades to the sink
+    // with its sequence number. The contra side's best level for the next order is
+    // prefetched while the current one matches. Returns the number of trades.
+    // A convenience over calling process() in a loop: every message still needs
+    // its own setup, and BM_WorkloadBatch shows no gain from batching.
+    template <TradeSink<BasicTrade<typename Config::Traits>> Sink>
+    size_t processBatch(std::span<const Order> orders, Sink& sink);
+
+    // Removes a resting order or a waiting stop. Returns false if there's neither
+    // with the given id.
+    bool cancel(OrderId id);
+    // Lowering the quantity at the same price keeps time priority. Any other change
+    // re-enters the order as a new aggressive order with its time in force, so it
+    // may trade, or drop out if it's post-only and would cross. Amending an unknown
+    // id is a no-op, and so is amending a waiting stop. A non-positive quantity
+    // cancels the order.
+    const std::vector<Trade>& amend(OrderId id, Price new_price, Quantity new_qty);
+
+    [[nodiscard]] bool contains(OrderId id) const;
+    // Number of orders resting in the book, both sides together
+    [[nodiscard]] size_t orderCount() const noexcept;
+    // Number of orders resting on one side, walks its levels
+    [[nodiscard]] size_t orderCount(Order::Side side) const;
+    // Number of stop orders waiting to fire
+    [[nodiscard]] size_t stopCount() const noexcept;
+    // Every message, including cancels and amends, takes the next number starting at 1
+    [[nodiscard]] uint64_t sequence() const noexcept;
+
+    // Writes both sides in price-time order along with the waiting stops, the last
+    // trade price and the sequence number, in the format described in snapshot.h,
+    // which only holds the default layout. Returns false if the write fails.
+    bool saveSnapshot(std::FILE* file) const;
+    // Restores a snapshot into an engine that hasn't processed anything yet. Each
+    // level is built in one pass instead of matching order by order. Returns false
+    // and leaves the engine untouched if the snapshot is truncated, out of order or
+    // holds an id twice.
+    bool loadSnapshot(std::FILE* file);
 
-    Iterator buyBegin() const noexcept;
-    Iterator buyEnd() const noexcept;
+    [[nodiscard]] const NodeAllocator& nodeAllocator() const noexcept;
+    [[nodiscard]] const Stats& stats() const noexcept;
 
-    Iterator sellBegin() const noexcept;
-    Iterator sellEnd() const noexcept;
+    // Top of book served from the cached best levels, zero order count if a side is empty
+    [[nodiscard]] LevelDepth bestBid() const noexcept;
+    [[nodiscard]] LevelDepth bestAsk() const noexcept;
+    // Aggregated depth read from per-level running totals, never by walking orders
+    [[nodiscard]] LevelDepth depthAt(Order::Side side, Price price) const;
+    size_t topN(Order::Side side, std::span<LevelDepth> out) const;
+    [[nodiscard]] std::vector<LevelDepth> topN(Order::Side side, size_t n) const;
+
+    // When enabled, every message reports the new state of each level it touched
+    void trackDeltas(bool enabled) noexcept;
+    [[nodiscard]] const std::vector<LevelDelta>& deltas() const noexcept;
+
+    BuyIterator buyBegin() const noexcept;
+    BuyIterator buyEnd() const noexcept;
+
+    SellIterator sellBegin() const noexcept;
+    SellIterator sellEnd() const noexcept;
 
 private:
-    OrderBookSide buy_side_;
-    OrderBookSide sell_side_;
+    NodeAllocator node_alloc_;
+    Stats stats_;
+    typename BuySide::OrderIndex order_index_;
+    BuySide buy_side_;
+    SellSide sell_side_;
     std::vector<Trade> trades_;
-    std::unordered_map<OrderId, size_t> passive_id_idx_;
+    std::vector<LevelDelta> deltas_;
+    bool track_deltas_{false};
+    uint64_t seq_{0};
+    TriggerBook<Traits> trigger_book_;
+    // Stops fired within the current message, in the order they run
+    std::vector<Order> fired_stops_;
+    Price last_trade_price_{0};
+    bool has_traded_{false};
+
+    static NodeAllocator makeNodeAllocator(size_t order_capacity);
 
-    void match(Order& aggressive_order, OrderBookSide& contra_side);
+    // Encodes one side's orders grouped by level and returns the level count
+    template <class Iterator>
+    static uint32_t encodeSide(Iterator begin, Iterator end, std::vector<char>& buffer);
+    // Walks level_count encoded levels from in, checking their ordering and orders.
+    // Builds them into the book only if build is set, otherwise collects their ids.
+    template <OrderSide SIDE>
+    bool loadSide(const char*& in, const char* end, uint32_t level_count, uint64_t& order_count,
+        bool build, std::vector<OrderId>& ids);
 
-    void addTrade(const Order& aggressive_order, const Order& passive_order, Quantity qty);
+    void beginMessage();
+    void endMessage();
+
+    // Parks a stop order or runs any order, then the stops its trades set off
+    void submit(Order& aggressive_order);
+    void fireStops();
+    // Turns a fired stop into the order it enters the book as
+    static void activateStop(Order& order) noexcept;
+    // Dispatches once on the order's side, everything below runs side-specialized
+    void execute(Order& aggressive_order);
+    template <OrderSide SIDE>
+    void execute(Order& aggressive_order);
+    template <OrderSide SIDE>
+    void match(Order& aggressive_order);
+    void touchLevel(Order::Side side, Price price);
+
+    template <OrderSide SIDE>
+    [[nodiscard]] auto& bookSide() noexcept;
+    template <OrderSide SIDE>
+    [[nodiscard]] const auto& bookSide() const noexcept;
+    // Calls fn with the book side selected by a runtime side
+    template <class Fn>
+    decltype(auto) visitSide(Order::Side side, Fn&& fn);
+    template <class Fn>
+    decltype(auto) visitSide(Order::Side side, Fn&& fn) const;
+
+    // The trade against the passive order in this message. Created with zero
+    // quantity on the first fill; later fills of a refilled iceberg merge into it.
+    template <OrderSide SIDE>
+    Trade& tradeWith(const Order& aggressive_order, OrderNode& passive_node, Price passive_price);
 
 };
 
+using MatchingEngine = BasicMatchingEngine<DefaultBookConfig>;
+using LadderMatchingEngine = BasicMatchingEngine<LadderBookConfig>;
+using InstrumentedMatchingEngine = BasicMatchingEngine<InstrumentedBookConfig>;
+using WideMatchingEngine = BasicMatchingEngine<WideBookConfig>;
+using RingMatchingEngine = BasicMatchingEngine<RingBookConfig>;
+
 #include "matching_engine.inl"
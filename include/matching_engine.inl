@@ -1,77 +1,571 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
 #include <utility>
 #include <tuple>
+#include <type_traits>
 
 #include "util.h"
 
-ALWAYS_INLINE MatchingEngine::MatchingEngine()
-    : buy_side_(true)
-    , sell_side_(false) {
+template <class Config>
+ALWAYS_INLINE BasicMatchingEngine<Config>::BasicMatchingEngine(size_t order_capacity)
+    : node_alloc_(makeNodeAllocator(order_capacity))
+    , buy_side_(order_index_, node_alloc_, stats_)
+    , sell_side_(order_index_, node_alloc_, stats_) {
+    order_index_.reserve(order_capacity);
 }
 
-ALWAYS_INLINE const std::vector<Trade>& MatchingEngine::process(Order aggressive_order) {
-    trades_.clear();
-    passive_id_idx_.clear();
-
-    auto [contra_side, same_side] = (aggressive_order.side == Order::Side::BUY)
-        ? std::tie(sell_side_, buy_side_)
-        : std::tie(buy_side_, sell_side_);
-    match(aggressive_order, contra_side);
-    if (aggressive_order.visible_qty)
-        same_side.addOrder(aggressive_order);
+template <class Config>
+ALWAYS_INLINE auto BasicMatchingEngine<Config>::process(Order aggressive_order)
+-> const std::vector<Trade>& {
+    [[maybe_unused]] auto timer = stats_.time(Probe::PROCESS);
+    beginMessage();
+    // A second order under a resting or waiting id would leave the index naming
+    // the first
+    if (!order_index_.contains(aggressive_order.id) && (trigger_book_.empty()
+        || !trigger_book_.contains(aggressive_order.id))) [[likely]]
+        submit(aggressive_order);
+    endMessage();
     return trades_;
 }
 
-ALWAYS_INLINE void MatchingEngine::match(Order& aggressive_order, OrderBookSide& contra_side) {
-    bool is_buy_order = aggressive_order.side == Order::Side::BUY;
-    assert(is_buy_order != contra_side.isBuy());
+template <class Config>
+template <TradeSink<BasicTrade<typename Config::Traits>> Sink>
+ALWAYS_INLINE size_t BasicMatchingEngine<Config>::processBatch(
+    std::span<const Order> orders, Sink& sink) {
+    size_t trade_count = 0;
+    for (size_t idx = 0; idx < orders.size(); ++idx) {
+        if (idx + 1 < orders.size()) {
+            if (orders[idx + 1].side == Order::Side::BUY)
+                sell_side_.prefetchBest();
+            else
+                buy_side_.prefetchBest();
+        }
+
+        process(orders[idx]);
+        if (!trades_.empty()) {
+            sink(seq_, std::span<const Trade>{trades_});
+            trade_count += trades_.size();
+        }
+    }
+    return trade_count;
+}
+
+template <class Config>
+ALWAYS_INLINE bool BasicMatchingEngine<Config>::cancel(OrderId id) {
+    [[maybe_unused]] auto timer = stats_.time(Probe::CANCEL);
+    beginMessage();
+
+    auto iter = order_index_.find(id);
+    if (iter == std::end(order_index_)) {
+        auto cancelled = !trigger_book_.empty() && trigger_book_.cancel(id);
+        endMessage();
+        return cancelled;
+    }
+
+    auto location = iter->second;
+    touchLevel(location.side, location.price);
+    visitSide(location.side, [&location](auto& side) { side.removeOrder(location); });
+    endMessage();
+    return true;
+}
+
+template <class Config>
+ALWAYS_INLINE auto BasicMatchingEngine<Config>::amend(
+    OrderId id, Price new_price, Quantity new_qty) -> const std::vector<Trade>& {
+    [[maybe_unused]] auto timer = stats_.time(Probe::AMEND);
+    beginMessage();
+
+    auto iter = order_index_.find(id);
+    if (iter == std::end(order_index_))
+        return trades_;
+
+    auto location = iter->second;
+    auto order = visitSide(location.side,
+        [&location](const auto& side) { return side.restingOrder(location); });
+    touchLevel(order.side, order.price);
+    if (new_qty > 0 && new_price == order.price && new_qty <= order.visible_qty + order.hidden_qty) {
+        visitSide(order.side,
+            [&location, new_qty](auto& side) { side.reduceOrder(location, new_qty); });
+    } else {
+        visitSide(order.side, [&location](auto& side) { side.removeOrder(location); });
+        if (new_qty > 0) {
+            if (order.type == Order::Type::LIMIT)
+                order.peak_qty = new_qty;
+            order.price = new_price;
+            order.visible_qty = std::min(new_qty, order.peak_qty);
+            order.hidden_qty = new_qty - order.visible_qty;
+            submit(order);
+        }
+    }
+
+    endMessage();
+    return trades_;
+}
+
+template <class Config>
+ALWAYS_INLINE bool BasicMatchingEngine<Config>::contains(OrderId id) const {
+    return order_index_.contains(id);
+}
+
+template <class Config>
+ALWAYS_INLINE size_t BasicMatchingEngine<Config>::orderCount() const noexcept {
+    return order_index_.size();
+}
+
+template <class Config>
+ALWAYS_INLINE size_t BasicMatchingEngine<Config>::orderCount(Order::Side side) const {
+    return visitSide(side, [](const auto& book_side) { return book_side.orderCount(); });
+}
+
+template <class Config>
+ALWAYS_INLINE size_t BasicMatchingEngine<Config>::stopCount() const noexcept {
+    return trigger_book_.size();
+}
+
+template <class Config>
+ALWAYS_INLINE uint64_t BasicMatchingEngine<Config>::sequence() const noexcept {
+    return seq_;
+}
+
+template <class Config>
+bool BasicMatchingEngine<Config>::saveSnapshot(std::FILE* file) const {
+    static_assert(std::is_same_v<Traits, DefaultOrderTraits>, "Snapshots hold the default layout");
+    std::vector<char> buffer(snapshot_io::HEADER_SIZE);
+    buffer.reserve(snapshot_io::HEADER_SIZE
+        + order_index_.size() * (snapshot_io::LEVEL_HEADER_SIZE + snapshot_io::ORDER_SIZE));
+    snapshot_io::Header header{.seq = seq_, .order_count = order_index_.size(),
+        .buy_level_count = 0, .sell_level_count = 0, .stop_count = trigger_book_.size(),
+        .last_trade_price = last_trade_price_, .has_traded = has_traded_};
+    header.buy_level_count = encodeSide(buyBegin(), buyEnd(), buffer);
+    header.sell_level_count = encodeSide(sellBegin(), sellEnd(), buffer);
+    trigger_book_.forEach([&buffer](const Order& order) {
+        auto offset = buffer.size();
+        buffer.resize(offset + snapshot_io::STOP_SIZE);
+        snapshot_io::encodeStop(order, buffer.data() + offset);
+    });
+    snapshot_io::encodeHeader(header, buffer.data());
+
+    return std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size()
+        && std::fflush(file) == 0;
+}
+
+template <class Config>
+bool BasicMatchingEngine<Config>::loadSnapshot(std::FILE* file) {
+    static_assert(std::is_same_v<Traits, DefaultOrderTraits>, "Snapshots hold the default layout");
+    assert(seq_ == 0 && order_index_.empty() && trigger_book_.empty());
+
+    char header_bytes[snapshot_io::HEADER_SIZE];
+    snapshot_io::Header header;
+    if (std::fread(header_bytes, 1, sizeof(header_bytes), file) != sizeof(header_bytes)
+        || !snapshot_io::decodeHeader(header_bytes, header)
+        || header.order_count > static_cast<uint64_t>(std::numeric_limits<OrderId>::max())
+        || header.stop_count > static_cast<uint64_t>(std::numeric_limits<OrderId>::max()))
+        return false;
+
+    // The body is read whole and checked before anything is built. It grows as it's
+    // read, so a corrupt header can't demand a huge buffer up front.
+    auto level_count = uint64_t{header.buy_level_count} + header.sell_level_count;
+    auto body_size = level_count * snapshot_io::LEVEL_HEADER_SIZE
+        + header.order_count * snapshot_io::ORDER_SIZE
+        + header.stop_count * snapshot_io::STOP_SIZE;
+    std::vector<char> body;
+    while (body.size() < body_size) {
+        auto offset = body.size();
+        auto chunk_size = static_cast<size_t>(std::min<uint64_t>(body_size - offset, size_t{1} << 20));
+        body.resize(offset + chunk_size);
+        if (std::fread(body.data() + offset, 1, chunk_size, file) != chunk_size)
+            return false;
+    }
+
+    const auto* end = body.data() + body.size();
+    std::vector<OrderId> ids;
+    for (bool build : {false, true}) {
+        const auto* in = body.data();
+        uint64_t order_count = 0;
+        if (!loadSide<Order::Side::BUY>(in, end, header.buy_level_count, order_count, build, ids)
+            || !loadSide<Order::Side::SELL>(
+                in, end, header.sell_level_count, order_count, build, ids)
+            || order_count != header.order_count
+            || static_cast<uint64_t>(end - in) != header.stop_count * snapshot_io::STOP_SIZE)
+            return false;
+        for (; in != end; in += snapshot_io::STOP_SIZE) {
+            Order order;
+            if (!snapshot_io::decodeStop(in, order)
+                || (order.type != Order::Type::STOP && order.type != Order::Type::STOP_LIMIT)
+                || order.visible_qty <= 0 || order.peak_qty <= 0)
+                return false;
+            if (build)
+                trigger_book_.add(order);
+            else
+                ids.push_back(order.id);
+        }
+        if (!build) {
+            // An id may appear once across both sides and the stops
+            std::sort(std::begin(ids), std::end(ids));
+            if (std::adjacent_find(std::begin(ids), std::end(ids)) != std::end(ids))
+                return false;
+            order_index_.reserve(order_count);
+        }
+    }
+    seq_ = header.seq;
+    last_trade_price_ = header.last_trade_price;
+    has_traded_ = header.has_traded;
+    return true;
+}
+
+template <class Config>
+ALWAYS_INLINE auto BasicMatchingEngine<Config>::nodeAllocator() const noexcept
+-> const NodeAllocator& {
+    return node_alloc_;
+}
+
+template <class Config>
+ALWAYS_INLINE auto BasicMatchingEngine<Config>::bestBid() const noexcept -> LevelDepth {
+    return buy_side_.bestDepth();
+}
+
+template <class Config>
+ALWAYS_INLINE auto BasicMatchingEngine<Config>::bestAsk() const noexcept -> LevelDepth {
+    return sell_side_.bestDepth();
+}
+
+template <class Config>
+ALWAYS_INLINE auto BasicMatchingEngine<Config>::depthAt(
+    Order::Side side, Price price) const -> LevelDepth {
+    return visitSide(side, [price](const auto& book_side) { return book_side.depthAt(price); });
+}
+
+template <class Config>
+ALWAYS_INLINE size_t BasicMatchingEngine<Config>::topN(
+    Order::Side side, std::span<LevelDepth> out) const {
+    return visitSide(side, [out](const auto& book_side) { return book_side.topN(out); });
+}
+
+template <class Config>
+ALWAYS_INLINE auto BasicMatchingEngine<Config>::topN(
+    Order::Side side, size_t n) const -> std::vector<LevelDepth> {
+    return visitSide(side, [n](const auto& book_side) { return book_side.topN(n); });
+}
+
+template <class Config>
+ALWAYS_INLINE auto BasicMatchingEngine<Config>::stats() const noexcept -> const Stats& {
+    return stats_;
+}
+
+template <class Config>
+ALWAYS_INLINE auto BasicMatchingEngine<Config>::makeNodeAllocator(size_t order_capacity)
+-> NodeAllocator {
+    if constexpr (std::is_constructible_v<NodeAllocator, size_t>)
+        return NodeAllocator(order_capacity);
+    else
+        return NodeAllocator{};
+}
+
+template <class Config>
+template <class Iterator>
+uint32_t BasicMatchingEngine<Config>::encodeSide(
+    Iterator begin, Iterator end, std::vector<char>& buffer) {
+    uint32_t level_count = 0;
+    uint32_t level_order_count = 0;
+    size_t level_offset = 0;
+    Price level_price = 0;
+    for (auto iter = begin; iter != end; ++iter) {
+        if (!level_order_count || iter->price != level_price) {
+            if (level_order_count)
+                snapshot_io::encodeLevel(level_price, level_order_count, buffer.data() + level_offset);
+            level_offset = buffer.size();
+            buffer.resize(level_offset + snapshot_io::LEVEL_HEADER_SIZE);
+            level_price = iter->price;
+            level_order_count = 0;
+            ++level_count;
+        }
+        auto offset = buffer.size();
+        buffer.resize(offset + snapshot_io::ORDER_SIZE);
+        snapshot_io::encodeOrder(*iter, buffer.data() + offset);
+        ++level_order_count;
+    }
+    if (level_order_count)
+        snapshot_io::encodeLevel(level_price, level_order_count, buffer.data() + level_offset);
+    return level_count;
+}
+
+template <class Config>
+template <OrderSide SIDE>
+bool BasicMatchingEngine<Config>::loadSide(const char*& in, const char* end,
+    uint32_t level_count, uint64_t& order_count, bool build, std::vector<OrderId>& ids) {
+    using Side = std::remove_cvref_t<decltype(bookSide<SIDE>())>;
+    std::vector<Order> orders;
+    Price last_price = 0;
+    for (uint32_t level_idx = 0; level_idx < level_count; ++level_idx) {
+        if (end - in < static_cast<ptrdiff_t>(snapshot_io::LEVEL_HEADER_SIZE))
+            return false;
+        Price price;
+        auto price_known = snapshot_io::decodeLevelPrice(in, price);
+        auto level_order_count = snapshot_io::decodeLevelOrderCount(in);
+        in += snapshot_io::LEVEL_HEADER_SIZE;
+        if (!price_known || !level_order_count
+            || static_cast<size_t>(end - in) / snapshot_io::ORDER_SIZE < level_order_count
+            || (level_idx && !Side::comparator()(last_price, price)))
+            return false;
+        last_price = price;
+
+        orders.clear();
+        for (uint32_t idx = 0; idx < level_order_count; ++idx, in += snapshot_io::ORDER_SIZE) {
+            Order order;
+            if (!snapshot_io::decodeOrder(in, SIDE, price, order)
+                || order.visible_qty <= 0 || order.peak_qty <= 0 || order.hidden_qty < 0
+                || order.visible_qty > order.peak_qty
+                || (order.hidden_qty && order.type != Order::Type::ICEBERG)
+                || (order.tif != Order::TimeInForce::GTC
+                    && order.tif != Order::TimeInForce::POST_ONLY))
+                return false;
+            if (build)
+                orders.push_back(order);
+            else
+                ids.push_back(order.id);
+        }
+        order_count += level_order_count;
+        if (build)
+            bookSide<SIDE>().loadLevel(price, orders);
+    }
+    return true;
+}
+
+template <class Config>
+ALWAYS_INLINE void BasicMatchingEngine<Config>::trackDeltas(bool enabled) noexcept {
+    track_deltas_ = enabled;
+}
+
+template <class Config>
+ALWAYS_INLINE auto BasicMatchingEngine<Config>::deltas() const noexcept
+-> const std::vector<LevelDelta>& {
+    return deltas_;
+}
+
+template <class Config>
+ALWAYS_INLINE void BasicMatchingEngine<Config>::beginMessage() {
+    ++seq_;
+    trades_.clear();
+    deltas_.clear();
+    stats_.beginMessage();
+}
+
+template <class Config>
+ALWAYS_INLINE void BasicMatchingEngine<Config>::endMessage() {
+    for (auto& delta : deltas_)
+        delta = visitSide(delta.side,
+            [&delta](const auto& side) { return side.levelDelta(delta.price); });
+}
+
+template <class Config>
+ALWAYS_INLINE void BasicMatchingEngine<Config>::submit(Order& aggressive_order) {
+    if (aggressive_order.type == Order::Type::STOP
+        || aggressive_order.type == Order::Type::STOP_LIMIT) [[unlikely]] {
+        if (!has_traded_ || !trigger_book_.fires(aggressive_order, last_trade_price_)) {
+            trigger_book_.add(aggressive_order);
+            return;
+        }
+        activateStop(aggressive_order);
+    }
+
+    execute(aggressive_order);
+    if (!trigger_book_.empty()) [[unlikely]]
+        fireStops();
+}
+
+template <class Config>
+void BasicMatchingEngine<Config>::fireStops() {
+    // Stops a fired order sets off queue up behind those already fired, so an
+    // avalanche runs to the end within the message in a fixed order
+    if (!has_traded_)
+        return;
+    fired_stops_.clear();
+    trigger_book_.collect(last_trade_price_, fired_stops_);
+    for (size_t idx = 0; idx < fired_stops_.size(); ++idx) {
+        auto order = fired_stops_[idx];
+        activateStop(order);
+        execute(order);
+        trigger_book_.collect(last_trade_price_, fired_stops_);
+    }
+}
+
+template <class Config>
+ALWAYS_INLINE void BasicMatchingEngine<Config>::activateStop(Order& order) noexcept {
+    if (order.type == Order::Type::STOP)
+        order.type = Order::Type::MARKET;
+    else
+        order.type = (order.peak_qty < order.visible_qty + order.hidden_qty)
+            ? Order::Type::ICEBERG
+            : Order::Type::LIMIT;
+}
+
+template <class Config>
+ALWAYS_INLINE void BasicMatchingEngine<Config>::execute(Order& aggressive_order) {
+    if (aggressive_order.side == Order::Side::BUY)
+        execute<Order::Side::BUY>(aggressive_order);
+    else
+        execute<Order::Side::SELL>(aggressive_order);
+}
+
+template <class Config>
+template <OrderSide SIDE>
+ALWAYS_INLINE void BasicMatchingEngine<Config>::execute(Order& aggressive_order) {
+    constexpr auto CONTRA_SIDE = (SIDE == Order::Side::BUY) ? Order::Side::SELL : Order::Side::BUY;
+    assert(aggressive_order.side == SIDE);
+
+    // A market order matches with the loosest limit the price type allows
+    if (aggressive_order.type == Order::Type::MARKET) {
+        aggressive_order.price = (SIDE == Order::Side::BUY)
+            ? std::numeric_limits<Price>::max()
+            : std::numeric_limits<Price>::min();
+    }
+
+    switch (aggressive_order.tif) {
+    case Order::TimeInForce::POST_ONLY:
+        if (bookSide<CONTRA_SIDE>().crosses(aggressive_order.price))
+            return;
+        break;
+    case Order::TimeInForce::FOK: {
+        auto qty = aggressive_order.visible_qty + aggressive_order.hidden_qty;
+        if (bookSide<CONTRA_SIDE>().fillableQty(aggressive_order.price, qty) < qty)
+            return;
+        break;
+    }
+    default:
+        break;
+    }
+
+    match<SIDE>(aggressive_order);
+    if (aggressive_order.visible_qty && aggressive_order.type != Order::Type::MARKET
+        && (aggressive_order.tif == Order::TimeInForce::GTC
+            || aggressive_order.tif == Order::TimeInForce::POST_ONLY)) {
+        touchLevel(SIDE, aggressive_order.price);
+        bookSide<SIDE>().addOrder(aggressive_order);
+    }
+}
+
+template <class Config>
+ALWAYS_INLINE void BasicMatchingEngine<Config>::touchLevel(Order::Side side, Price price) {
+    if (!track_deltas_)
+        return;
+    // A sweep keeps touching the best level until it's gone, so only consecutive repeats
+    // are skipped. Any other repeat just reports the same final state twice.
+    if (!deltas_.empty() && deltas_.back().side == side && deltas_.back().price == price)
+        return;
+    deltas_.push_back(LevelDelta{.side = side, .price = price, .qty = 0, .order_count = 0});
+}
+
+template <class Config>
+template <OrderSide SIDE>
+ALWAYS_INLINE void BasicMatchingEngine<Config>::match(Order& aggressive_order) {
+    constexpr auto CONTRA_SIDE = (SIDE == Order::Side::BUY) ? Order::Side::SELL : Order::Side::BUY;
+    auto& contra_side = bookSide<CONTRA_SIDE>();
+    [[maybe_unused]] auto timer = stats_.time(Probe::MATCH);
 
-    const auto& cmp = contra_side.comparator();
     auto aggressive_qty = aggressive_order.visible_qty + aggressive_order.hidden_qty;
-    while (aggressive_qty
-        && !contra_side.empty() && !cmp(aggressive_order.price, contra_side.bestPrice())) {
-        auto passive_order = contra_side.bestOrder();
+    // Wider than Price so the first level always counts as a new one
+    [[maybe_unused]] int32_t last_price = std::numeric_limits<int32_t>::min();
+    while (aggressive_qty && contra_side.crosses(aggressive_order.price)) {
+        auto& passive_node = contra_side.bestNode();
+        auto passive_price = contra_side.bestPrice();
+        touchLevel(CONTRA_SIDE, passive_price);
+        if constexpr (Stats::ENABLED) {
+            if (passive_price != last_price) {
+                stats_.levelTouched();
+                last_price = passive_price;
+            }
+        }
+        // The node is gone after a full fill, so the trade is looked up first
+        auto& trade = tradeWith<SIDE>(aggressive_order, passive_node, passive_price);
         auto trade_qty = contra_side.consumeBest(aggressive_qty);
-        addTrade(aggressive_order, passive_order, trade_qty);
+        trade.qty += trade_qty;
         aggressive_qty -= trade_qty;
+        last_trade_price_ = passive_price;
+        has_traded_ = true;
     }
 
     aggressive_order.visible_qty = std::min(aggressive_qty, aggressive_order.peak_qty);
     aggressive_order.hidden_qty = aggressive_qty - aggressive_order.visible_qty;
 }
 
-ALWAYS_INLINE void MatchingEngine::addTrade(
-    const Order& aggressive_order, const Order& passive_order, Quantity qty) {
-    assert(aggressive_order.side != passive_order.side);
+template <class Config>
+template <OrderSide SIDE>
+ALWAYS_INLINE auto& BasicMatchingEngine<Config>::bookSide() noexcept {
+    if constexpr (SIDE == Order::Side::BUY)
+        return buy_side_;
+    else
+        return sell_side_;
+}
 
-    auto [iter, inserted] = passive_id_idx_.emplace(passive_order.id, trades_.size());
-    if (!inserted) {
-        trades_[iter->second].qty += qty;
-        return;
-    }
+template <class Config>
+template <OrderSide SIDE>
+ALWAYS_INLINE const auto& BasicMatchingEngine<Config>::bookSide() const noexcept {
+    if constexpr (SIDE == Order::Side::BUY)
+        return buy_side_;
+    else
+        return sell_side_;
+}
+
+template <class Config>
+template <class Fn>
+ALWAYS_INLINE decltype(auto) BasicMatchingEngine<Config>::visitSide(Order::Side side, Fn&& fn) {
+    return (side == Order::Side::BUY) ? fn(buy_side_) : fn(sell_side_);
+}
+
+template <class Config>
+template <class Fn>
+ALWAYS_INLINE decltype(auto) BasicMatchingEngine<Config>::visitSide(
+    Order::Side side, Fn&& fn) const {
+    return (side == Order::Side::BUY) ? fn(buy_side_) : fn(sell_side_);
+}
+
+template <class Config>
+template <OrderSide SIDE>
+ALWAYS_INLINE auto BasicMatchingEngine<Config>::tradeWith(
+    const Order& aggressive_order, OrderNode& passive_node, Price passive_price) -> Trade& {
+    assert(aggressive_order.side == SIDE);
+
+    // Only an iceberg refilled within the current sweep comes back for more. Fired
+    // stops make for more than one sweep per message, so both ids have to match.
+    constexpr auto PASSIVE_ID = (SIDE == Order::Side::BUY) ? &Trade::sell_id : &Trade::buy_id;
+    constexpr auto AGGRESSIVE_ID = (SIDE == Order::Side::BUY) ? &Trade::buy_id : &Trade::sell_id;
+    if (passive_node.trade_idx < trades_.size()
+        && trades_[passive_node.trade_idx].*PASSIVE_ID == passive_node.id
+        && trades_[passive_node.trade_idx].*AGGRESSIVE_ID == aggressive_order.id)
+        return trades_[passive_node.trade_idx];
 
-    auto [aggressiveIdField, passiveIdField] = (aggressive_order.side == Order::Side::BUY)
-        ? std::pair{&Trade::buy_id, &Trade::sell_id}
-        : std::pair{&Trade::sell_id, &Trade::buy_id};
     Trade trade;
-    trade.*aggressiveIdField = aggressive_order.id;
-    trade.*passiveIdField = passive_order.id;
-    trade.price = passive_order.price;
-    trade.qty = qty;
-    trades_.emplace_back(trade);
+    if constexpr (SIDE == Order::Side::BUY) {
+        trade.buy_id = aggressive_order.id;
+        trade.sell_id = passive_node.id;
+    } else {
+        trade.buy_id = passive_node.id;
+        trade.sell_id = aggressive_order.id;
+    }
+    trade.price = passive_price;
+    trade.qty = 0;
+    passive_node.trade_idx = static_cast<uint32_t>(trades_.size());
+    return trades_.emplace_back(trade);
 }
 
-ALWAYS_INLINE auto MatchingEngine::buyBegin() const noexcept -> Iterator {
+template <class Config>
+ALWAYS_INLINE auto BasicMatchingEngine<Config>::buyBegin() const noexcept -> BuyIterator {
     return buy_side_.begin();
 }
 
-ALWAYS_INLINE auto MatchingEngine::buyEnd() const noexcept -> Iterator {
+template <class Config>
+ALWAYS_INLINE auto BasicMatchingEngine<Config>::buyEnd() const noexcept -> BuyIterator {
     return buy_side_.end();
 }
 
-ALWAYS_INLINE auto MatchingEngine::sellBegin() const noexcept -> Iterator {
+template <class Config>
+ALWAYS_INLINE auto BasicMatchingEngine<Config>::sellBegin() const noexcept -> SellIterator {
     return sell_side_.begin();
 }
 
-ALWAYS_INLINE auto MatchingEngine::sellEnd() const noexcept -> Iterator {
+template <class Config>
+ALWAYS_INLINE auto BasicMatchingEngine<Config>::sellEnd() const noexcept -> SellIterator {
     return sell_side_.end();
 }
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "matching_engine.h"
+#include "order_io.h"
+#include "spsc_ring.h"
+
+struct SymbolOrder {
+    SymbolId symbol;
+    Order order;
+};
+
+// Holds one matching engine per symbol. Symbols are partitioned by hash across
+// worker threads, and each worker is fed through its own SPSC ring. So every
+// symbol is matched by a single thread, in submission order.
+template <class Config>
+class BasicMatchingEngineSet {
+    static_assert(std::is_same_v<typename Config::Traits, DefaultOrderTraits>,
+        "Orders are routed to the workers in the default layout");
+
+public:
+    using Engine = BasicMatchingEngine<Config>;
+    // Invoked on the worker thread owning the symbol, in processing order. Different
+    // workers invoke it concurrently.
+    using TradeHandler = std::function<void(SymbolId, std::span<const Trade>)>;
+
+    static constexpr size_t INBOUND_CAPACITY = size_t{1} << 14;
+    static constexpr size_t DEFAULT_SYMBOL_ORDER_CAPACITY = 1024;
+
+public:
+    BasicMatchingEngineSet(size_t worker_count, TradeHandler trade_handler,
+        bool pin_workers = false, size_t symbol_order_capacity = DEFAULT_SYMBOL_ORDER_CAPACITY);
+    ~BasicMatchingEngineSet();
+
+    BasicMatchingEngineSet(const BasicMatchingEngineSet&) = delete;
+    BasicMatchingEngineSet(BasicMatchingEngineSet&&) = delete;
+    BasicMatchingEngineSet& operator=(const BasicMatchingEngineSet&) = delete;
+    BasicMatchingEngineSet& operator=(BasicMatchingEngineSet&&) = delete;
+
+    // Must be called from a single producer thread. Spins while the owning
+    // worker's ring is full.
+    void submit(SymbolId symbol, const Order& order);
+    // Routed like submit, so they apply in order with the symbol's orders. Neither
+    // reports back: a cancel of an unknown id is dropped, and an amend's trades go
+    // to the trade handler.
+    void cancel(SymbolId symbol, OrderId id);
+    void amend(SymbolId symbol, OrderId id, Price new_price, Quantity new_qty);
+    // Blocks until every submitted order, cancel and amend has been processed
+    void drain();
+
+    [[nodiscard]] size_t workerCount() const noexcept;
+    [[nodiscard]] size_t workerOf(SymbolId symbol) const noexcept;
+
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    struct SymbolMessage {
+        SymbolId symbol;
+        OrderMessage message;
+    };
+
+    struct Worker {
+        SpscRing<SymbolMessage, INBOUND_CAPACITY> inbound;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> processed{0};
+        // Only touched by the producer
+        alignas(CACHE_LINE_SIZE) uint64_t submitted{0};
+        // Only touched by the worker thread
+        std::unordered_map<SymbolId, std::unique_ptr<Engine>> engines;
+        std::thread thread;
+    };
+
+    TradeHandler trade_handler_;
+    size_t symbol_order_capacity_;
+    std::atomic<bool> running_{true};
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    void push(SymbolId symbol, const OrderMessage& message);
+    void run(Worker& worker);
+    Engine& engineOf(Worker& worker, SymbolId symbol);
+
+    static void pinToCore(std::thread& thread, size_t core);
+
+};
+
+using MatchingEngineSet = BasicMatchingEngineSet<DefaultBookConfig>;
+
+#include "matching_engine_set.inl"
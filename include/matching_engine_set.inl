@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+#if defined(__linux__)
+  #include <pthread.h>
+#endif
+
+#include "util.h"
+
+template <class Config>
+BasicMatchingEngineSet<Config>::BasicMatchingEngineSet(size_t worker_count,
+    TradeHandler trade_handler, bool pin_workers, size_t symbol_order_capacity)
+    : trade_handler_(std::move(trade_handler))
+    , symbol_order_capacity_(symbol_order_capacity) {
+    assert(worker_count > 0);
+
+    workers_.reserve(worker_count);
+    for (size_t idx = 0; idx < worker_count; ++idx)
+        workers_.push_back(std::make_unique<Worker>());
+
+    auto core_count = std::max(std::thread::hardware_concurrency(), 1u);
+    for (size_t idx = 0; idx < worker_count; ++idx) {
+        auto& worker = *workers_[idx];
+        worker.thread = std::thread([this, &worker] { run(worker); });
+        if (pin_workers)
+            pinToCore(worker.thread, idx % core_count);
+    }
+}
+
+template <class Config>
+BasicMatchingEngineSet<Config>::~BasicMatchingEngineSet() {
+    running_.store(false, std::memory_order_release);
+    for (auto& worker : workers_)
+        worker->thread.join();
+}
+
+template <class Config>
+ALWAYS_INLINE void BasicMatchingEngineSet<Config>::submit(SymbolId symbol, const Order& order) {
+    push(symbol, OrderMessage{.kind = OrderMessage::Kind::ORDER, .order = order});
+}
+
+template <class Config>
+ALWAYS_INLINE void BasicMatchingEngineSet<Config>::cancel(SymbolId symbol, OrderId id) {
+    Order order{};
+    order.id = id;
+    push(symbol, OrderMessage{.kind = OrderMessage::Kind::CANCEL, .order = order});
+}
+
+template <class Config>
+ALWAYS_INLINE void BasicMatchingEngineSet<Config>::amend(
+    SymbolId symbol, OrderId id, Price new_price, Quantity new_qty) {
+    Order order{};
+    order.id = id;
+    order.price = new_price;
+    order.visible_qty = new_qty;
+    push(symbol, OrderMessage{.kind = OrderMessage::Kind::AMEND, .order = order});
+}
+
+template <class Config>
+void BasicMatchingEngineSet<Config>::drain() {
+    for (auto& worker : workers_)
+        while (worker->processed.load(std::memory_order_acquire) != worker->submitted)
+            std::this_thread::yield();
+}
+
+template <class Config>
+ALWAYS_INLINE size_t BasicMatchingEngineSet<Config>::workerCount() const noexcept {
+    return workers_.size();
+}
+
+template <class Config>
+ALWAYS_INLINE size_t BasicMatchingEngineSet<Config>::workerOf(SymbolId symbol) const noexcept {
+    // Fibonacci hashing spreads consecutive symbol ids evenly
+    auto hash = (uint64_t{symbol} * 0x9E3779B97F4A7C15ull) >> 32;
+    return static_cast<size_t>(hash % workers_.size());
+}
+
+template <class Config>
+ALWAYS_INLINE void BasicMatchingEngineSet<Config>::push(
+    SymbolId symbol, const OrderMessage& message) {
+    auto& worker = *workers_[workerOf(symbol)];
+    while (!worker.inbound.tryPush(SymbolMessage{symbol, message}))
+        std::this_thread::yield();
+    ++worker.submitted;
+}
+
+template <class Config>
+void BasicMatchingEngineSet<Config>::run(Worker& worker) {
+    for (;;) {
+        const auto* message = worker.inbound.front();
+        if (!message) {
+            if (!running_.load(std::memory_order_acquire) && worker.inbound.empty())
+                return;
+            std::this_thread::yield();
+            continue;
+        }
+
+        auto& engine = engineOf(worker, message->symbol);
+        const auto& [kind, order] = message->message;
+        if (kind == OrderMessage::Kind::CANCEL) {
+            engine.cancel(order.id);
+        } else {
+            const auto& trades = (kind == OrderMessage::Kind::ORDER) ? engine.process(order)
+                : engine.amend(order.id, order.price, order.visible_qty);
+            if (!trades.empty() && trade_handler_)
+                trade_handler_(message->symbol, trades);
+        }
+        worker.inbound.pop();
+        worker.processed.store(
+            worker.processed.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+}
+
+template <class Config>
+ALWAYS_INLINE auto BasicMatchingEngineSet<Config>::engineOf(Worker& worker, SymbolId symbol)
+-> Engine& {
+    auto& engine = worker.engines[symbol];
+    if (!engine)
+        engine = std::make_unique<Engine>(symbol_order_capacity_);
+    return *engine;
+}
+
+template <class Config>
+void BasicMatchingEngineSet<Config>::pinToCore(std::thread& thread, size_t core) {
+#if defined(__linux__)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus);
+#else
+    (void)thread;
+    (void)core;
+#endif
+}
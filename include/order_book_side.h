@@ -1,21 +1,57 @@
 #pragma once
 
 #include <memory>
+#include <cstdint>
 #include <functional>
-#include <map>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
+#include "book_config.h"
 #include "price_level.h"
 
+// What the order index keeps for each resting order. The node holds only what a
+// fill needs, so the side and price that locate its level are kept here.
+template <class Level>
+struct OrderLocation {
+    typename Level::Handle handle;
+    typename Level::Price price;
+    OrderSide side;
+};
+
+// One side of the book, fixed at compile time so price comparisons and the
+// crossing test inline to a single integer compare.
+template <class Config, OrderSide SIDE>
 class OrderBookSide {
 private:
     class OrderBookSideIterator;
 
 public:
+    static constexpr bool IS_BUY = SIDE == OrderSide::BUY;
+
+    using Traits = typename Config::Traits;
+    using Order = BasicOrder<Traits>;
+    using LevelDepth = BasicLevelDepth<Traits>;
+    using LevelDelta = BasicLevelDelta<Traits>;
+    using Price = typename Traits::Price;
+    using Quantity = typename Traits::Quantity;
+    using OrderId = typename Traits::OrderId;
+
     using Iterator = OrderBookSideIterator;
-    using Comparator = std::function<bool(Price, Price)>;
+    // Holds if the first price is the better one on this side
+    using Comparator = std::conditional_t<IS_BUY, std::greater<Price>, std::less<Price>>;
+    using NodeAllocator = typename Config::template NodeAllocator<BasicOrderNode<Traits>>;
+    using Level = typename Config::template Level<NodeAllocator>;
+    // What the level stores per order, the engine reads the front one while matching
+    using OrderNode = typename Level::Node;
+    using Location = OrderLocation<Level>;
+    using OrderIndex = std::unordered_map<OrderId, Location>;
+    using Stats = typename Config::Stats;
 
 public:
-    OrderBookSide(bool is_buy);
+    OrderBookSide(OrderIndex& order_index, NodeAllocator& node_alloc, Stats& stats);
     ~OrderBookSide() = default;
 
     OrderBookSide(const OrderBookSide&) = delete;
@@ -23,35 +59,76 @@ public:
     OrderBookSide& operator=(const OrderBookSide&) = delete;
     OrderBookSide& operator=(OrderBookSide&&) = delete;
 
-    [[nodiscard]] bool isBuy() const noexcept;
+    [[nodiscard]] static constexpr bool isBuy() noexcept;
     [[nodiscard]] bool empty() const noexcept;
-    [[nodiscard]] const Comparator& comparator() const noexcept;
+    [[nodiscard]] static constexpr Comparator comparator() noexcept;
     [[nodiscard]] Price bestPrice() const;
-    [[nodiscard]] const Order& bestOrder() const;
+    [[nodiscard]] Order bestOrder() const;
+    [[nodiscard]] OrderNode& bestNode();
+    [[nodiscard]] Order restingOrder(const Location& location) const;
+    // Starts loading the best level and its first order into the cache
+    void prefetchBest() const noexcept;
+    // Whether an opposite-side order at the price would trade against this side.
+    // A single compare against the cached best price.
+    [[nodiscard]] bool crosses(Price price) const noexcept;
+    // Best level totals from the cache, all zero quantities if the side is empty
+    [[nodiscard]] LevelDepth bestDepth() const noexcept;
+    [[nodiscard]] LevelDelta levelDelta(Price price) const;
+    // All zero quantities if nothing rests at the price
+    [[nodiscard]] LevelDepth depthAt(Price price) const;
+    // Orders resting on this side, summed from the level totals
+    [[nodiscard]] size_t orderCount() const;
+    // Fills out with up to out.size() levels from the best price down and
+    // returns how many were written
+    size_t topN(std::span<LevelDepth> out) const;
+    [[nodiscard]] std::vector<LevelDepth> topN(size_t n) const;
+    // Quantity an opposite-side order limited to the price could take, summed from
+    // level totals and stopping once it reaches needed_qty
+    [[nodiscard]] Quantity fillableQty(Price limit_price, Quantity needed_qty) const;
 
     void addOrder(const Order& order);
+    // Appends a whole level worse than every resting one, with the orders in time
+    // priority. Skips the per-order best price check of addOrder.
+    void loadLevel(Price price, std::span<const Order> orders);
     Quantity consumeBest(Quantity qty);
+    void removeOrder(const Location& location);
+    void reduceOrder(const Location& location, Quantity qty);
 
     [[nodiscard]] Iterator begin() const noexcept;
     [[nodiscard]] Iterator end() const noexcept;
 
 private:
-    using NodeAllocator = std::allocator<OrderNode>;
-    using Level = PriceLevel<NodeAllocator>;
-    using LevelsMap = std::map<Price, Level, Comparator>;
+    using Levels = typename Config::template Levels<Level, Comparator>;
 
-    bool is_buy_;
-    Comparator cmp_;
-    NodeAllocator node_alloc_;
-    LevelsMap levels_map_;
+    OrderIndex& order_index_;
+    Stats& stats_;
+    Levels levels_;
+    // Wider than Price so an empty side holds a sentinel no order price can cross
+    using Key = std::conditional_t<(sizeof(Price) < sizeof(int32_t)), int32_t, int64_t>;
+    static_assert(sizeof(Price) < sizeof(Key));
+    Key best_key_{EMPTY_KEY};
+    Level* best_level_{nullptr};
 
+    static constexpr Key EMPTY_KEY = IS_BUY
+        ? std::numeric_limits<Key>::min()
+        : std::numeric_limits<Key>::max();
+
+    void refreshBest();
+
+    // Yields full orders assembled from each node and its level, so they come by value
     class OrderBookSideIterator {
     public:
-        using value_type = Level::Iterator::value_type;
-        using reference = Level::Iterator::reference;
-        using pointer = Level::Iterator::pointer;
+        struct ArrowProxy {
+            Order order;
+            const Order* operator->() const noexcept { return &order; }
+        };
+
+        using value_type = Order;
+        using reference = Order;
+        using pointer = ArrowProxy;
         using difference_type = std::ptrdiff_t;
-        using iterator_category = std::forward_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using iterator_concept = std::forward_iterator_tag;
 
     public:
         OrderBookSideIterator(const OrderBookSideIterator&) = default;
@@ -69,14 +146,15 @@ private:
         bool operator!=(const OrderBookSideIterator&) const noexcept;
 
     private:
-        explicit OrderBookSideIterator(
-            const LevelsMap& levels_map, LevelsMap::const_iterator start);
+        using LevelsIterator = typename Levels::Iterator;
+
+        OrderBookSideIterator(LevelsIterator start, LevelsIterator end);
 
         friend class OrderBookSide;
 
-        const LevelsMap& levels_map_;
-        LevelsMap::const_iterator current_;
-        Level::Iterator level_current_;
+        LevelsIterator current_;
+        LevelsIterator end_;
+        typename Level::Iterator level_current_;
 
     };
 };
@@ -3,128 +3,325 @@
 
 #include "util.h"
 
-ALWAYS_INLINE OrderBookSide::OrderBookSide(bool is_buy)
-    : is_buy_(is_buy)
-    , cmp_([is_buy](Price lhs, Price rhs) { return is_buy ? lhs > rhs : lhs < rhs; })
-    , levels_map_(cmp_) {
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE OrderBookSide<Config, SIDE>::OrderBookSide(
+    OrderIndex& order_index, NodeAllocator& node_alloc, Stats& stats)
+    : order_index_(order_index)
+    , stats_(stats)
+    , levels_(node_alloc) {
 }
 
-ALWAYS_INLINE bool OrderBookSide::isBuy() const noexcept {
-    return is_buy_;
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE constexpr bool OrderBookSide<Config, SIDE>::isBuy() noexcept {
+    return IS_BUY;
 }
 
-ALWAYS_INLINE bool OrderBookSide::empty() const noexcept {
-    return levels_map_.empty();
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE bool OrderBookSide<Config, SIDE>::empty() const noexcept {
+    return best_level_ == nullptr;
 }
 
-ALWAYS_INLINE auto OrderBookSide::comparator() const noexcept -> const Comparator& {
-    return cmp_;
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE constexpr auto OrderBookSide<Config, SIDE>::comparator() noexcept -> Comparator {
+    return Comparator{};
 }
 
-ALWAYS_INLINE Price OrderBookSide::bestPrice() const {
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::bestPrice() const -> Price {
     assert(!empty());
+    return static_cast<Price>(best_key_);
+}
 
-    const auto& [price, level] = *(levels_map_.cbegin());
-    return price;
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::bestOrder() const -> Order {
+    assert(!empty());
+    return best_level_->front().order(SIDE, bestPrice());
 }
 
-ALWAYS_INLINE const Order& OrderBookSide::bestOrder() const {
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::bestNode() -> OrderNode& {
     assert(!empty());
+    return best_level_->front();
+}
+
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::restingOrder(const Location& location) const
+-> Order {
+    const auto* level = levels_.find(location.price);
+    assert(level);
+    return level->node(location.handle).order(SIDE, location.price);
+}
+
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE void OrderBookSide<Config, SIDE>::prefetchBest() const noexcept {
+    if (best_level_) {
+        prefetch(best_level_);
+        prefetch(&best_level_->front());
+    }
+}
+
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE bool OrderBookSide<Config, SIDE>::crosses(Price price) const noexcept {
+    if constexpr (IS_BUY)
+        return price <= best_key_;
+    else
+        return price >= best_key_;
+}
+
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::bestDepth() const noexcept -> LevelDepth {
+    if (empty())
+        return LevelDepth{.price = 0, .visible_qty = 0, .hidden_qty = 0, .order_count = 0};
+    return LevelDepth{
+        .price = static_cast<Price>(best_key_),
+        .visible_qty = best_level_->visibleQty(),
+        .hidden_qty = best_level_->hiddenQty(),
+        .order_count = best_level_->orderCount()
+    };
+}
+
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::levelDelta(Price price) const -> LevelDelta {
+    auto depth = depthAt(price);
+    return LevelDelta{
+        .side = SIDE,
+        .price = price,
+        .qty = depth.visible_qty,
+        .order_count = depth.order_count
+    };
+}
+
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::depthAt(Price price) const -> LevelDepth {
+    const auto* level = levels_.find(price);
+    if (!level)
+        return LevelDepth{.price = price, .visible_qty = 0, .hidden_qty = 0, .order_count = 0};
+    return LevelDepth{
+        .price = price,
+        .visible_qty = level->visibleQty(),
+        .hidden_qty = level->hiddenQty(),
+        .order_count = level->orderCount()
+    };
+}
+
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE size_t OrderBookSide<Config, SIDE>::orderCount() const {
+    size_t count = 0;
+    for (const auto& level : levels_)
+        count += level.orderCount();
+    return count;
+}
+
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE size_t OrderBookSide<Config, SIDE>::topN(std::span<LevelDepth> out) const {
+    size_t count = 0;
+    for (auto iter = std::cbegin(levels_); iter != std::cend(levels_) && count < out.size(); ++iter) {
+        out[count++] = LevelDepth{
+            .price = iter->price(),
+            .visible_qty = iter->visibleQty(),
+            .hidden_qty = iter->hiddenQty(),
+            .order_count = iter->orderCount()
+        };
+    }
+    return count;
+}
+
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::topN(size_t n) const -> std::vector<LevelDepth> {
+    std::vector<LevelDepth> depth(n);
+    depth.resize(topN(std::span{depth}));
+    return depth;
+}
 
-    const auto& [price, level] = *(levels_map_.cbegin());
-    return level.front();
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::fillableQty(
+    Price limit_price, Quantity needed_qty) const -> Quantity {
+    Quantity fillable_qty = 0;
+    if (!crosses(limit_price))
+        return fillable_qty;
+    for (auto iter = std::cbegin(levels_); iter != std::cend(levels_)
+        && fillable_qty < needed_qty && !Comparator{}(limit_price, iter->price()); ++iter)
+        fillable_qty += iter->visibleQty() + iter->hiddenQty();
+    return fillable_qty;
 }
 
-ALWAYS_INLINE void OrderBookSide::addOrder(const Order& order) {
-    bool is_buy_order = order.side == Order::Side::BUY;
-    assert(is_buy_order == isBuy());
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE void OrderBookSide<Config, SIDE>::addOrder(const Order& order) {
+    assert(order.side == SIDE);
+
+    auto& level = levels_.levelAt(order.price);
+    auto [iter, index_inserted] = order_index_.emplace(
+        order.id, Location{level.pushBack(order), order.price, SIDE});
+    // The engine turns away ids already resting
+    assert(index_inserted);
+    if constexpr (Level::TRACKS_HANDLES)
+        level.trackHandle(iter->second.handle);
 
-    auto [iter, inserted] = levels_map_.try_emplace(order.price, order.price, node_alloc_);
-    auto& [price, level] = *iter;
-    return level.pushBack(order);
+    if (empty() || Comparator{}(order.price, static_cast<Price>(best_key_))) {
+        best_key_ = order.price;
+        best_level_ = &level;
+    }
 }
 
-ALWAYS_INLINE Quantity OrderBookSide::consumeBest(Quantity qty) {
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE void OrderBookSide<Config, SIDE>::loadLevel(Price price, std::span<const Order> orders) {
+    assert(!orders.empty());
+
+    auto& level = levels_.appendWorst(price);
+    for (const auto& order : orders) {
+        assert(order.side == SIDE && order.price == price);
+        auto [iter, index_inserted] = order_index_.emplace(
+            order.id, Location{level.pushBack(order), price, SIDE});
+        assert(index_inserted);
+        if constexpr (Level::TRACKS_HANDLES)
+            level.trackHandle(iter->second.handle);
+    }
+
+    if (empty()) {
+        best_key_ = price;
+        best_level_ = &level;
+    }
+}
+
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::consumeBest(Quantity qty) -> Quantity {
     assert(!empty());
+    [[maybe_unused]] auto timer = stats_.time(Probe::CONSUME_BEST);
 
-    auto& [price, level] = *(levels_map_.begin());
-    auto& order = level.front();
-    auto consumed = std::min(qty, order.visible_qty);
-    order.visible_qty -= consumed;
-    if (order.visible_qty == 0) {
-        if (order.hidden_qty) {
-            assert(order.type == Order::Type::ICEBERG);
-
-            order.visible_qty = std::min(order.hidden_qty, order.peak_qty);
-            order.hidden_qty -= order.visible_qty;
-            level.pushBack(order);
-            level.popFront();
+    auto& level = *best_level_;
+    auto& node = level.front();
+    auto consumed = std::min(qty, node.visible_qty);
+    if (consumed < node.visible_qty) {
+        level.updateQty(node, node.visible_qty - consumed, node.hidden_qty);
+    } else {
+        if (node.hidden_qty) {
+            assert(node.type == Order::Type::ICEBERG);
+
+            auto refill_qty = std::min(node.hidden_qty, node.peak_qty);
+            level.updateQty(node, refill_qty, node.hidden_qty - refill_qty);
+            level.rotateFront();
+            stats_.icebergRefilled();
         } else {
+            stats_.orderFilled();
+            order_index_.erase(node.id);
             level.popFront();
-            if (level.empty())
-                levels_map_.erase(levels_map_.begin());
+            if (level.empty()) {
+                levels_.erase(level);
+                refreshBest();
+            }
         }
     }
     return consumed;
 }
 
-ALWAYS_INLINE auto OrderBookSide::begin() const noexcept -> Iterator {
-    return Iterator{levels_map_, std::cbegin(levels_map_)};
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE void OrderBookSide<Config, SIDE>::removeOrder(const Location& location) {
+    auto* level = levels_.find(location.price);
+    assert(level);
+
+    // The location may live in the index entry erased here
+    auto handle = location.handle;
+    order_index_.erase(level->node(handle).id);
+    level->erase(handle);
+    if (level->empty()) {
+        bool was_best = level == best_level_;
+        levels_.erase(*level);
+        if (was_best)
+            refreshBest();
+    }
+}
+
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE void OrderBookSide<Config, SIDE>::reduceOrder(
+    const Location& location, Quantity qty) {
+    auto* level = levels_.find(location.price);
+    assert(level);
+    auto& node = level->node(location.handle);
+    assert(qty > 0 && qty <= node.visible_qty + node.hidden_qty);
+
+    auto visible_qty = std::min(node.visible_qty, qty);
+    level->updateQty(node, visible_qty, qty - visible_qty);
 }
-ALWAYS_INLINE auto OrderBookSide::end() const noexcept -> Iterator {
-    return Iterator{levels_map_, std::cend(levels_map_)};
+
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE void OrderBookSide<Config, SIDE>::refreshBest() {
+    if (levels_.empty()) {
+        best_key_ = EMPTY_KEY;
+        best_level_ = nullptr;
+    } else {
+        best_key_ = levels_.bestPrice();
+        best_level_ = &levels_.best();
+    }
+}
+
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::begin() const noexcept -> Iterator {
+    return Iterator{std::cbegin(levels_), std::cend(levels_)};
+}
+
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::end() const noexcept -> Iterator {
+    return Iterator{std::cend(levels_), std::cend(levels_)};
 }
 
-ALWAYS_INLINE OrderBookSide::OrderBookSideIterator::OrderBookSideIterator(
-    const LevelsMap& levels_map, LevelsMap::const_iterator start)
-    : levels_map_(levels_map)
-    , current_(start) {
-    while (current_ != std::cend(levels_map_) && current_->second.begin() == current_->second.end())
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE OrderBookSide<Config, SIDE>::OrderBookSideIterator::OrderBookSideIterator(
+    LevelsIterator start, LevelsIterator end)
+    : current_(start)
+    , end_(end) {
+    while (current_ != end_ && current_->begin() == current_->end())
         ++current_;
-    if (current_ != std::cend(levels_map_))
-        level_current_ = current_->second.begin();
+    if (current_ != end_)
+        level_current_ = current_->begin();
 }
 
-ALWAYS_INLINE auto OrderBookSide::OrderBookSideIterator::operator*() const noexcept -> reference {
-    assert(current_ != std::cend(levels_map_));
-    assert(level_current_ != current_->second.end());
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::OrderBookSideIterator::operator*() const noexcept
+-> reference {
+    assert(current_ != end_);
+    assert(level_current_ != current_->end());
 
-    return *level_current_;
+    return level_current_->order(SIDE, current_->price());
 }
 
-ALWAYS_INLINE auto OrderBookSide::OrderBookSideIterator::operator->() const noexcept -> pointer {
-    return &(operator*());
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::OrderBookSideIterator::operator->() const noexcept
+-> pointer {
+    return pointer{operator*()};
 }
 
-ALWAYS_INLINE auto OrderBookSide::OrderBookSideIterator::operator++() noexcept
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::OrderBookSideIterator::operator++() noexcept
 -> OrderBookSideIterator& {
-    assert(current_ != std::cend(levels_map_));
-    assert(level_current_ != current_->second.end());
+    assert(current_ != end_);
+    assert(level_current_ != current_->end());
 
-    if (++level_current_ != current_->second.end())
+    if (++level_current_ != current_->end())
         return *this;
 
-    level_current_ = (++current_ != std::cend(levels_map_))
-        ? current_->second.begin()
-        : Level::Iterator{};
+    level_current_ = (++current_ != end_)
+        ? current_->begin()
+        : typename Level::Iterator{};
     return *this;
 }
 
-ALWAYS_INLINE auto OrderBookSide::OrderBookSideIterator::operator++(int) noexcept
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE auto OrderBookSide<Config, SIDE>::OrderBookSideIterator::operator++(int) noexcept
 -> OrderBookSideIterator {
     OrderBookSideIterator tmp(*this);
     ++(*this);
     return tmp;
 }
 
-ALWAYS_INLINE bool OrderBookSide::OrderBookSideIterator::operator==(
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE bool OrderBookSide<Config, SIDE>::OrderBookSideIterator::operator==(
     const OrderBookSideIterator& iter) const noexcept {
-    return &levels_map_ == &(iter.levels_map_) &&
-        current_ == iter.current_ &&
+    return current_ == iter.current_ &&
         level_current_ == iter.level_current_;
 }
 
-ALWAYS_INLINE bool OrderBookSide::OrderBookSideIterator::operator!=(
+template <class Config, OrderSide SIDE>
+ALWAYS_INLINE bool OrderBookSide<Config, SIDE>::OrderBookSideIterator::operator!=(
     const OrderBookSideIterator& iter) const noexcept {
     return !operator==(iter);
 }
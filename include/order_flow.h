@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+#include "order_io.h"
+#include "types.h"
+
+struct OrderFlowParams {
+    uint64_t seed{1};
+    Price start_price{10000};
+    // Chance per order that the mid price walks one tick up or down
+    double walk_probability{0.1};
+    // Passive orders rest at most this many ticks behind the mid, clustered near it
+    Price price_range{20};
+    // Share of orders priced through the mid so they trade on arrival
+    double aggressive_ratio{0.2};
+    // Aggressive orders reach at most this many ticks past the mid
+    Price sweep_depth{3};
+    // Aggressive quantities are scaled by this, so large values sweep several levels
+    double sweep_size_factor{1.0};
+    double iceberg_ratio{0.05};
+    // Quantities are log-normal around the median
+    Quantity median_qty{100};
+    double qty_sigma{0.8};
+    // Shares of messages that cancel or amend one of the recent orders, which may
+    // have left the book already. Only nextMessage draws them.
+    double cancel_ratio{0.0};
+    double amend_ratio{0.0};
+};
+
+// Seeded synthetic order flow. Bids rest at or below the mid and asks above it,
+// while the mid follows a bounded random walk. Standard library distributions
+// differ between implementations, so write a replay file to reproduce a flow
+// exactly on another toolchain.
+class OrderFlowGenerator {
+public:
+    explicit OrderFlowGenerator(const OrderFlowParams& params);
+    ~OrderFlowGenerator() = default;
+
+    OrderFlowGenerator(const OrderFlowGenerator&) = delete;
+    OrderFlowGenerator(OrderFlowGenerator&&) = delete;
+    OrderFlowGenerator& operator=(const OrderFlowGenerator&) = delete;
+    OrderFlowGenerator& operator=(OrderFlowGenerator&&) = delete;
+
+    [[nodiscard]] Order next();
+    // A new order, or a cancel or amend as often as the params ask. With neither
+    // the orders are those next() would return.
+    [[nodiscard]] OrderMessage nextMessage();
+    // Writes the next count messages as a replay file
+    void write(OrderWriter& writer, size_t count);
+
+    [[nodiscard]] Price midPrice() const noexcept;
+
+private:
+    OrderFlowParams params_;
+    std::mt19937_64 gen_;
+    std::bernoulli_distribution walk_dist_;
+    std::bernoulli_distribution aggressive_dist_;
+    std::bernoulli_distribution iceberg_dist_;
+    std::geometric_distribution<int> offset_dist_;
+    std::lognormal_distribution<double> qty_dist_;
+    std::uniform_real_distribution<double> message_dist_;
+    OrderId next_id_{1};
+    Price mid_;
+
+    // Cancels and amends pick one of this many latest orders
+    static constexpr OrderId RECENT_ORDER_COUNT = 1000;
+
+    void walk();
+    [[nodiscard]] Quantity drawQty(double factor);
+
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+#include "types.h"
+
+// Order input/output in two formats:
+//
+// CSV, one order per line:
+//   "B|S,id,price,quantity[,peak][,MKT][,STOP,stop price][,GTC|IOC|FOK|POST]"
+// A peak makes the order an iceberg, MKT a market order whose price is ignored.
+// STOP holds either until a trade reaches the stop price. The last field sets
+// the time in force, GTC if absent. A cancel is "C,id" and an amend
+// "A,id,price,quantity" with the new total quantity. Whitespace is ignored, lines
+// that don't start with B, S, C or A are skipped, and so are lines with an
+// unknown word.
+//
+// Binary, a fixed-width 40-byte little-endian record per message:
+//   offset  size  field
+//        0     1  side (0 = buy, 1 = sell)
+//        1     1  type (0 = limit, 1 = iceberg, 2 = market, 3 = stop, 4 = stop-limit)
+//        2     1  time in force (0 = GTC, 1 = IOC, 2 = FOK, 3 = post-only)
+//        3     1  message kind (0 = order, 1 = cancel, 2 = amend)
+//        4     4  price
+//        8     8  id
+//       16     8  total quantity
+//       24     8  peak quantity
+//       32     4  stop price
+//       36     4  reserved, zero
+// A cancel only sets the id and an amend the id, price and total quantity, the
+// other fields are zero. Records with an unknown kind, side, type or time in
+// force, or a field out of the range of Order, are skipped.
+enum class OrderFormat { CSV, BINARY };
+
+// A new order, or a cancel or amend of a resting one
+struct OrderMessage {
+    enum class Kind : uint8_t { ORDER, CANCEL, AMEND };
+
+    Kind kind;
+    // A cancel only sets the id, an amend the id, the new price and the new total
+    // quantity as visible_qty
+    Order order;
+};
+
+// Decodes orders straight out of a large read buffer, so no allocation happens per order
+class OrderReader {
+public:
+    static constexpr size_t DEFAULT_BUFFER_SIZE = size_t{1} << 20;
+
+public:
+    OrderReader(std::FILE* file, OrderFormat format, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+    ~OrderReader() = default;
+
+    OrderReader(const OrderReader&) = delete;
+    OrderReader(OrderReader&&) = delete;
+    OrderReader& operator=(const OrderReader&) = delete;
+    OrderReader& operator=(OrderReader&&) = delete;
+
+    // Return false once the input is exhausted. The order overload skips cancels
+    // and amends.
+    bool next(Order& order);
+    bool next(OrderMessage& message);
+
+private:
+    std::FILE* file_;
+    OrderFormat format_;
+    std::vector<char> buffer_;
+    size_t begin_{0};
+    size_t end_{0};
+    bool eof_{false};
+
+    bool nextCsv(OrderMessage& message);
+    bool nextBinary(OrderMessage& message);
+    // Moves unread bytes to the front and reads more. Returns false if nothing was read.
+    bool refill();
+
+};
+
+class OrderWriter {
+public:
+    static constexpr size_t DEFAULT_BUFFER_SIZE = size_t{1} << 16;
+
+public:
+    OrderWriter(std::FILE* file, OrderFormat format, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+    ~OrderWriter();
+
+    OrderWriter(const OrderWriter&) = delete;
+    OrderWriter(OrderWriter&&) = delete;
+    OrderWriter& operator=(const OrderWriter&) = delete;
+    OrderWriter& operator=(OrderWriter&&) = delete;
+
+    void write(const Order& order);
+    void write(const OrderMessage& message);
+    void flush();
+
+private:
+    std::FILE* file_;
+    OrderFormat format_;
+    std::vector<char> buffer_;
+    size_t size_{0};
+
+};
+
+namespace order_io {
+    inline constexpr size_t BINARY_RECORD_SIZE = 40;
+    // Longest CSV line the writer produces
+    inline constexpr size_t MAX_CSV_LINE_SIZE = 96;
+
+    // Return false if the record holds no valid message, or for the order
+    // overload no valid order
+    [[nodiscard]] bool decodeBinary(const char* record, Order& order) noexcept;
+    [[nodiscard]] bool decodeBinary(const char* record, OrderMessage& message) noexcept;
+    void encodeBinary(const Order& order, char* record) noexcept;
+    void encodeBinary(const OrderMessage& message, char* record) noexcept;
+
+    // Parse a line without its terminator. Return false if it holds no message, or
+    // for the order overload no order.
+    [[nodiscard]] bool parseCsv(const char* begin, const char* end, Order& order) noexcept;
+    [[nodiscard]] bool parseCsv(const char* begin, const char* end, OrderMessage& message) noexcept;
+    // Return the end of the written line, including the '\n'
+    char* formatCsv(const Order& order, char* out) noexcept;
+    char* formatCsv(const OrderMessage& message, char* out) noexcept;
+}
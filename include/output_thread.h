@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <thread>
+
+#include "matching_engine.h"
+#include "spsc_ring.h"
+#include "types.h"
+
+// What the matching thread does when it publishes faster than the output drains
+enum class BackpressurePolicy : uint8_t {
+    // Waits for room, so every event is written
+    BLOCK,
+    // Skips a whole book dump unless the ring has room for it. Trades and deltas
+    // still wait, since the output would be wrong without them. A dump too large
+    // for even an empty ring is skipped too, and counted apart.
+    DROP_BOOKS
+};
+
+// One record of the output stream. A book dump is a BOOK_BEGIN, a row per depth
+// and a BOOK_END, so the matching thread only copies the fields that get printed.
+template <class Traits>
+struct BasicOutputEvent {
+    using OrderId = typename Traits::OrderId;
+    using Price = typename Traits::Price;
+    using Quantity = typename Traits::Quantity;
+
+    enum class Kind : uint8_t { TRADE, DELTA, BOOK_BEGIN, BOOK_ROW, BOOK_END };
+
+    // The printed fields of a resting order
+    struct BookOrder {
+        OrderId id;
+        Quantity visible_qty;
+        Price price;
+    };
+
+    // The orders at the same depth on each side, if that side is deep enough
+    struct BookRow {
+        BookOrder buy;
+        BookOrder sell;
+        bool has_buy;
+        bool has_sell;
+    };
+
+    Kind kind;
+    union {
+        BasicTrade<Traits> trade;
+        BasicLevelDelta<Traits> delta;
+        BookRow row;
+    };
+};
+
+// Formats and writes trades, deltas and book dumps on its own thread, so a slow
+// reader of the stream never stalls matching. The matching thread only copies
+// events into a lock-free ring. The output thread renders whatever has queued up
+// into one buffer and writes it with a single call, flushing once it runs dry.
+template <class Traits, size_t Capacity = size_t{1} << 16>
+class BasicOutputThread {
+public:
+    using Event = BasicOutputEvent<Traits>;
+    using Ring = SpscRing<Event, Capacity>;
+    using Trade = BasicTrade<Traits>;
+    using LevelDelta = BasicLevelDelta<Traits>;
+
+    // A batch is written once it grows this large, even if more events are queued
+    static constexpr size_t BATCH_SIZE = size_t{1} << 16;
+
+public:
+    explicit BasicOutputThread(std::ostream& os = std::cout,
+        BackpressurePolicy policy = BackpressurePolicy::BLOCK);
+    // Writes every event published so far before returning
+    ~BasicOutputThread();
+
+    BasicOutputThread(const BasicOutputThread&) = delete;
+    BasicOutputThread(BasicOutputThread&&) = delete;
+    BasicOutputThread& operator=(const BasicOutputThread&) = delete;
+    BasicOutputThread& operator=(BasicOutputThread&&) = delete;
+
+    // Must be called from a single producer thread
+    void publishTrades(std::span<const Trade> trades) noexcept;
+    void publishDeltas(std::span<const LevelDelta> deltas) noexcept;
+    // Copies out the book, printed as Printer::print(engine) does. Returns false if
+    // the policy dropped it, or it can never fit.
+    template <class Config>
+    bool publishBook(const BasicMatchingEngine<Config>& engine) noexcept;
+
+    [[nodiscard]] BackpressurePolicy policy() const noexcept;
+    // Book dumps dropped so far for lack of room, and those larger than the whole
+    // ring. Only meaningful on the producer thread.
+    [[nodiscard]] uint64_t droppedBooks() const noexcept;
+    [[nodiscard]] uint64_t oversizedBooks() const noexcept;
+
+private:
+    std::ostream& os_;
+    BackpressurePolicy policy_;
+    uint64_t dropped_books_{0};
+    uint64_t oversized_books_{0};
+    std::unique_ptr<Ring> ring_;
+    std::atomic<bool> running_{true};
+    std::thread thread_;
+
+    void push(const Event& event) noexcept;
+
+    void run();
+    // Renders the event as Printer does and returns the new end
+    static char* render(const Event& event, char* out) noexcept;
+    // Room the longest event needs, a book row or the book header or footer
+    [[nodiscard]] static size_t maxEventSize() noexcept;
+
+};
+
+using OutputThread = BasicOutputThread<DefaultOrderTraits>;
+
+#include "output_thread.inl"
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "printer.h"
+#include "util.h"
+
+template <class Traits, size_t Capacity>
+BasicOutputThread<Traits, Capacity>::BasicOutputThread(
+    std::ostream& os, BackpressurePolicy policy)
+    : os_(os)
+    , policy_(policy)
+    , ring_(std::make_unique<Ring>())
+    , thread_([this] { run(); }) {
+}
+
+template <class Traits, size_t Capacity>
+BasicOutputThread<Traits, Capacity>::~BasicOutputThread() {
+    running_.store(false, std::memory_order_release);
+    thread_.join();
+}
+
+template <class Traits, size_t Capacity>
+ALWAYS_INLINE void BasicOutputThread<Traits, Capacity>::publishTrades(
+    std::span<const Trade> trades) noexcept {
+    for (const auto& trade : trades)
+        push(Event{.kind = Event::Kind::TRADE, .trade = trade});
+}
+
+template <class Traits, size_t Capacity>
+ALWAYS_INLINE void BasicOutputThread<Traits, Capacity>::publishDeltas(
+    std::span<const LevelDelta> deltas) noexcept {
+    for (const auto& delta : deltas)
+        push(Event{.kind = Event::Kind::DELTA, .delta = delta});
+}
+
+template <class Traits, size_t Capacity>
+template <class Config>
+bool BasicOutputThread<Traits, Capacity>::publishBook(
+    const BasicMatchingEngine<Config>& engine) noexcept {
+    static_assert(std::is_same_v<typename Config::Traits, Traits>);
+
+    // A dump is a row per order on the deeper side plus its two markers, so once
+    // that much is free nothing below waits
+    if (policy_ == BackpressurePolicy::DROP_BOOKS) {
+        auto event_count = std::max(engine.orderCount(Order::Side::BUY),
+            engine.orderCount(Order::Side::SELL)) + 2;
+        if (event_count > Ring::capacity()) {
+            ++oversized_books_;
+            return false;
+        }
+        if (Ring::capacity() - ring_->size() < event_count) {
+            ++dropped_books_;
+            return false;
+        }
+    }
+
+    // The markers carry no payload
+    push(Event{.kind = Event::Kind::BOOK_BEGIN, .trade = {}});
+    auto buy_iter = engine.buyBegin();
+    auto sell_iter = engine.sellBegin();
+    while (buy_iter != engine.buyEnd() || sell_iter != engine.sellEnd()) {
+        typename Event::BookRow row{};
+        if (buy_iter != engine.buyEnd()) {
+            const auto& order = *buy_iter++;
+            row.buy = {.id = order.id, .visible_qty = order.visible_qty, .price = order.price};
+            row.has_buy = true;
+        }
+        if (sell_iter != engine.sellEnd()) {
+            const auto& order = *sell_iter++;
+            row.sell = {.id = order.id, .visible_qty = order.visible_qty, .price = order.price};
+            row.has_sell = true;
+        }
+        push(Event{.kind = Event::Kind::BOOK_ROW, .row = row});
+    }
+    push(Event{.kind = Event::Kind::BOOK_END, .trade = {}});
+    return true;
+}
+
+template <class Traits, size_t Capacity>
+ALWAYS_INLINE BackpressurePolicy BasicOutputThread<Traits, Capacity>::policy() const noexcept {
+    return policy_;
+}
+
+template <class Traits, size_t Capacity>
+ALWAYS_INLINE uint64_t BasicOutputThread<Traits, Capacity>::droppedBooks() const noexcept {
+    return dropped_books_;
+}
+
+template <class Traits, size_t Capacity>
+ALWAYS_INLINE uint64_t BasicOutputThread<Traits, Capacity>::oversizedBooks() const noexcept {
+    return oversized_books_;
+}
+
+template <class Traits, size_t Capacity>
+ALWAYS_INLINE void BasicOutputThread<Traits, Capacity>::push(const Event& event) noexcept {
+    while (!ring_->tryPush(event))
+        std::this_thread::yield();
+}
+
+template <class Traits, size_t Capacity>
+void BasicOutputThread<Traits, Capacity>::run() {
+    std::vector<char> buffer(BATCH_SIZE + maxEventSize());
+    size_t size = 0;
+    bool unflushed = false;
+    for (;;) {
+        const auto* event = ring_->front();
+        if (!event) {
+            if (size) {
+                os_.write(buffer.data(), static_cast<std::streamsize>(size));
+                size = 0;
+                unflushed = true;
+            }
+            if (unflushed) {
+                os_.flush();
+                unflushed = false;
+            }
+            if (!running_.load(std::memory_order_acquire) && ring_->empty())
+                return;
+            std::this_thread::yield();
+            continue;
+        }
+
+        size = static_cast<size_t>(render(*event, buffer.data() + size) - buffer.data());
+        ring_->pop();
+        if (size >= BATCH_SIZE) {
+            os_.write(buffer.data(), static_cast<std::streamsize>(size));
+            size = 0;
+            unflushed = true;
+        }
+    }
+}
+
+template <class Traits, size_t Capacity>
+char* BasicOutputThread<Traits, Capacity>::render(const Event& event, char* out) noexcept {
+    auto toOrder = [](const typename Event::BookOrder& order, OrderSide side) {
+        return BasicOrder<Traits>{
+            .side = side,
+            .type = OrderType::LIMIT,
+            .id = order.id,
+            .price = order.price,
+            .visible_qty = order.visible_qty,
+            .peak_qty = order.visible_qty,
+            .hidden_qty = 0
+        };
+    };
+
+    switch (event.kind) {
+    case Event::Kind::TRADE:
+        return Printer::render(event.trade, out);
+    case Event::Kind::DELTA:
+        return Printer::render(event.delta, out);
+    case Event::Kind::BOOK_BEGIN: {
+        const auto& header = Printer::bookHeaderText();
+        return std::copy(std::begin(header), std::end(header), out);
+    }
+    case Event::Kind::BOOK_ROW: {
+        const auto& row = event.row;
+        return Printer::renderBookRow(
+            row.has_buy ? std::optional{toOrder(row.buy, OrderSide::BUY)} : std::nullopt,
+            row.has_sell ? std::optional{toOrder(row.sell, OrderSide::SELL)} : std::nullopt,
+            out);
+    }
+    case Event::Kind::BOOK_END: {
+        const auto& footer = Printer::bookFooterText();
+        return std::copy(std::begin(footer), std::end(footer), out);
+    }
+    }
+    return out;
+}
+
+template <class Traits, size_t Capacity>
+size_t BasicOutputThread<Traits, Capacity>::maxEventSize() noexcept {
+    return std::max({Printer::MAX_ROW_SIZE, Printer::MAX_LINE_SIZE,
+        Printer::bookHeaderText().size(), Printer::bookFooterText().size()});
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+struct PoolStats {
+    size_t capacity{0};
+    size_t in_use{0};
+    size_t high_water_mark{0};
+    // Slabs allocated after the initial one
+    size_t slab_growths{0};
+};
+
+// Fixed-size, free-list-backed slab allocator. The first slab is sized by the
+// capacity hint, and each further slab doubles the capacity. Deallocated slots
+// are reused, and memory is only returned to the system when the pool is destroyed.
+template <class T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    static constexpr size_t DEFAULT_CAPACITY = size_t{1} << 14;
+
+public:
+    explicit PoolAllocator(size_t capacity = DEFAULT_CAPACITY);
+    ~PoolAllocator() = default;
+
+    PoolAllocator(const PoolAllocator&) = delete;
+    PoolAllocator(PoolAllocator&&) = delete;
+    PoolAllocator& operator=(const PoolAllocator&) = delete;
+    PoolAllocator& operator=(PoolAllocator&&) = delete;
+
+    [[nodiscard]] T* allocate(size_t n);
+    void deallocate(T* ptr, size_t n) noexcept;
+
+    [[nodiscard]] const PoolStats& stats() const noexcept;
+
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> slabs_;
+    Slot* free_list_{nullptr};
+    PoolStats stats_;
+
+    void addSlab(size_t slot_count);
+
+};
+
+#include "pool_allocator.inl"
@@ -0,0 +1,47 @@
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+#include "util.h"
+
+template <class T>
+PoolAllocator<T>::PoolAllocator(size_t capacity) {
+    addSlab(std::max(capacity, size_t{1}));
+}
+
+template <class T>
+ALWAYS_INLINE T* PoolAllocator<T>::allocate(size_t n) {
+    assert(n == 1);
+
+    if (!free_list_) {
+        addSlab(stats_.capacity);
+        ++stats_.slab_growths;
+    }
+
+    auto* slot = std::exchange(free_list_, free_list_->next);
+    stats_.high_water_mark = std::max(stats_.high_water_mark, ++stats_.in_use);
+    return reinterpret_cast<T*>(slot->storage);
+}
+
+template <class T>
+ALWAYS_INLINE void PoolAllocator<T>::deallocate(T* ptr, size_t n) noexcept {
+    assert(ptr && n == 1);
+
+    auto* slot = reinterpret_cast<Slot*>(ptr);
+    slot->next = std::exchange(free_list_, slot);
+    --stats_.in_use;
+}
+
+template <class T>
+ALWAYS_INLINE const PoolStats& PoolAllocator<T>::stats() const noexcept {
+    return stats_;
+}
+
+template <class T>
+void PoolAllocator<T>::addSlab(size_t slot_count) {
+    auto& slab = slabs_.emplace_back(std::make_unique_for_overwrite<Slot[]>(slot_count));
+    // Thread the free list in address order so consecutive allocations are adjacent
+    for (size_t idx = slot_count; idx-- > 0;)
+        slab[idx].next = std::exchange(free_list_, &slab[idx]);
+    stats_.capacity += slot_count;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+
+#include "types.h"
+
+template <class Level, class Compare>
+class PriceLadder;
+
+namespace impl {
+    template <class Level, class Compare>
+    class PriceLadderIterator;
+}
+
+// Price levels kept in a flat array indexed by the tick offset from the lowest
+// representable price. A two-level occupancy bitmap finds the next non-empty level
+// and the best level is cached, so no lookup walks a tree or allocates. Compare
+// only fixes the direction: std::greater for bids, std::less for asks.
+template <class Level, class Compare>
+class PriceLadder {
+private:
+    using Allocator = typename Level::allocator_type;
+    using Price = typename Level::Price;
+    using LevelAllocator = std::allocator<Level>;
+    using Word = uint64_t;
+
+    static_assert(sizeof(Price) <= 2, "The ladder spans the whole Price domain");
+
+    static constexpr Price BASE_PRICE = std::numeric_limits<Price>::min();
+    static constexpr size_t LEVEL_COUNT = size_t{1} << (8 * sizeof(Price));
+    static constexpr size_t WORD_BITS = 64;
+    static constexpr size_t WORD_COUNT = LEVEL_COUNT / WORD_BITS;
+    static constexpr size_t SUMMARY_WORD_COUNT = (WORD_COUNT + WORD_BITS - 1) / WORD_BITS;
+    static constexpr size_t NONE = LEVEL_COUNT;
+    static constexpr bool IS_BUY = Compare{}(Price{1}, Price{0});
+
+public:
+    using Iterator = impl::PriceLadderIterator<Level, Compare>;
+
+public:
+    explicit PriceLadder(Allocator& alloc);
+    ~PriceLadder();
+
+    PriceLadder(const PriceLadder&) = delete;
+    PriceLadder(PriceLadder&&) = delete;
+    PriceLadder& operator=(const PriceLadder&) = delete;
+    PriceLadder& operator=(PriceLadder&&) = delete;
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] Price bestPrice() const;
+    [[nodiscard]] const Level& best() const;
+    [[nodiscard]] Level& best();
+    [[nodiscard]] Level* find(Price price);
+    [[nodiscard]] const Level* find(Price price) const;
+
+    Level& levelAt(Price price);
+    // Adds a level worse than every existing one, for building a book in price order
+    Level& appendWorst(Price price);
+    void erase(const Level& level);
+
+    [[nodiscard]] Iterator begin() const noexcept;
+    [[nodiscard]] Iterator end() const noexcept;
+
+private:
+    size_t best_{NONE};
+    LevelAllocator level_alloc_;
+    Level* levels_;
+    std::array<Word, WORD_COUNT> occupied_{};
+    std::array<Word, SUMMARY_WORD_COUNT> occupied_words_{};
+
+    [[nodiscard]] static size_t indexOf(Price price) noexcept;
+
+    [[nodiscard]] bool isOccupied(size_t idx) const noexcept;
+    void setOccupied(size_t idx) noexcept;
+    void clearOccupied(size_t idx) noexcept;
+
+    // Index of the next occupied level worse than idx, or NONE
+    [[nodiscard]] size_t nextWorse(size_t idx) const noexcept;
+    // First occupied index >= idx, or NONE
+    [[nodiscard]] size_t scanUp(size_t idx) const noexcept;
+    // Last occupied index < end, or NONE
+    [[nodiscard]] size_t scanDown(size_t end) const noexcept;
+
+    friend Iterator;
+
+};
+
+namespace impl {
+    template <class Level, class Compare>
+    class PriceLadderIterator {
+    public:
+        using value_type = Level;
+        using reference = const value_type&;
+        using pointer = const value_type*;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+    public:
+        PriceLadderIterator() = default;
+        PriceLadderIterator(const PriceLadderIterator&) = default;
+        PriceLadderIterator(PriceLadderIterator&&) = default;
+        PriceLadderIterator& operator=(const PriceLadderIterator&) = default;
+        PriceLadderIterator& operator=(PriceLadderIterator&&) = default;
+
+        [[nodiscard]] reference operator*() const noexcept;
+        [[nodiscard]] pointer operator->() const noexcept;
+
+        PriceLadderIterator& operator++() noexcept;
+        PriceLadderIterator operator++(int) noexcept;
+
+        bool operator==(const PriceLadderIterator&) const = default;
+        bool operator!=(const PriceLadderIterator&) const = default;
+
+    private:
+        PriceLadderIterator(const PriceLadder<Level, Compare>* ladder, size_t idx);
+
+        friend class PriceLadder<Level, Compare>;
+
+        const PriceLadder<Level, Compare>* ladder_{nullptr};
+        size_t idx_{0};
+
+    };
+}
+
+#include "price_ladder.inl"
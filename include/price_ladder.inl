@@ -0,0 +1,209 @@
+#include <bit>
+#include <cassert>
+#include <new>
+
+#include "util.h"
+
+template <class Level, class Compare>
+ALWAYS_INLINE PriceLadder<Level, Compare>::PriceLadder(Allocator& alloc)
+    : levels_(level_alloc_.allocate(LEVEL_COUNT)) {
+    for (size_t idx = 0; idx < LEVEL_COUNT; ++idx)
+        ::new (levels_ + idx) Level(static_cast<Price>(BASE_PRICE + static_cast<int64_t>(idx)), alloc);
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE PriceLadder<Level, Compare>::~PriceLadder() {
+    for (size_t idx = 0; idx < LEVEL_COUNT; ++idx)
+        levels_[idx].~Level();
+    level_alloc_.deallocate(levels_, LEVEL_COUNT);
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE bool PriceLadder<Level, Compare>::empty() const noexcept {
+    return best_ == NONE;
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE auto PriceLadder<Level, Compare>::bestPrice() const -> Price {
+    return best().price();
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE const Level& PriceLadder<Level, Compare>::best() const {
+    assert(!empty());
+    return levels_[best_];
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE Level& PriceLadder<Level, Compare>::best() {
+    assert(!empty());
+    return levels_[best_];
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE Level* PriceLadder<Level, Compare>::find(Price price) {
+    auto idx = indexOf(price);
+    return isOccupied(idx) ? levels_ + idx : nullptr;
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE const Level* PriceLadder<Level, Compare>::find(Price price) const {
+    auto idx = indexOf(price);
+    return isOccupied(idx) ? levels_ + idx : nullptr;
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE Level& PriceLadder<Level, Compare>::levelAt(Price price) {
+    auto idx = indexOf(price);
+    if (!isOccupied(idx)) {
+        setOccupied(idx);
+        if (best_ == NONE || (IS_BUY ? idx > best_ : idx < best_))
+            best_ = idx;
+    }
+    return levels_[idx];
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE Level& PriceLadder<Level, Compare>::appendWorst(Price price) {
+    auto idx = indexOf(price);
+    assert(!isOccupied(idx) && nextWorse(idx) == NONE);
+    setOccupied(idx);
+    if (best_ == NONE)
+        best_ = idx;
+    return levels_[idx];
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE void PriceLadder<Level, Compare>::erase(const Level& level) {
+    assert(level.empty());
+
+    auto idx = indexOf(level.price());
+    assert(isOccupied(idx));
+    clearOccupied(idx);
+    if (idx == best_)
+        best_ = nextWorse(idx);
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE auto PriceLadder<Level, Compare>::begin() const noexcept -> Iterator {
+    return Iterator{this, best_};
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE auto PriceLadder<Level, Compare>::end() const noexcept -> Iterator {
+    return Iterator{this, NONE};
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE size_t PriceLadder<Level, Compare>::indexOf(Price price) noexcept {
+    return static_cast<size_t>(static_cast<int64_t>(price) - BASE_PRICE);
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE bool PriceLadder<Level, Compare>::isOccupied(size_t idx) const noexcept {
+    return (occupied_[idx / WORD_BITS] >> (idx % WORD_BITS)) & 1;
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE void PriceLadder<Level, Compare>::setOccupied(size_t idx) noexcept {
+    auto word_idx = idx / WORD_BITS;
+    occupied_[word_idx] |= Word{1} << (idx % WORD_BITS);
+    occupied_words_[word_idx / WORD_BITS] |= Word{1} << (word_idx % WORD_BITS);
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE void PriceLadder<Level, Compare>::clearOccupied(size_t idx) noexcept {
+    auto word_idx = idx / WORD_BITS;
+    occupied_[word_idx] &= ~(Word{1} << (idx % WORD_BITS));
+    if (!occupied_[word_idx])
+        occupied_words_[word_idx / WORD_BITS] &= ~(Word{1} << (word_idx % WORD_BITS));
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE size_t PriceLadder<Level, Compare>::nextWorse(size_t idx) const noexcept {
+    if constexpr (IS_BUY)
+        return scanDown(idx);
+    else
+        return scanUp(idx + 1);
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE size_t PriceLadder<Level, Compare>::scanUp(size_t idx) const noexcept {
+    if (idx >= LEVEL_COUNT)
+        return NONE;
+
+    auto word_idx = idx / WORD_BITS;
+    auto word = occupied_[word_idx] & (~Word{0} << (idx % WORD_BITS));
+    if (word)
+        return word_idx * WORD_BITS + std::countr_zero(word);
+
+    if (++word_idx == WORD_COUNT)
+        return NONE;
+    auto summary_idx = word_idx / WORD_BITS;
+    auto summary = occupied_words_[summary_idx] & (~Word{0} << (word_idx % WORD_BITS));
+    while (!summary) {
+        if (++summary_idx == SUMMARY_WORD_COUNT)
+            return NONE;
+        summary = occupied_words_[summary_idx];
+    }
+    word_idx = summary_idx * WORD_BITS + std::countr_zero(summary);
+    return word_idx * WORD_BITS + std::countr_zero(occupied_[word_idx]);
+}
+
+template <class Level, class Compare>
+ALWAYS_INLINE size_t PriceLadder<Level, Compare>::scanDown(size_t end) const noexcept {
+    if (end == 0)
+        return NONE;
+
+    auto idx = end - 1;
+    auto word_idx = idx / WORD_BITS;
+    auto word = occupied_[word_idx] & (~Word{0} >> (WORD_BITS - 1 - idx % WORD_BITS));
+    if (word)
+        return word_idx * WORD_BITS + (WORD_BITS - 1 - std::countl_zero(word));
+
+    if (word_idx-- == 0)
+        return NONE;
+    auto summary_idx = word_idx / WORD_BITS;
+    auto summary = occupied_words_[summary_idx] & (~Word{0} >> (WORD_BITS - 1 - word_idx % WORD_BITS));
+    while (!summary) {
+        if (summary_idx-- == 0)
+            return NONE;
+        summary = occupied_words_[summary_idx];
+    }
+    word_idx = summary_idx * WORD_BITS + (WORD_BITS - 1 - std::countl_zero(summary));
+    return word_idx * WORD_BITS + (WORD_BITS - 1 - std::countl_zero(occupied_[word_idx]));
+}
+
+namespace impl {
+    template <class Level, class Compare>
+    ALWAYS_INLINE PriceLadderIterator<Level, Compare>::PriceLadderIterator(
+        const PriceLadder<Level, Compare>* ladder, size_t idx)
+        : ladder_(ladder)
+        , idx_(idx) {
+    }
+
+    template <class Level, class Compare>
+    ALWAYS_INLINE auto PriceLadderIterator<Level, Compare>::operator*() const noexcept -> reference {
+        assert(ladder_ && ladder_->isOccupied(idx_));
+        return ladder_->levels_[idx_];
+    }
+
+    template <class Level, class Compare>
+    ALWAYS_INLINE auto PriceLadderIterator<Level, Compare>::operator->() const noexcept -> pointer {
+        return &(operator*());
+    }
+
+    template <class Level, class Compare>
+    ALWAYS_INLINE auto PriceLadderIterator<Level, Compare>::operator++() noexcept -> PriceLadderIterator& {
+        assert(ladder_);
+        idx_ = ladder_->nextWorse(idx_);
+        return *this;
+    }
+
+    template <class Level, class Compare>
+    ALWAYS_INLINE auto PriceLadderIterator<Level, Compare>::operator++(int) noexcept -> PriceLadderIterator {
+        PriceLadderIterator tmp(*this);
+        ++(*this);
+        return tmp;
+    }
+}
@@ -1,22 +1,71 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
 
 #include "types.h"
 
-struct OrderNode {
-    Order order;
-    OrderNode *next;
+// A resting order as the level stores it. Side and price are the same for every
+// order in a level, so they live with the level and the node keeps only what a
+// fill reads and writes, ahead of the back link.
+template <class TraitsT>
+struct BasicOrderNode {
+    using Traits = TraitsT;
+    using Order = BasicOrder<Traits>;
+
+    typename Traits::OrderId id;
+    typename Traits::Quantity visible_qty;
+    typename Traits::Quantity hidden_qty;
+    typename Traits::Quantity peak_qty;
+    // Position of this order's trade in the engine's current trade list. Only
+    // trusted if that entry names this order, so it never needs resetting.
+    uint32_t trade_idx;
+    OrderType type;
+    // Only GTC and POST_ONLY orders rest, kept so an amend re-enters the order alike
+    OrderTimeInForce tif;
+    BasicOrderNode *next;
+    // Only followed when an order leaves from the middle of its level
+    BasicOrderNode *prev;
+
+    // The full order, given the side and price of the level it rests in
+    [[nodiscard]] Order order(OrderSide side, typename Traits::Price price) const noexcept;
 };
 
+using OrderNode = BasicOrderNode<DefaultOrderTraits>;
+
+// Resting orders are walked on every match, so the layouts are pinned down. A
+// sweep reads nothing past the forward link, which ends within 32 bytes. Nodes
+// keep their natural alignment: cache-line aligning them would pad each to 64
+// bytes, so fewer resting orders would share a line.
+static_assert(sizeof(OrderNode) == 40);
+static_assert(alignof(OrderNode) == alignof(void*));
+static_assert(offsetof(OrderNode, next) == 24);
+static_assert(offsetof(OrderNode, prev) == 32);
+static_assert(sizeof(BasicOrderNode<WideOrderTraits>) == 56);
+
 namespace impl {
+    template <class Node>
     class PriceLevelIterator;
 }
 
+// The allocator's value_type is the node type, which fixes the order layout
 template <class Allocator>
 class PriceLevel {
 public:
-    using Iterator = impl::PriceLevelIterator;
+    using allocator_type = Allocator;
+    using Node = typename Allocator::value_type;
+    using Traits = typename Node::Traits;
+    using Order = BasicOrder<Traits>;
+    using Price = typename Traits::Price;
+    using Quantity = typename Traits::Quantity;
+    // How the order index refers to a resting order
+    using Handle = Node*;
+    using Iterator = impl::PriceLevelIterator<Node>;
+
+    // An order keeps its handle for as long as it rests, so the level never
+    // needs to update the index's copy
+    static constexpr bool TRACKS_HANDLES = false;
 
     PriceLevel(Price price, Allocator &alloc);
     ~PriceLevel();
@@ -28,30 +77,45 @@ public:
 
     [[nodiscard]] Price price() const noexcept;
     [[nodiscard]] bool empty() const noexcept;
+    // Running totals over every order in the level
+    [[nodiscard]] Quantity visibleQty() const noexcept;
+    [[nodiscard]] Quantity hiddenQty() const noexcept;
+    [[nodiscard]] uint32_t orderCount() const noexcept;
 
-    [[nodiscard]] const Order& front() const noexcept;
-    [[nodiscard]] Order& front() noexcept;
+    [[nodiscard]] const Node& front() const noexcept;
+    [[nodiscard]] Node& front() noexcept;
+    [[nodiscard]] Node& node(Handle handle) noexcept;
+    [[nodiscard]] const Node& node(Handle handle) const noexcept;
 
-    void pushBack(const Order &order);
+    Handle pushBack(const Order &order);
     void popFront();
+    void erase(Handle handle);
+    // Moves the front order behind the last one, reusing its node
+    Handle rotateFront() noexcept;
+    // Changes the quantities of a resting order, keeping the totals in step
+    void updateQty(Node& node, Quantity visible_qty, Quantity hidden_qty) noexcept;
 
     [[nodiscard]] Iterator begin() const noexcept;
     [[nodiscard]] Iterator end() const noexcept;
 
 private:
     Price price_;
-    OrderNode* head_{nullptr};
-    OrderNode* tail_{nullptr};
+    Node* head_{nullptr};
+    Node* tail_{nullptr};
+    Quantity visible_qty_{0};
+    Quantity hidden_qty_{0};
+    uint32_t order_count_{0};
     Allocator& alloc_;
 
 };
 
 namespace impl {
+    template <class Node>
     class PriceLevelIterator {
     public:
-        using value_type = Order;
-        using reference = const Order&;
-        using pointer = const Order*;
+        using value_type = Node;
+        using reference = const value_type&;
+        using pointer = const value_type*;
         using difference_type = std::ptrdiff_t;
         using iterator_category = std::forward_iterator_tag;
 
@@ -72,12 +136,12 @@ namespace impl {
         bool operator!=(const PriceLevelIterator&) const = default;
 
     private:
-        explicit PriceLevelIterator(const OrderNode* node);
+        explicit PriceLevelIterator(const Node* node);
 
         template <class Allocator>
         friend class ::PriceLevel;
 
-        const OrderNode* node_{nullptr};
+        const Node* node_{nullptr};
 
     };
 }
@@ -5,6 +5,21 @@
 
 #include "util.h"
 
+template <class Traits>
+ALWAYS_INLINE auto BasicOrderNode<Traits>::order(
+    OrderSide side, typename Traits::Price price) const noexcept -> Order {
+    return Order{
+        .side = side,
+        .type = type,
+        .tif = tif,
+        .id = id,
+        .price = price,
+        .visible_qty = visible_qty,
+        .peak_qty = peak_qty,
+        .hidden_qty = hidden_qty
+    };
+}
+
 template <class Allocator>
 ALWAYS_INLINE PriceLevel<Allocator>::PriceLevel(Price price, Allocator& alloc)
     : price_(price)
@@ -18,7 +33,7 @@ ALWAYS_INLINE PriceLevel<Allocator>::~PriceLevel() {
 }
 
 template <class Allocator>
-ALWAYS_INLINE Price PriceLevel<Allocator>::price() const noexcept {
+ALWAYS_INLINE auto PriceLevel<Allocator>::price() const noexcept -> Price {
     return price_;
 }
 
@@ -28,40 +43,113 @@ ALWAYS_INLINE bool PriceLevel<Allocator>::empty() const noexcept {
 }
 
 template <class Allocator>
-ALWAYS_INLINE const Order& PriceLevel<Allocator>::front() const noexcept {
+ALWAYS_INLINE auto PriceLevel<Allocator>::visibleQty() const noexcept -> Quantity {
+    return visible_qty_;
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto PriceLevel<Allocator>::hiddenQty() const noexcept -> Quantity {
+    return hidden_qty_;
+}
+
+template <class Allocator>
+ALWAYS_INLINE uint32_t PriceLevel<Allocator>::orderCount() const noexcept {
+    return order_count_;
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto PriceLevel<Allocator>::front() const noexcept -> const Node& {
     assert(head_);
-    return head_->order;
+    return *head_;
 }
 
 template <class Allocator>
-ALWAYS_INLINE Order& PriceLevel<Allocator>::front() noexcept {
+ALWAYS_INLINE auto PriceLevel<Allocator>::front() noexcept -> Node& {
     assert(head_);
-    return head_->order;
+    return *head_;
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto PriceLevel<Allocator>::node(Handle handle) noexcept -> Node& {
+    assert(handle);
+    return *handle;
 }
 
 template <class Allocator>
-ALWAYS_INLINE void PriceLevel<Allocator>::pushBack(const Order& order) {
+ALWAYS_INLINE auto PriceLevel<Allocator>::node(Handle handle) const noexcept -> const Node& {
+    assert(handle);
+    return *handle;
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto PriceLevel<Allocator>::pushBack(const Order& order) -> Handle {
     auto* node = alloc_.allocate(1);
-    static_assert(std::is_same_v<decltype(node), OrderNode*>);
-    assert(node);
-    node = std::launder(::new (node) OrderNode{order, nullptr});
+    static_assert(std::is_same_v<decltype(node), Node*>);
+    assert(node && order.price == price_);
+    node = std::launder(::new (node) Node{
+        .id = order.id,
+        .visible_qty = order.visible_qty,
+        .hidden_qty = order.hidden_qty,
+        .peak_qty = order.peak_qty,
+        .trade_idx = UINT32_MAX,
+        .type = order.type,
+        .tif = order.tif,
+        .next = nullptr,
+        .prev = tail_
+    });
 
     if (tail_)
         tail_ = tail_->next = node;
     else
         head_ = tail_ = node;
+
+    visible_qty_ += order.visible_qty;
+    hidden_qty_ += order.hidden_qty;
+    ++order_count_;
+    return node;
 }
 
 template <class Allocator>
 ALWAYS_INLINE void PriceLevel<Allocator>::popFront() {
     assert(head_);
-    auto* node = std::exchange(head_, head_->next);
-    if (!head_)
-        tail_ = nullptr;
-    node->~OrderNode();
+    erase(head_);
+}
+
+template <class Allocator>
+ALWAYS_INLINE void PriceLevel<Allocator>::erase(Handle node) {
+    assert(node && order_count_);
+    visible_qty_ -= node->visible_qty;
+    hidden_qty_ -= node->hidden_qty;
+    --order_count_;
+
+    (node->prev ? node->prev->next : head_) = node->next;
+    (node->next ? node->next->prev : tail_) = node->prev;
+    node->~Node();
     alloc_.deallocate(node, 1);
 }
 
+template <class Allocator>
+ALWAYS_INLINE auto PriceLevel<Allocator>::rotateFront() noexcept -> Handle {
+    assert(head_);
+    if (head_ == tail_)
+        return head_;
+
+    auto* node = std::exchange(head_, head_->next);
+    head_->prev = nullptr;
+    node->prev = tail_;
+    node->next = nullptr;
+    return tail_ = tail_->next = node;
+}
+
+template <class Allocator>
+ALWAYS_INLINE void PriceLevel<Allocator>::updateQty(
+    Node& node, Quantity visible_qty, Quantity hidden_qty) noexcept {
+    visible_qty_ += visible_qty - node.visible_qty;
+    hidden_qty_ += hidden_qty - node.hidden_qty;
+    node.visible_qty = visible_qty;
+    node.hidden_qty = hidden_qty;
+}
+
 template <class Allocator>
 ALWAYS_INLINE auto PriceLevel<Allocator>::begin() const noexcept -> Iterator {
     return Iterator{head_};
@@ -73,26 +161,31 @@ ALWAYS_INLINE auto PriceLevel<Allocator>::end() const noexcept -> Iterator {
 }
 
 namespace impl {
-    ALWAYS_INLINE PriceLevelIterator::PriceLevelIterator(const OrderNode* node)
+    template <class Node>
+    ALWAYS_INLINE PriceLevelIterator<Node>::PriceLevelIterator(const Node* node)
         : node_(node) {
     }
 
-    ALWAYS_INLINE auto PriceLevelIterator::operator*() const noexcept -> reference {
+    template <class Node>
+    ALWAYS_INLINE auto PriceLevelIterator<Node>::operator*() const noexcept -> reference {
         assert(node_);
-        return node_->order;
+        return *node_;
     }
 
-    ALWAYS_INLINE auto PriceLevelIterator::operator->() const noexcept -> pointer {
+    template <class Node>
+    ALWAYS_INLINE auto PriceLevelIterator<Node>::operator->() const noexcept -> pointer {
         return &(operator*());
     }
 
-    ALWAYS_INLINE PriceLevelIterator& PriceLevelIterator::operator++() noexcept {
+    template <class Node>
+    ALWAYS_INLINE auto PriceLevelIterator<Node>::operator++() noexcept -> PriceLevelIterator& {
         assert(node_);
         node_ = node_->next;
         return *this;
     }
 
-    ALWAYS_INLINE PriceLevelIterator PriceLevelIterator::operator++(int) noexcept {
+    template <class Node>
+    ALWAYS_INLINE auto PriceLevelIterator<Node>::operator++(int) noexcept -> PriceLevelIterator {
         PriceLevelIterator tmp(*this);
         ++(*this);
         return tmp;
@@ -5,16 +5,62 @@
 #include <string_view>
 #include <array>
 #include <cstdint>
+#include <optional>
+#include <vector>
 
 #include "matching_engine.h"
 
+// Every order layout prints the same way, wide fields just take more digits
 class Printer {
 public:
-    static void print(const Trade& trade, std::ostream& os = std::cout);
+    // Every cell a row holds, with room for the widest 64-bit value and its grouping
+    static constexpr size_t MAX_CELL_SIZE = 32;
+    // Longest book row, and longest trade or delta line
+    static constexpr size_t MAX_ROW_SIZE = 6 * (1 + MAX_CELL_SIZE) + 2;
+    static constexpr size_t MAX_LINE_SIZE = 4 * (1 + MAX_CELL_SIZE);
 
-    static void print(const std::vector<Trade>& trades, std::ostream& os = std::cout);
+public:
+    template <class Traits>
+    static void print(const BasicTrade<Traits>& trade, std::ostream& os = std::cout);
+
+    template <class Traits>
+    static void print(const std::vector<BasicTrade<Traits>>& trades, std::ostream& os = std::cout);
+
+    // Format: side (B or S),price,visible quantity,order count
+    template <class Traits>
+    static void print(const BasicLevelDelta<Traits>& delta, std::ostream& os = std::cout);
+
+    template <class Traits>
+    static void print(const std::vector<BasicLevelDelta<Traits>>& deltas,
+        std::ostream& os = std::cout);
+
+    template <class Config>
+    static void print(const BasicMatchingEngine<Config>& engine, std::ostream& os = std::cout);
+
+    // Renders the book byte for byte as print(engine) does, straight into buffer
+    // with no stream formatting. The buffer only grows, so reusing it across calls
+    // saves reallocating. Returns the number of bytes rendered.
+    template <class Config>
+    static size_t render(const BasicMatchingEngine<Config>& engine, std::vector<char>& buffer);
+    // Renders into buffer and hands the whole book to the stream in one write
+    template <class Config>
+    static void printFast(const BasicMatchingEngine<Config>& engine, std::vector<char>& buffer,
+        std::ostream& os = std::cout);
 
-    static void print(const MatchingEngine& engine, std::ostream& os = std::cout);
+    // Pieces of render() for writers that lay out the output themselves
+    [[nodiscard]] static const std::string& bookHeaderText();
+    [[nodiscard]] static const std::string& bookFooterText();
+    template <class Traits>
+    static char* renderBookRow(const std::optional<BasicOrder<Traits>>& buy,
+        const std::optional<BasicOrder<Traits>>& sell, char* out) noexcept;
+    // Same text as print(trade) and print(delta). Return the new end.
+    template <class Traits>
+    static char* render(const BasicTrade<Traits>& trade, char* out) noexcept;
+    template <class Traits>
+    static char* render(const BasicLevelDelta<Traits>& delta, char* out) noexcept;
+
+    // One row per histogram: count, p50, p99, p99.9 and max, then the slowest message
+    static void print(const LatencyStats& stats, std::ostream& os = std::cout);
 
 private:
     static constexpr size_t ID_COLUMN_WIDTH = 10;
@@ -29,44 +75,66 @@ private:
     static constexpr char VERTICAL_EDGE_CHAR = '|';
     static constexpr char SEPARATOR_CHAR = ' ';
 
-    using OrderMemberGetter = int64_t(*)(const Order&);
+    enum class Column { ID, VOLUME, PRICE };
     struct SectionInfo {
         std::string_view text;
         size_t width;
-        OrderMemberGetter getter;
+        Column column;
         bool format_number;
     };
     static constexpr std::array<SectionInfo, 3> TABLE_SECTIONS{
         SectionInfo{
             .text = " Id ",
             .width = ID_COLUMN_WIDTH,
-            .getter = [](const Order& order) -> int64_t { return order.id; },
+            .column = Column::ID,
             .format_number = false
         },
         SectionInfo{
             .text = " Volume ",
             .width = VOLUME_COLUMN_WIDTH,
-            .getter = [](const Order& order) -> int64_t { return order.visible_qty; },
+            .column = Column::VOLUME,
             .format_number = true
         },
         SectionInfo{
             .text = " Price ",
             .width = PRICE_COLUMN_WIDTH,
-            .getter = [](const Order& order) -> int64_t { return order.price; },
+            .column = Column::PRICE,
             .format_number = true
         }
     };
     // Order of columns: Id, Volume, Price | Price, Volume, Id
     static constexpr std::array<size_t, 6> SECTION_INDICES = {0, 1, 2, 2, 1, 0};
 
+    static_assert(MAX_ROW_SIZE == SECTION_INDICES.size() * (1 + MAX_CELL_SIZE) + 2);
+
     static void printHeader(std::ostream &os);
 
+    static void printHistogramRow(
+        std::string_view name, const LatencyHistogram& histogram, std::ostream& os);
+
     static void printTextSection(
         std::string_view text, size_t width, char fill_char, std::ostream& os,
         char prefix = '\0', char suffix = '\0', bool end_line = false);
 
-    static void printOrderSection(const Order* order, Order::Side side, std::ostream& os);
+    template <class Traits>
+    static void printOrderSection(
+        const std::optional<BasicOrder<Traits>>& order, OrderSide side, std::ostream& os);
 
-    [[nodiscard]] static std::string intToString(int64_t num, bool format);
+    template <class Traits>
+    [[nodiscard]] static std::string fieldText(const BasicOrder<Traits>& order, Column column);
+    // Groups the digits in threes when format is set
+    [[nodiscard]] static std::string groupDigits(std::string digits, bool format);
+
+    // Writes a separator and the value right-aligned to the width, or blanks if
+    // there's no order, as printOrderSection does. Returns the new end.
+    template <class Traits>
+    static char* renderOrderSection(
+        const std::optional<BasicOrder<Traits>>& order, OrderSide side, char* out) noexcept;
+    template <class T>
+    static char* renderCell(T value, size_t width, bool group, char* out) noexcept;
+    template <class T>
+    static char* renderNumber(T value, char* out) noexcept;
 
 };
+
+#include "printer.inl"
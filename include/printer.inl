@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <utility>
+
+template <class Traits>
+void Printer::print(const BasicTrade<Traits>& trade, std::ostream& os) {
+    os << trade.buy_id << ','
+        << trade.sell_id << ','
+        << trade.price << ','
+        << trade.qty << '\n';
+}
+
+template <class Traits>
+void Printer::print(const std::vector<BasicTrade<Traits>>& trades, std::ostream& os) {
+    for (const auto& trade: trades)
+        print(trade, os);
+}
+
+template <class Traits>
+void Printer::print(const BasicLevelDelta<Traits>& delta, std::ostream& os) {
+    os << (delta.side == OrderSide::BUY ? 'B' : 'S') << ','
+        << delta.price << ','
+        << delta.qty << ','
+        << delta.order_count << '\n';
+}
+
+template <class Traits>
+void Printer::print(const std::vector<BasicLevelDelta<Traits>>& deltas, std::ostream& os) {
+    for (const auto& delta: deltas)
+        print(delta, os);
+}
+
+template <class Config>
+void Printer::print(const BasicMatchingEngine<Config>& engine, std::ostream& os) {
+    printHeader(os);
+
+    os << std::right;
+
+    // +----------+-------------+-------+-------+-------------+----------+
+    for (size_t section_idx: SECTION_INDICES) {
+        const SectionInfo& section_info = TABLE_SECTIONS[section_idx];
+        printTextSection("", section_info.width, HORIZONTAL_EDGE_CHAR, os, CORNER_CHAR);
+    }
+    os << CORNER_CHAR << '\n';
+
+    auto buy_iter = engine.buyBegin();
+    auto sell_iter = engine.sellBegin();
+    while (buy_iter != engine.buyEnd() || sell_iter != engine.sellEnd()) {
+        printOrderSection(buy_iter != engine.buyEnd() ? std::optional{*buy_iter++} : std::nullopt,
+            Order::Side::BUY, os);
+        printOrderSection(sell_iter != engine.sellEnd() ? std::optional{*sell_iter++} : std::nullopt,
+            Order::Side::SELL, os);
+        os << VERTICAL_EDGE_CHAR << '\n';
+    }
+
+    // +-----------------------------------------------------------------+
+    printTextSection("", TOTAL_COLUMN_WIDTH, HORIZONTAL_EDGE_CHAR, os,
+        CORNER_CHAR, CORNER_CHAR, true);
+}
+
+template <class Config>
+size_t Printer::render(const BasicMatchingEngine<Config>& engine, std::vector<char>& buffer) {
+    const auto& header = bookHeaderText();
+    const auto& footer = bookFooterText();
+    if (buffer.size() < header.size() + footer.size() + MAX_ROW_SIZE)
+        buffer.resize(header.size() + footer.size() + MAX_ROW_SIZE);
+
+    auto* out = std::copy(std::begin(header), std::end(header), buffer.data());
+    auto buy_iter = engine.buyBegin();
+    auto sell_iter = engine.sellBegin();
+    while (buy_iter != engine.buyEnd() || sell_iter != engine.sellEnd()) {
+        // Keeps room for this row and the footer
+        auto size = static_cast<size_t>(out - buffer.data());
+        if (buffer.size() - size < MAX_ROW_SIZE + footer.size()) {
+            buffer.resize(buffer.size() * 2);
+            out = buffer.data() + size;
+        }
+
+        out = renderBookRow(
+            buy_iter != engine.buyEnd() ? std::optional{*buy_iter++} : std::nullopt,
+            sell_iter != engine.sellEnd() ? std::optional{*sell_iter++} : std::nullopt, out);
+    }
+    out = std::copy(std::begin(footer), std::end(footer), out);
+    return static_cast<size_t>(out - buffer.data());
+}
+
+template <class Config>
+void Printer::printFast(
+    const BasicMatchingEngine<Config>& engine, std::vector<char>& buffer, std::ostream& os) {
+    auto size = render(engine, buffer);
+    os.write(buffer.data(), static_cast<std::streamsize>(size));
+}
+
+template <class Traits>
+char* Printer::renderBookRow(const std::optional<BasicOrder<Traits>>& buy,
+    const std::optional<BasicOrder<Traits>>& sell, char* out) noexcept {
+    out = renderOrderSection(buy, OrderSide::BUY, out);
+    out = renderOrderSection(sell, OrderSide::SELL, out);
+    *out++ = VERTICAL_EDGE_CHAR;
+    *out++ = '\n';
+    return out;
+}
+
+template <class Traits>
+char* Printer::render(const BasicTrade<Traits>& trade, char* out) noexcept {
+    out = renderNumber(trade.buy_id, out);
+    *out++ = ',';
+    out = renderNumber(trade.sell_id, out);
+    *out++ = ',';
+    out = renderNumber(trade.price, out);
+    *out++ = ',';
+    out = renderNumber(trade.qty, out);
+    *out++ = '\n';
+    return out;
+}
+
+template <class Traits>
+char* Printer::render(const BasicLevelDelta<Traits>& delta, char* out) noexcept {
+    *out++ = (delta.side == OrderSide::BUY ? 'B' : 'S');
+    *out++ = ',';
+    out = renderNumber(delta.price, out);
+    *out++ = ',';
+    out = renderNumber(delta.qty, out);
+    *out++ = ',';
+    out = renderNumber(delta.order_count, out);
+    *out++ = '\n';
+    return out;
+}
+
+template <class Traits>
+char* Printer::renderOrderSection(
+    const std::optional<BasicOrder<Traits>>& order, OrderSide side, char* out) noexcept {
+    assert((order ? order->side : side) == side);
+
+    auto [start_idx, end_idx] = (side == OrderSide::BUY)
+        ? std::pair{size_t{0}, SECTION_INDICES.size() / 2}
+        : std::pair{SECTION_INDICES.size() / 2, SECTION_INDICES.size()};
+    for (size_t i = start_idx; i < end_idx; ++i) {
+        const SectionInfo& section_info = TABLE_SECTIONS[SECTION_INDICES[i]];
+        *out++ = VERTICAL_EDGE_CHAR;
+        if (!order) {
+            out = std::fill_n(out, section_info.width, SEPARATOR_CHAR);
+            continue;
+        }
+        switch (section_info.column) {
+        case Column::ID:
+            out = renderCell(order->id, section_info.width, section_info.format_number, out);
+            break;
+        case Column::VOLUME:
+            out = renderCell(order->visible_qty, section_info.width, section_info.format_number, out);
+            break;
+        case Column::PRICE:
+            out = renderCell(order->price, section_info.width, section_info.format_number, out);
+            break;
+        }
+    }
+    return out;
+}
+
+template <class T>
+char* Printer::renderCell(T value, size_t width, bool group, char* out) noexcept {
+    char digits[MAX_CELL_SIZE]{};
+    auto* digits_end = std::to_chars(std::begin(digits), std::end(digits), value).ptr;
+    auto* digits_begin = std::begin(digits) + (digits[0] == '-');
+    auto digit_count = static_cast<size_t>(digits_end - digits_begin);
+    auto separator_count = group ? (digit_count - 1) / 3 : 0;
+    auto text_size = static_cast<size_t>(digits_end - std::begin(digits)) + separator_count;
+
+    // Like setw, a field wider than its column pushes the rest of the row over
+    if (text_size < width)
+        out = std::fill_n(out, width - text_size, SEPARATOR_CHAR);
+    out = std::copy(std::begin(digits), digits_begin, out);
+    // The first group takes whatever the threes leave over
+    auto group_size = digit_count - 3 * separator_count;
+    for (auto* it = digits_begin; it != digits_end; ) {
+        out = std::copy_n(it, group_size, out);
+        it += group_size;
+        if (it != digits_end)
+            *out++ = ',';
+        group_size = 3;
+    }
+    return out;
+}
+
+template <class T>
+char* Printer::renderNumber(T value, char* out) noexcept {
+    return std::to_chars(out, out + MAX_CELL_SIZE, value).ptr;
+}
+
+template <class Traits>
+void Printer::printOrderSection(
+    const std::optional<BasicOrder<Traits>>& order, OrderSide side, std::ostream& os) {
+    assert((order ? order->side : side) == side);
+
+    auto [start_idx, end_idx] = (side == OrderSide::BUY)
+        ? std::pair{size_t{0}, SECTION_INDICES.size() / 2}
+        : std::pair{SECTION_INDICES.size() / 2, SECTION_INDICES.size()};
+    for (size_t i = start_idx; i < end_idx; ++i) {
+        const SectionInfo& section_info = TABLE_SECTIONS[SECTION_INDICES[i]];
+        auto field = order
+            ? groupDigits(fieldText(*order, section_info.column), section_info.format_number)
+            : "";
+        printTextSection(field, section_info.width, SEPARATOR_CHAR, os, VERTICAL_EDGE_CHAR);
+    }
+}
+
+template <class Traits>
+std::string Printer::fieldText(const BasicOrder<Traits>& order, Column column) {
+    switch (column) {
+    case Column::ID:
+        return std::to_string(order.id);
+    case Column::VOLUME:
+        return std::to_string(order.visible_qty);
+    case Column::PRICE:
+        return std::to_string(order.price);
+    }
+    return {};
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+
+#include "types.h"
+
+// A resting order as a ring level stores it, the fill-time fields of an order node
+// without the links. A zero visible quantity marks the slot of a cancelled order.
+template <class TraitsT>
+struct BasicOrderSlot {
+    using Handle = uint32_t;
+    using Traits = TraitsT;
+    using Order = BasicOrder<Traits>;
+
+    typename Traits::OrderId id;
+    typename Traits::Quantity visible_qty;
+    typename Traits::Quantity hidden_qty;
+    typename Traits::Quantity peak_qty;
+    // Same role as in BasicOrderNode
+    uint32_t trade_idx;
+    OrderType type;
+    OrderTimeInForce tif;
+    // The order index's copy of this slot's position, kept current when it moves
+    Handle* tracked_handle;
+
+    // The full order, given the side and price of the level it rests in
+    [[nodiscard]] Order order(OrderSide side, typename Traits::Price price) const noexcept;
+};
+
+static_assert(sizeof(BasicOrderSlot<DefaultOrderTraits>) == 32);
+static_assert(sizeof(BasicOrderSlot<WideOrderTraits>) == 48);
+
+namespace impl {
+    template <class Slot>
+    class RingPriceLevelIterator;
+}
+
+// A price level keeping its orders in one growable circular buffer, so consuming a
+// crowded level is a linear scan. Each order is addressed by its position, a counter
+// that only grows, and sits in the slot its low bits select. A cancel leaves a
+// tombstone that is skipped, and reclaimed once it reaches either end. A full
+// buffer doubles, re-placing the slots by the new mask, unless it's mostly
+// tombstones stuck between live orders, in which case the live orders are packed
+// together at the same size. Positions change when orders are packed or an iceberg
+// rotates to the back, which updates the tracked copy held by the index. The
+// allocator only fixes the order layout, the buffer is allocated directly.
+template <class Allocator>
+class RingPriceLevel {
+public:
+    using allocator_type = Allocator;
+    using Traits = typename Allocator::value_type::Traits;
+    using Node = BasicOrderSlot<Traits>;
+    using Order = BasicOrder<Traits>;
+    using Price = typename Traits::Price;
+    using Quantity = typename Traits::Quantity;
+    using Handle = typename Node::Handle;
+    using Iterator = impl::RingPriceLevelIterator<Node>;
+
+    static constexpr bool TRACKS_HANDLES = true;
+    static constexpr uint32_t INITIAL_CAPACITY = 8;
+
+    RingPriceLevel(Price price, Allocator& alloc);
+    ~RingPriceLevel() = default;
+
+    RingPriceLevel(const RingPriceLevel&) = delete;
+    RingPriceLevel(RingPriceLevel&&) = delete;
+    RingPriceLevel& operator=(RingPriceLevel&&) = delete;
+    RingPriceLevel& operator=(const RingPriceLevel&) = delete;
+
+    [[nodiscard]] Price price() const noexcept;
+    [[nodiscard]] bool empty() const noexcept;
+    // Running totals over every order in the level
+    [[nodiscard]] Quantity visibleQty() const noexcept;
+    [[nodiscard]] Quantity hiddenQty() const noexcept;
+    [[nodiscard]] uint32_t orderCount() const noexcept;
+    // Slots in the buffer, tombstones included
+    [[nodiscard]] uint32_t capacity() const noexcept;
+
+    [[nodiscard]] const Node& front() const noexcept;
+    [[nodiscard]] Node& front() noexcept;
+    [[nodiscard]] Node& node(Handle handle) noexcept;
+    [[nodiscard]] const Node& node(Handle handle) const noexcept;
+
+    Handle pushBack(const Order &order);
+    // Keeps handle pointing at the order last pushed as the order moves. The
+    // handle must stay put until the order leaves.
+    void trackHandle(Handle& handle) noexcept;
+    void popFront();
+    void erase(Handle handle);
+    // Moves the front order behind the last one and returns its new position
+    Handle rotateFront();
+    // Changes the quantities of a resting order, keeping the totals in step
+    void updateQty(Node& node, Quantity visible_qty, Quantity hidden_qty) noexcept;
+
+    [[nodiscard]] Iterator begin() const noexcept;
+    [[nodiscard]] Iterator end() const noexcept;
+
+private:
+    Price price_;
+    std::unique_ptr<Node[]> slots_;
+    uint32_t capacity_{0};
+    // Positions of the first live order and one past the last slot in use
+    Handle head_{0};
+    Handle tail_{0};
+    Quantity visible_qty_{0};
+    Quantity hidden_qty_{0};
+    uint32_t order_count_{0};
+
+    [[nodiscard]] Node& slot(Handle handle) const noexcept;
+    Handle pushSlot(const Node& node);
+    // Makes room for at least one more slot
+    void grow();
+    // Drop tombstones from either end, so head_ always names a live order
+    void trimFront() noexcept;
+    void trimBack() noexcept;
+
+};
+
+namespace impl {
+    template <class Slot>
+    class RingPriceLevelIterator {
+    public:
+        using value_type = Slot;
+        using reference = const value_type&;
+        using pointer = const value_type*;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+    public:
+        RingPriceLevelIterator() = default;
+        RingPriceLevelIterator(const RingPriceLevelIterator&) = default;
+        RingPriceLevelIterator(RingPriceLevelIterator&&) = default;
+        RingPriceLevelIterator& operator=(const RingPriceLevelIterator&) = default;
+        RingPriceLevelIterator& operator=(RingPriceLevelIterator&&) = default;
+
+        [[nodiscard]] reference operator*() const noexcept;
+        [[nodiscard]] pointer operator->() const noexcept;
+
+        RingPriceLevelIterator& operator++() noexcept;
+        RingPriceLevelIterator operator++(int) noexcept;
+
+        bool operator==(const RingPriceLevelIterator&) const = default;
+        bool operator!=(const RingPriceLevelIterator&) const = default;
+
+    private:
+        RingPriceLevelIterator(const Slot* slots, uint32_t mask, uint32_t position, uint32_t end);
+
+        template <class Allocator>
+        friend class ::RingPriceLevel;
+
+        const Slot* slots_{nullptr};
+        uint32_t mask_{0};
+        uint32_t position_{0};
+        uint32_t end_{0};
+
+    };
+}
+
+#include "ring_price_level.inl"
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <cassert>
+
+#include "util.h"
+
+template <class Traits>
+ALWAYS_INLINE auto BasicOrderSlot<Traits>::order(
+    OrderSide side, typename Traits::Price price) const noexcept -> Order {
+    return Order{
+        .side = side,
+        .type = type,
+        .tif = tif,
+        .id = id,
+        .price = price,
+        .visible_qty = visible_qty,
+        .peak_qty = peak_qty,
+        .hidden_qty = hidden_qty
+    };
+}
+
+template <class Allocator>
+ALWAYS_INLINE RingPriceLevel<Allocator>::RingPriceLevel(Price price, Allocator&)
+    : price_(price) {
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto RingPriceLevel<Allocator>::price() const noexcept -> Price {
+    return price_;
+}
+
+template <class Allocator>
+ALWAYS_INLINE bool RingPriceLevel<Allocator>::empty() const noexcept {
+    return order_count_ == 0;
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto RingPriceLevel<Allocator>::visibleQty() const noexcept -> Quantity {
+    return visible_qty_;
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto RingPriceLevel<Allocator>::hiddenQty() const noexcept -> Quantity {
+    return hidden_qty_;
+}
+
+template <class Allocator>
+ALWAYS_INLINE uint32_t RingPriceLevel<Allocator>::orderCount() const noexcept {
+    return order_count_;
+}
+
+template <class Allocator>
+ALWAYS_INLINE uint32_t RingPriceLevel<Allocator>::capacity() const noexcept {
+    return capacity_;
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto RingPriceLevel<Allocator>::front() const noexcept -> const Node& {
+    assert(!empty());
+    return slot(head_);
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto RingPriceLevel<Allocator>::front() noexcept -> Node& {
+    assert(!empty());
+    return slot(head_);
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto RingPriceLevel<Allocator>::node(Handle handle) noexcept -> Node& {
+    assert(handle - head_ < tail_ - head_ && slot(handle).visible_qty);
+    return slot(handle);
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto RingPriceLevel<Allocator>::node(Handle handle) const noexcept -> const Node& {
+    assert(handle - head_ < tail_ - head_ && slot(handle).visible_qty);
+    return slot(handle);
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto RingPriceLevel<Allocator>::pushBack(const Order& order) -> Handle {
+    // A resting order always shows some quantity, zero is the tombstone
+    assert(order.price == price_ && order.visible_qty > 0);
+    visible_qty_ += order.visible_qty;
+    hidden_qty_ += order.hidden_qty;
+    ++order_count_;
+    return pushSlot(Node{
+        .id = order.id,
+        .visible_qty = order.visible_qty,
+        .hidden_qty = order.hidden_qty,
+        .peak_qty = order.peak_qty,
+        .trade_idx = UINT32_MAX,
+        .type = order.type,
+        .tif = order.tif,
+        .tracked_handle = nullptr
+    });
+}
+
+template <class Allocator>
+ALWAYS_INLINE void RingPriceLevel<Allocator>::trackHandle(Handle& handle) noexcept {
+    assert(handle == tail_ - 1);
+    slot(handle).tracked_handle = &handle;
+}
+
+template <class Allocator>
+ALWAYS_INLINE void RingPriceLevel<Allocator>::popFront() {
+    assert(!empty());
+    erase(head_);
+}
+
+template <class Allocator>
+ALWAYS_INLINE void RingPriceLevel<Allocator>::erase(Handle handle) {
+    auto& erased = node(handle);
+    visible_qty_ -= erased.visible_qty;
+    hidden_qty_ -= erased.hidden_qty;
+    --order_count_;
+
+    erased.visible_qty = 0;
+    erased.hidden_qty = 0;
+    if (handle == head_)
+        trimFront();
+    else if (handle == tail_ - 1)
+        trimBack();
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto RingPriceLevel<Allocator>::rotateFront() -> Handle {
+    assert(!empty());
+    if (order_count_ == 1)
+        return head_;
+
+    auto rotated = front();
+    ++head_;
+    trimFront();
+    auto handle = pushSlot(rotated);
+    if (rotated.tracked_handle)
+        *rotated.tracked_handle = handle;
+    return handle;
+}
+
+template <class Allocator>
+ALWAYS_INLINE void RingPriceLevel<Allocator>::updateQty(
+    Node& node, Quantity visible_qty, Quantity hidden_qty) noexcept {
+    assert(visible_qty > 0);
+    visible_qty_ += visible_qty - node.visible_qty;
+    hidden_qty_ += hidden_qty - node.hidden_qty;
+    node.visible_qty = visible_qty;
+    node.hidden_qty = hidden_qty;
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto RingPriceLevel<Allocator>::begin() const noexcept -> Iterator {
+    return Iterator{slots_.get(), capacity_ - 1, head_, tail_};
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto RingPriceLevel<Allocator>::end() const noexcept -> Iterator {
+    return Iterator{slots_.get(), capacity_ - 1, tail_, tail_};
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto RingPriceLevel<Allocator>::slot(Handle handle) const noexcept -> Node& {
+    return slots_[handle & (capacity_ - 1)];
+}
+
+template <class Allocator>
+ALWAYS_INLINE auto RingPriceLevel<Allocator>::pushSlot(const Node& node) -> Handle {
+    if (tail_ - head_ == capacity_)
+        grow();
+    slot(tail_) = node;
+    return tail_++;
+}
+
+template <class Allocator>
+void RingPriceLevel<Allocator>::grow() {
+    // At most half live, packing frees half the buffer, which pays for the copy
+    // the same way doubling does. The new order is already counted.
+    auto capacity = order_count_ > capacity_ / 2
+        ? std::max(capacity_ * 2, INITIAL_CAPACITY) : capacity_;
+    auto slots = std::make_unique_for_overwrite<Node[]>(capacity);
+    auto packed = head_;
+    for (auto position = head_; position != tail_; ++position) {
+        const auto& node = slot(position);
+        if (!node.visible_qty)
+            continue;
+        slots[packed & (capacity - 1)] = node;
+        if (node.tracked_handle)
+            *node.tracked_handle = packed;
+        ++packed;
+    }
+    slots_ = std::move(slots);
+    capacity_ = capacity;
+    tail_ = packed;
+}
+
+template <class Allocator>
+ALWAYS_INLINE void RingPriceLevel<Allocator>::trimFront() noexcept {
+    while (head_ != tail_ && !slot(head_).visible_qty)
+        ++head_;
+}
+
+template <class Allocator>
+ALWAYS_INLINE void RingPriceLevel<Allocator>::trimBack() noexcept {
+    while (head_ != tail_ && !slot(tail_ - 1).visible_qty)
+        --tail_;
+}
+
+namespace impl {
+    template <class Slot>
+    ALWAYS_INLINE RingPriceLevelIterator<Slot>::RingPriceLevelIterator(
+        const Slot* slots, uint32_t mask, uint32_t position, uint32_t end)
+        : slots_(slots)
+        , mask_(mask)
+        , position_(position)
+        , end_(end) {
+    }
+
+    template <class Slot>
+    ALWAYS_INLINE auto RingPriceLevelIterator<Slot>::operator*() const noexcept -> reference {
+        assert(position_ != end_);
+        return slots_[position_ & mask_];
+    }
+
+    template <class Slot>
+    ALWAYS_INLINE auto RingPriceLevelIterator<Slot>::operator->() const noexcept -> pointer {
+        return &(operator*());
+    }
+
+    template <class Slot>
+    ALWAYS_INLINE auto RingPriceLevelIterator<Slot>::operator++() noexcept
+    -> RingPriceLevelIterator& {
+        assert(position_ != end_);
+        do {
+            ++position_;
+        } while (position_ != end_ && !slots_[position_ & mask_].visible_qty);
+        return *this;
+    }
+
+    template <class Slot>
+    ALWAYS_INLINE auto RingPriceLevelIterator<Slot>::operator++(int) noexcept
+    -> RingPriceLevelIterator {
+        RingPriceLevelIterator tmp(*this);
+        ++(*this);
+        return tmp;
+    }
+}
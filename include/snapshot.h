@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "types.h"
+
+// Binary book snapshot, all integers little-endian. A 56-byte header
+//   offset  size  field
+//        0     8  magic "LOBSNAP1"
+//        8     4  format version
+//       12     4  reserved, zero
+//       16     8  sequence number of the last message in the snapshot
+//       24     8  resting order count
+//       32     4  buy level count
+//       36     4  sell level count
+//       40     8  waiting stop order count
+//       48     4  last trade price
+//       52     1  whether anything has traded yet, so the price above is set
+//       53     3  reserved, zero
+// is followed by the buy levels from the best price down, then the sell levels
+// likewise. Each level is an 8-byte header and its orders in time priority:
+//   level                    order
+//   offset  size  field      offset  size  field
+//        0     4  price           0     1  type (0 = limit, 1 = iceberg)
+//        4     4  order count     1     1  time in force (0 = GTC, 3 = post-only)
+//                                 2     2  reserved, zero
+//                                 4     4  id
+//                                 8     4  visible quantity
+//                                12     4  peak quantity
+//                                16     4  hidden quantity
+// The stop orders come last, in the order they'd fire per side, buys first:
+//   offset  size  field
+//        0     1  side (0 = buy, 1 = sell)
+//        1     1  type (3 = stop, 4 = stop-limit)
+//        2     1  time in force (0 = GTC, 1 = IOC, 2 = FOK, 3 = post-only)
+//        3     1  reserved, zero
+//        4     4  id
+//        8     4  price
+//       12     4  stop price
+//       16     4  total quantity
+//       20     4  peak quantity
+namespace snapshot_io {
+    inline constexpr uint32_t VERSION = 2;
+    inline constexpr size_t HEADER_SIZE = 56;
+    inline constexpr size_t LEVEL_HEADER_SIZE = 8;
+    inline constexpr size_t ORDER_SIZE = 20;
+    inline constexpr size_t STOP_SIZE = 24;
+
+    struct Header {
+        uint64_t seq;
+        uint64_t order_count;
+        uint32_t buy_level_count;
+        uint32_t sell_level_count;
+        uint64_t stop_count;
+        Price last_trade_price;
+        bool has_traded;
+    };
+
+    void encodeHeader(const Header& header, char* out) noexcept;
+    // The decoders return false on an unknown enum value or a price out of the
+    // range of Price, and the header decoder if the magic or the version doesn't
+    // match
+    [[nodiscard]] bool decodeHeader(const char* in, Header& header) noexcept;
+
+    void encodeLevel(Price price, uint32_t order_count, char* out) noexcept;
+    [[nodiscard]] bool decodeLevelPrice(const char* in, Price& price) noexcept;
+    [[nodiscard]] uint32_t decodeLevelOrderCount(const char* in) noexcept;
+
+    void encodeOrder(const Order& order, char* out) noexcept;
+    [[nodiscard]] bool decodeOrder(
+        const char* in, Order::Side side, Price price, Order& order) noexcept;
+
+    void encodeStop(const Order& order, char* out) noexcept;
+    [[nodiscard]] bool decodeStop(const char* in, Order& order) noexcept;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+
+// Bounded lock-free ring for exactly one producer and one consumer thread.
+// Each side caches the other side's index so the shared cache line is only
+// read when the ring looks full or empty.
+template <class T, size_t Capacity>
+class SpscRing {
+    static_assert(std::has_single_bit(Capacity), "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    SpscRing() = default;
+    ~SpscRing() = default;
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing(SpscRing&&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+    SpscRing& operator=(SpscRing&&) = delete;
+
+    [[nodiscard]] static constexpr size_t capacity() noexcept;
+
+    // Producer side
+    bool tryPush(const T& value) noexcept;
+
+    // Consumer side
+    bool tryPop(T& value) noexcept;
+    [[nodiscard]] const T* front() noexcept;
+    void pop() noexcept;
+
+    [[nodiscard]] size_t size() const noexcept;
+    [[nodiscard]] bool empty() const noexcept;
+
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+    static constexpr size_t MASK = Capacity - 1;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+    size_t cached_tail_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+    size_t cached_head_{0};
+    alignas(CACHE_LINE_SIZE) std::array<T, Capacity> buffer_;
+
+};
+
+#include "spsc_ring.inl"
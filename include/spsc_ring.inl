@@ -0,0 +1,62 @@
+#include <cassert>
+
+#include "util.h"
+
+template <class T, size_t Capacity>
+ALWAYS_INLINE constexpr size_t SpscRing<T, Capacity>::capacity() noexcept {
+    return Capacity;
+}
+
+template <class T, size_t Capacity>
+ALWAYS_INLINE bool SpscRing<T, Capacity>::tryPush(const T& value) noexcept {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ == Capacity) {
+        cached_head_ = head_.load(std::memory_order_acquire);
+        if (tail - cached_head_ == Capacity)
+            return false;
+    }
+
+    buffer_[tail & MASK] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <class T, size_t Capacity>
+ALWAYS_INLINE bool SpscRing<T, Capacity>::tryPop(T& value) noexcept {
+    const auto* item = front();
+    if (!item)
+        return false;
+
+    value = *item;
+    pop();
+    return true;
+}
+
+template <class T, size_t Capacity>
+ALWAYS_INLINE const T* SpscRing<T, Capacity>::front() noexcept {
+    auto head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        if (head == cached_tail_)
+            return nullptr;
+    }
+    return &buffer_[head & MASK];
+}
+
+template <class T, size_t Capacity>
+ALWAYS_INLINE void SpscRing<T, Capacity>::pop() noexcept {
+    auto head = head_.load(std::memory_order_relaxed);
+    assert(head != tail_.load(std::memory_order_relaxed));
+    head_.store(head + 1, std::memory_order_release);
+}
+
+template <class T, size_t Capacity>
+ALWAYS_INLINE size_t SpscRing<T, Capacity>::size() const noexcept {
+    auto head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+}
+
+template <class T, size_t Capacity>
+ALWAYS_INLINE bool SpscRing<T, Capacity>::empty() const noexcept {
+    return size() == 0;
+}
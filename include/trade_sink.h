@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "spsc_ring.h"
+#include "types.h"
+
+// Receives the trades of one message from BasicMatchingEngine::processBatch. It
+// is only called for messages that traded, and the span is valid during the call.
+template <class Sink, class TradeT = Trade>
+concept TradeSink = requires(Sink& sink, uint64_t seq, std::span<const TradeT> trades) {
+    sink(seq, trades);
+};
+
+// Publishes sequenced trades into a preallocated ring for another thread to
+// consume. Waits for room when the ring is full, so no trade is ever dropped.
+template <size_t Capacity>
+class TradeRingSink {
+public:
+    using Ring = SpscRing<SequencedTrade, Capacity>;
+
+public:
+    explicit TradeRingSink(Ring& ring) noexcept;
+    ~TradeRingSink() = default;
+
+    TradeRingSink(const TradeRingSink&) = delete;
+    TradeRingSink(TradeRingSink&&) = delete;
+    TradeRingSink& operator=(const TradeRingSink&) = delete;
+    TradeRingSink& operator=(TradeRingSink&&) = delete;
+
+    void operator()(uint64_t seq, std::span<const Trade> trades) noexcept;
+
+private:
+    Ring& ring_;
+
+};
+
+#include "trade_sink.inl"
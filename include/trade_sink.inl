@@ -0,0 +1,16 @@
+#include <thread>
+
+#include "util.h"
+
+template <size_t Capacity>
+ALWAYS_INLINE TradeRingSink<Capacity>::TradeRingSink(Ring& ring) noexcept
+    : ring_(ring) {
+}
+
+template <size_t Capacity>
+ALWAYS_INLINE void TradeRingSink<Capacity>::operator()(
+    uint64_t seq, std::span<const Trade> trades) noexcept {
+    for (const auto& trade : trades)
+        while (!ring_.tryPush(SequencedTrade{.seq = seq, .trade = trade}))
+            std::this_thread::yield();
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "types.h"
+
+// One side of the trigger book. Stops are keyed by stop price in the order they
+// fire, buy stops from the lowest up and sell stops from the highest down, and
+// in arrival order within a price.
+template <class Traits, OrderSide SIDE>
+class TriggerSide {
+public:
+    using Order = BasicOrder<Traits>;
+    using Price = typename Traits::Price;
+    using OrderId = typename Traits::OrderId;
+    // Holds if a stop at the first price fires before one at the second
+    using Comparator = std::conditional_t<SIDE == OrderSide::BUY,
+        std::less<Price>, std::greater<Price>>;
+
+public:
+    TriggerSide() = default;
+    ~TriggerSide() = default;
+
+    TriggerSide(const TriggerSide&) = delete;
+    TriggerSide(TriggerSide&&) = delete;
+    TriggerSide& operator=(const TriggerSide&) = delete;
+    TriggerSide& operator=(TriggerSide&&) = delete;
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_t size() const noexcept;
+    // Whether a trade at the price sets off a stop at the stop price
+    [[nodiscard]] static bool fires(Price stop_price, Price trade_price) noexcept;
+
+    [[nodiscard]] bool contains(OrderId id) const;
+    void add(const Order& order);
+    bool cancel(OrderId id);
+    // Moves the stops a trade at the price sets off to out, first to fire first
+    void collect(Price trade_price, std::vector<Order>& out);
+
+    template <class Fn>
+    void forEach(Fn&& fn) const;
+
+private:
+    using Stops = std::multimap<Price, Order, Comparator>;
+
+    Stops stops_;
+    std::unordered_map<OrderId, typename Stops::iterator> index_;
+
+};
+
+// Stop orders waiting for the last trade price to reach them, kept apart from the
+// book. Collecting the stops a trade sets off only visits those that fire.
+template <class Traits>
+class TriggerBook {
+public:
+    using Order = BasicOrder<Traits>;
+    using Price = typename Traits::Price;
+    using OrderId = typename Traits::OrderId;
+
+public:
+    TriggerBook() = default;
+    ~TriggerBook() = default;
+
+    TriggerBook(const TriggerBook&) = delete;
+    TriggerBook(TriggerBook&&) = delete;
+    TriggerBook& operator=(const TriggerBook&) = delete;
+    TriggerBook& operator=(TriggerBook&&) = delete;
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_t size() const noexcept;
+    [[nodiscard]] static bool fires(const Order& order, Price trade_price) noexcept;
+
+    [[nodiscard]] bool contains(OrderId id) const;
+    // The id must not be waiting already
+    void add(const Order& order);
+    // Returns false if no stop with the id is waiting
+    bool cancel(OrderId id);
+    // Moves the stops a trade at the price sets off to the back of out, buys
+    // before sells, each in the order they fire
+    void collect(Price trade_price, std::vector<Order>& out);
+
+    // Calls fn with every waiting stop, buys then sells, each in firing order
+    template <class Fn>
+    void forEach(Fn&& fn) const;
+
+private:
+    TriggerSide<Traits, OrderSide::BUY> buy_side_;
+    TriggerSide<Traits, OrderSide::SELL> sell_side_;
+
+};
+
+#include "trigger_book.inl"
@@ -0,0 +1,107 @@
+#include <cassert>
+#include <iterator>
+
+#include "util.h"
+
+template <class Traits, OrderSide SIDE>
+ALWAYS_INLINE bool TriggerSide<Traits, SIDE>::empty() const noexcept {
+    return stops_.empty();
+}
+
+template <class Traits, OrderSide SIDE>
+ALWAYS_INLINE size_t TriggerSide<Traits, SIDE>::size() const noexcept {
+    return stops_.size();
+}
+
+template <class Traits, OrderSide SIDE>
+ALWAYS_INLINE bool TriggerSide<Traits, SIDE>::fires(Price stop_price, Price trade_price) noexcept {
+    return !Comparator{}(trade_price, stop_price);
+}
+
+template <class Traits, OrderSide SIDE>
+ALWAYS_INLINE bool TriggerSide<Traits, SIDE>::contains(OrderId id) const {
+    return index_.contains(id);
+}
+
+template <class Traits, OrderSide SIDE>
+ALWAYS_INLINE void TriggerSide<Traits, SIDE>::add(const Order& order) {
+    assert(order.side == SIDE && !index_.contains(order.id));
+    auto iter = stops_.emplace(order.stop_price, order);
+    index_.emplace(order.id, iter);
+}
+
+template <class Traits, OrderSide SIDE>
+ALWAYS_INLINE bool TriggerSide<Traits, SIDE>::cancel(OrderId id) {
+    auto iter = index_.find(id);
+    if (iter == std::end(index_))
+        return false;
+    stops_.erase(iter->second);
+    index_.erase(iter);
+    return true;
+}
+
+template <class Traits, OrderSide SIDE>
+ALWAYS_INLINE void TriggerSide<Traits, SIDE>::collect(Price trade_price, std::vector<Order>& out) {
+    auto iter = std::begin(stops_);
+    for (; iter != std::end(stops_) && fires(iter->first, trade_price); ++iter) {
+        out.push_back(iter->second);
+        index_.erase(iter->second.id);
+    }
+    stops_.erase(std::begin(stops_), iter);
+}
+
+template <class Traits, OrderSide SIDE>
+template <class Fn>
+ALWAYS_INLINE void TriggerSide<Traits, SIDE>::forEach(Fn&& fn) const {
+    for (const auto& [_, order] : stops_)
+        fn(order);
+}
+
+template <class Traits>
+ALWAYS_INLINE bool TriggerBook<Traits>::empty() const noexcept {
+    return buy_side_.empty() && sell_side_.empty();
+}
+
+template <class Traits>
+ALWAYS_INLINE size_t TriggerBook<Traits>::size() const noexcept {
+    return buy_side_.size() + sell_side_.size();
+}
+
+template <class Traits>
+ALWAYS_INLINE bool TriggerBook<Traits>::fires(const Order& order, Price trade_price) noexcept {
+    return (order.side == OrderSide::BUY)
+        ? TriggerSide<Traits, OrderSide::BUY>::fires(order.stop_price, trade_price)
+        : TriggerSide<Traits, OrderSide::SELL>::fires(order.stop_price, trade_price);
+}
+
+template <class Traits>
+ALWAYS_INLINE bool TriggerBook<Traits>::contains(OrderId id) const {
+    return buy_side_.contains(id) || sell_side_.contains(id);
+}
+
+template <class Traits>
+ALWAYS_INLINE void TriggerBook<Traits>::add(const Order& order) {
+    assert(order.type == OrderType::STOP || order.type == OrderType::STOP_LIMIT);
+    if (order.side == OrderSide::BUY)
+        buy_side_.add(order);
+    else
+        sell_side_.add(order);
+}
+
+template <class Traits>
+ALWAYS_INLINE bool TriggerBook<Traits>::cancel(OrderId id) {
+    return buy_side_.cancel(id) || sell_side_.cancel(id);
+}
+
+template <class Traits>
+ALWAYS_INLINE void TriggerBook<Traits>::collect(Price trade_price, std::vector<Order>& out) {
+    buy_side_.collect(trade_price, out);
+    sell_side_.collect(trade_price, out);
+}
+
+template <class Traits>
+template <class Fn>
+ALWAYS_INLINE void TriggerBook<Traits>::forEach(Fn&& fn) const {
+    buy_side_.forEach(fn);
+    sell_side_.forEach(fn);
+}
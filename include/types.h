@@ -1,25 +1,100 @@
 #pragma once
 
-using OrderId = int;
-using Quantity = int;
-using Price = short;
+#include <cstdint>
 
-struct Order {
-    enum class Side { BUY, SELL };
-    enum class Type { LIMIT, ICEBERG };
+using SymbolId = uint32_t;
+
+enum class OrderSide : uint8_t { BUY, SELL };
+// A market order takes whatever price the contra side offers and never rests.
+// Stop orders wait until a trade reaches their stop price and then enter the
+// book, a STOP as a market order and a STOP_LIMIT as a limit or iceberg order.
+enum class OrderType : uint8_t { LIMIT, ICEBERG, MARKET, STOP, STOP_LIMIT };
+// What happens to the part of an order that doesn't trade on arrival: GTC rests
+// it, IOC drops it. FOK trades only if the whole quantity can fill at once and
+// POST_ONLY only rests, so both reject the order outright otherwise.
+enum class OrderTimeInForce : uint8_t { GTC, IOC, FOK, POST_ONLY };
+
+// Integer widths of the order fields. The engine and the book are templated on
+// these through the book config, so each deployment picks its own layout.
+template <class PriceT, class QuantityT, class OrderIdT>
+struct OrderTraits {
+    using Price = PriceT;
+    using Quantity = QuantityT;
+    using OrderId = OrderIdT;
+};
+
+// 16-bit ticks and 32-bit quantities and ids, the densest layout
+using NarrowOrderTraits = OrderTraits<short, int, int>;
+// 32-bit ticks for high-priced instruments, 64-bit quantities and exchange ids.
+// Prices stay narrower than 64 bits so the book can keep a wider sentinel price.
+using WideOrderTraits = OrderTraits<int32_t, int64_t, uint64_t>;
+
+using DefaultOrderTraits = NarrowOrderTraits;
+
+template <class Traits>
+struct BasicOrder {
+    using Side = OrderSide;
+    using Type = OrderType;
+    using TimeInForce = OrderTimeInForce;
 
     Side side;
     Type type;
-    OrderId id;
-    Price price;
-    Quantity visible_qty;
-    Quantity peak_qty;
-    Quantity hidden_qty;
+    TimeInForce tif{TimeInForce::GTC};
+    typename Traits::OrderId id;
+    typename Traits::Price price;
+    // Only read for stop orders. A buy stop fires once a trade prints at or above
+    // it, a sell stop at or below it.
+    typename Traits::Price stop_price{0};
+    typename Traits::Quantity visible_qty;
+    typename Traits::Quantity peak_qty;
+    typename Traits::Quantity hidden_qty;
+};
+
+template <class Traits>
+struct BasicTrade {
+    typename Traits::OrderId buy_id;
+    typename Traits::OrderId sell_id;
+    typename Traits::Price price;
+    typename Traits::Quantity qty;
 };
 
-struct Trade {
-    OrderId buy_id;
-    OrderId sell_id;
-    Price price;
-    Quantity qty;
+// A trade tagged with the sequence number of the message that produced it
+template <class Traits>
+struct BasicSequencedTrade {
+    uint64_t seq;
+    BasicTrade<Traits> trade;
 };
+
+// Aggregated quantities resting at one price level
+template <class Traits>
+struct BasicLevelDepth {
+    typename Traits::Price price;
+    typename Traits::Quantity visible_qty;
+    typename Traits::Quantity hidden_qty;
+    uint32_t order_count;
+};
+
+// New state of one price level after a message touched it
+template <class Traits>
+struct BasicLevelDelta {
+    OrderSide side;
+    typename Traits::Price price;
+    // Total visible quantity resting at the price, zero once the level is gone
+    typename Traits::Quantity qty;
+    uint32_t order_count;
+};
+
+using OrderId = DefaultOrderTraits::OrderId;
+using Quantity = DefaultOrderTraits::Quantity;
+using Price = DefaultOrderTraits::Price;
+
+using Order = BasicOrder<DefaultOrderTraits>;
+using Trade = BasicTrade<DefaultOrderTraits>;
+using SequencedTrade = BasicSequencedTrade<DefaultOrderTraits>;
+using LevelDepth = BasicLevelDepth<DefaultOrderTraits>;
+using LevelDelta = BasicLevelDelta<DefaultOrderTraits>;
+
+static_assert(sizeof(Order) == 24);
+static_assert(sizeof(Trade) == 16);
+static_assert(sizeof(BasicOrder<WideOrderTraits>) == 48);
+static_assert(sizeof(BasicTrade<WideOrderTraits>) == 32);
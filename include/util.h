@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <type_traits>
+
 #ifndef ALWAYS_INLINE
   #if defined(__clang__) || defined(__GNUC__)
     #define ALWAYS_INLINE inline __attribute__((always_inline))
@@ -9,3 +12,27 @@
     #define ALWAYS_INLINE inline
   #endif
 #endif
+
+// Hints the cache to load the line holding addr. A no-op where unsupported.
+ALWAYS_INLINE void prefetch([[maybe_unused]] const void* addr) noexcept {
+#if defined(__clang__) || defined(__GNUC__)
+    __builtin_prefetch(addr);
+#endif
+}
+
+// Byte-order independent encoding of integers in little-endian files
+template <class T>
+ALWAYS_INLINE T loadLittleEndian(const char* src) noexcept {
+    using Unsigned = std::make_unsigned_t<T>;
+    Unsigned value = 0;
+    for (size_t idx = 0; idx < sizeof(T); ++idx)
+        value |= static_cast<Unsigned>(static_cast<unsigned char>(src[idx])) << (8 * idx);
+    return static_cast<T>(value);
+}
+
+template <class T>
+ALWAYS_INLINE void storeLittleEndian(T value, char* dst) noexcept {
+    auto bits = static_cast<std::make_unsigned_t<T>>(value);
+    for (size_t idx = 0; idx < sizeof(T); ++idx)
+        dst[idx] = static_cast<char>((bits >> (8 * idx)) & 0xFF);
+}
@@ -0,0 +1,60 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../include/order_flow.h"
+
+// Usage: generate [--binary] [--seed N] [--count N] [--range TICKS] [--aggressive RATIO]
+//                 [--iceberg RATIO] [--sweep-factor X] [--cancel RATIO] [--amend RATIO]
+//                 [output_file]
+//
+// Writes a replay file of synthetic orders, CSV by default, to standard output or
+// the given file. --cancel and --amend mix in cancels and amends of recent orders
+// at those shares of the messages, none by default. The same options and seed
+// always produce the same file.
+int main(int argc, char* argv[]) {
+    auto format = OrderFormat::CSV;
+    OrderFlowParams params;
+    unsigned long count = 100000;
+    std::FILE* output = stdout;
+    for (int idx = 1; idx < argc; ++idx) {
+        bool has_value = idx + 1 < argc;
+        if (std::strcmp(argv[idx], "--binary") == 0) {
+            format = OrderFormat::BINARY;
+        } else if (std::strcmp(argv[idx], "--seed") == 0 && has_value) {
+            params.seed = std::strtoull(argv[++idx], nullptr, 10);
+        } else if (std::strcmp(argv[idx], "--count") == 0 && has_value) {
+            count = std::strtoul(argv[++idx], nullptr, 10);
+        } else if (std::strcmp(argv[idx], "--range") == 0 && has_value) {
+            params.price_range = static_cast<Price>(std::atoi(argv[++idx]));
+        } else if (std::strcmp(argv[idx], "--aggressive") == 0 && has_value) {
+            params.aggressive_ratio = std::atof(argv[++idx]);
+        } else if (std::strcmp(argv[idx], "--iceberg") == 0 && has_value) {
+            params.iceberg_ratio = std::atof(argv[++idx]);
+        } else if (std::strcmp(argv[idx], "--sweep-factor") == 0 && has_value) {
+            params.sweep_size_factor = std::atof(argv[++idx]);
+        } else if (std::strcmp(argv[idx], "--cancel") == 0 && has_value) {
+            params.cancel_ratio = std::atof(argv[++idx]);
+        } else if (std::strcmp(argv[idx], "--amend") == 0 && has_value) {
+            params.amend_ratio = std::atof(argv[++idx]);
+        } else if (!(output = std::fopen(argv[idx], "wb"))) {
+            std::perror(argv[idx]);
+            return 1;
+        }
+    }
+
+    if (params.cancel_ratio < 0.0 || params.amend_ratio < 0.0
+        || params.cancel_ratio + params.amend_ratio > 1.0) {
+        std::fputs("Cancel and amend ratios must add up to at most 1\n", stderr);
+        return 1;
+    }
+
+    OrderFlowGenerator generator(params);
+    {
+        OrderWriter writer(output, format);
+        generator.write(writer, count);
+    }
+
+    if (output != stdout)
+        std::fclose(output);
+}
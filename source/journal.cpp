@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+
+#if !defined(_WIN32)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include "../include/journal.h"
+#include "../include/util.h"
+
+namespace {
+    constexpr char MAGIC[8] = {'L', 'O', 'B', 'J', 'R', 'N', 'L', '1'};
+
+    void writeHeader(char* header) noexcept {
+        std::memset(header, 0, journal_io::HEADER_SIZE);
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        storeLittleEndian(static_cast<uint32_t>(journal_io::RECORD_SIZE), header + 8);
+    }
+
+    bool validHeader(const char* header) noexcept {
+        return std::memcmp(header, MAGIC, sizeof(MAGIC)) == 0
+            && loadLittleEndian<uint32_t>(header + 8) == journal_io::RECORD_SIZE;
+    }
+
+    size_t fileSize(size_t capacity) noexcept {
+        return journal_io::HEADER_SIZE + capacity * journal_io::RECORD_SIZE;
+    }
+
+    // Records are written front to back, so the first empty slot is found by bisection
+    size_t countRecords(const char* data, size_t capacity) noexcept {
+        size_t lo = 0;
+        size_t hi = capacity;
+        while (lo < hi) {
+            auto mid = lo + (hi - lo) / 2;
+            if (journal_io::isRecord(data + fileSize(mid)))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+}
+
+void journal_io::encode(const JournalRecord& record, char* out) noexcept {
+    storeLittleEndian(record.seq, out);
+    out[9] = (record.side == Order::Side::SELL) ? 1 : 0;
+    out[10] = static_cast<char>(record.type);
+    out[11] = static_cast<char>(record.tif);
+    storeLittleEndian(static_cast<int32_t>(record.price), out + 12);
+    storeLittleEndian(static_cast<int32_t>(record.id), out + 16);
+    storeLittleEndian(static_cast<int32_t>(record.sell_id), out + 20);
+    storeLittleEndian(static_cast<int32_t>(record.qty), out + 24);
+    storeLittleEndian(static_cast<int32_t>(record.peak_qty), out + 28);
+    // The kind goes in last, so a record torn by a crash reads as the end of the journal
+    std::atomic_signal_fence(std::memory_order_release);
+    out[8] = static_cast<char>(record.kind);
+}
+
+JournalRecord journal_io::decode(const char* in) noexcept {
+    return JournalRecord{
+        .seq = loadLittleEndian<uint64_t>(in),
+        .kind = static_cast<JournalRecord::Kind>(in[8]),
+        .side = in[9] ? Order::Side::SELL : Order::Side::BUY,
+        .type = static_cast<Order::Type>(in[10]),
+        .tif = static_cast<Order::TimeInForce>(in[11]),
+        .price = static_cast<Price>(loadLittleEndian<int32_t>(in + 12)),
+        .id = static_cast<OrderId>(loadLittleEndian<int32_t>(in + 16)),
+        .sell_id = static_cast<OrderId>(loadLittleEndian<int32_t>(in + 20)),
+        .qty = static_cast<Quantity>(loadLittleEndian<int32_t>(in + 24)),
+        .peak_qty = static_cast<Quantity>(loadLittleEndian<int32_t>(in + 28))
+    };
+}
+
+bool journal_io::isRecord(const char* in) noexcept {
+    return in[8] != 0;
+}
+
+#if !defined(_WIN32)
+
+JournalWriter::~JournalWriter() {
+    close();
+}
+
+bool JournalWriter::open(const std::string& path, size_t capacity, size_t sync_interval) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0)
+        return false;
+
+    struct stat info;
+    if (::fstat(fd_, &info) != 0) {
+        close();
+        return false;
+    }
+
+    sync_interval_ = sync_interval;
+    auto file_size = static_cast<size_t>(info.st_size);
+    if (file_size == 0) {
+        if (!map(std::max<size_t>(capacity, 1))) {
+            close();
+            return false;
+        }
+        writeHeader(data_);
+        size_ = 0;
+    } else {
+        if (file_size < journal_io::HEADER_SIZE
+            || (file_size - journal_io::HEADER_SIZE) % journal_io::RECORD_SIZE != 0
+            || !map((file_size - journal_io::HEADER_SIZE) / journal_io::RECORD_SIZE)
+            || !validHeader(data_)) {
+            close();
+            return false;
+        }
+        size_ = countRecords(data_, capacity_);
+    }
+    synced_size_ = size_;
+    return true;
+}
+
+void JournalWriter::close() {
+    if (data_) {
+        sync();
+        unmap();
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    size_ = 0;
+    synced_size_ = 0;
+    failed_ = false;
+}
+
+bool JournalWriter::append(const JournalRecord& record) {
+    assert(isOpen() && record.kind != JournalRecord::Kind{});
+    if (failed_)
+        return false;
+    if (size_ == capacity_) {
+        sync();
+        if (!map(capacity_ * 2)) {
+            failed_ = true;
+            return false;
+        }
+    }
+
+    journal_io::encode(record, data_ + fileSize(size_));
+    ++size_;
+    if (sync_interval_ && size_ - synced_size_ >= sync_interval_)
+        sync();
+    return true;
+}
+
+void JournalWriter::sync() {
+    if (!data_ || synced_size_ == size_)
+        return;
+
+    // msync wants a page-aligned start
+    auto page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    auto begin = fileSize(synced_size_) / page_size * page_size;
+    auto end = fileSize(size_);
+    ::msync(data_ + begin, end - begin, MS_SYNC);
+    synced_size_ = size_;
+}
+
+bool JournalWriter::isOpen() const noexcept {
+    return data_ != nullptr;
+}
+
+bool JournalWriter::failed() const noexcept {
+    return failed_;
+}
+
+size_t JournalWriter::size() const noexcept {
+    return size_;
+}
+
+bool JournalWriter::map(size_t capacity) {
+    assert(fd_ >= 0);
+    auto size = fileSize(capacity);
+    if (::ftruncate(fd_, static_cast<off_t>(size)) != 0)
+        return false;
+#if defined(__linux__)
+    // Reserving the blocks and prefaulting the mapping keeps both off the append path
+    ::posix_fallocate(fd_, 0, static_cast<off_t>(size));
+    constexpr int MAP_FLAGS = MAP_SHARED | MAP_POPULATE;
+#else
+    constexpr int MAP_FLAGS = MAP_SHARED;
+#endif
+
+    auto* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_FLAGS, fd_, 0);
+    if (data == MAP_FAILED)
+        return false;
+    unmap();
+    data_ = static_cast<char*>(data);
+    capacity_ = capacity;
+    return true;
+}
+
+void JournalWriter::unmap() {
+    if (data_)
+        ::munmap(data_, fileSize(capacity_));
+    data_ = nullptr;
+    capacity_ = 0;
+}
+
+JournalReader::~JournalReader() {
+    close();
+}
+
+bool JournalReader::open(const std::string& path) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0)
+        return false;
+
+    struct stat info;
+    if (::fstat(fd_, &info) != 0) {
+        close();
+        return false;
+    }
+    auto file_size = static_cast<size_t>(info.st_size);
+    if (file_size < journal_io::HEADER_SIZE) {
+        close();
+        return false;
+    }
+
+    auto* data = ::mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED) {
+        close();
+        return false;
+    }
+    data_ = static_cast<const char*>(data);
+    mapped_size_ = file_size;
+    if (!validHeader(data_)) {
+        close();
+        return false;
+    }
+    // Replay reads front to back exactly once
+    ::madvise(data, file_size, MADV_SEQUENTIAL);
+    capacity_ = (file_size - journal_io::HEADER_SIZE) / journal_io::RECORD_SIZE;
+    position_ = 0;
+    return true;
+}
+
+void JournalReader::close() {
+    if (data_)
+        ::munmap(const_cast<char*>(data_), mapped_size_);
+    if (fd_ >= 0)
+        ::close(fd_);
+    fd_ = -1;
+    data_ = nullptr;
+    mapped_size_ = 0;
+    capacity_ = 0;
+    position_ = 0;
+}
+
+bool JournalReader::next(JournalRecord& record) {
+    if (position_ == capacity_)
+        return false;
+
+    const auto* in = data_ + fileSize(position_);
+    if (!journal_io::isRecord(in))
+        return false;
+    record = journal_io::decode(in);
+    ++position_;
+    return true;
+}
+
+#else
+
+JournalWriter::~JournalWriter() = default;
+bool JournalWriter::open(const std::string&, size_t, size_t) { return false; }
+void JournalWriter::close() {}
+bool JournalWriter::append(const JournalRecord&) { return false; }
+void JournalWriter::sync() {}
+bool JournalWriter::isOpen() const noexcept { return false; }
+bool JournalWriter::failed() const noexcept { return false; }
+size_t JournalWriter::size() const noexcept { return 0; }
+bool JournalWriter::map(size_t) { return false; }
+void JournalWriter::unmap() {}
+
+JournalReader::~JournalReader() = default;
+bool JournalReader::open(const std::string&) { return false; }
+void JournalReader::close() {}
+bool JournalReader::next(JournalRecord&) { return false; }
+
+#endif
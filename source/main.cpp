@@ -1,63 +1,188 @@
-#include <optional>
-#include <algorithm>
-#include <vector>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
-#include <sstream>
 
+#if defined(_WIN32)
+  #include <fcntl.h>
+  #include <io.h>
+#endif
+
+#include "../include/journaled_engine.h"
+#include "../include/order_io.h"
+#include "../include/output_thread.h"
 #include "../include/printer.h"
 
-std::vector<std::string> delimString(const std::string& str, char delimiter) {
-    std::vector<std::string> tokens;
-    std::istringstream iss(str);
-    std::string token;
-    while (std::getline(iss, token, delimiter))
-        tokens.push_back(token);
-    return tokens;
-}
+namespace {
+    std::atomic<bool> snapshot_requested{false};
+    std::atomic<bool> stats_requested{false};
+
+    void requestSnapshot(int) {
+        snapshot_requested.store(true, std::memory_order_relaxed);
+    }
 
-std::optional<Order> getOrder() {
-    std::string input;
-    std::getline(std::cin, input);
-    input.erase(std::remove_if(std::begin(input), std::end(input), ::isspace), std::end(input));
-
-    if (!input.size() || (input[0] != 'B' && input[0] != 'S'))
-        return std::nullopt;
-
-    auto tokens = delimString(input, ',');
-    Order::Side side = (tokens[0] == "B") ? Order::Side::BUY : Order::Side::SELL;
-    Order::Type type = Order::Type::LIMIT;
-    OrderId id = std::stoi(tokens[1]);
-    Price price = static_cast<Price>(std::stoi(tokens[2]));
-    Quantity qty = std::stoi(tokens[3]),
-        visible_qty = qty,
-        peak_qty = qty,
-        hidden_qty = 0;
-
-    if (tokens.size() > 4) {
-        type = Order::Type::ICEBERG;
-        peak_qty = std::stoi(tokens[4]);
-        hidden_qty = visible_qty;
-        visible_qty = std::min(peak_qty, hidden_qty);
-        hidden_qty -= visible_qty;
+    void requestStats(int) {
+        stats_requested.store(true, std::memory_order_relaxed);
     }
 
-    return Order{
-        .side = side,
-        .type = type,
-        .id = id,
-        .price = price,
-        .visible_qty = visible_qty,
-        .peak_qty = peak_qty,
-        .hidden_qty = hidden_qty
+    struct Options {
+        bool print_deltas{false};
+        BackpressurePolicy output_policy{BackpressurePolicy::BLOCK};
+        unsigned long snapshot_interval{0};
+        const char* journal_path{nullptr};
+        const char* snapshot_path{nullptr};
     };
+
+    template <class Engine>
+    bool loadSnapshot(Engine& engine, const char* path) {
+        std::FILE* file = std::fopen(path, "rb");
+        if (!file)
+            return true;
+        bool loaded = engine.loadSnapshot(file);
+        std::fclose(file);
+        if (!loaded)
+            std::cerr << "Invalid snapshot " << path << '\n';
+        return loaded;
+    }
+
+    // Goes through a temporary file so a crash never leaves a partial snapshot behind
+    template <class Engine>
+    bool saveSnapshot(const Engine& engine, const char* path) {
+        std::string tmp_path = std::string(path) + ".tmp";
+        std::FILE* file = std::fopen(tmp_path.c_str(), "wb");
+        if (!file) {
+            std::perror(tmp_path.c_str());
+            return false;
+        }
+        bool saved = engine.saveSnapshot(file);
+        saved = (std::fclose(file) == 0) && saved;
+        if (!saved || std::rename(tmp_path.c_str(), path) != 0) {
+            std::perror(path);
+            return false;
+        }
+        return true;
+    }
+
+    template <class Engine>
+    bool run(OrderReader& reader, const Options& options) {
+        Engine engine;
+        if (options.snapshot_path && !loadSnapshot(engine, options.snapshot_path))
+            return false;
+
+        JournalWriter writer;
+        if (options.journal_path) {
+            JournalReader journal;
+            if (journal.open(options.journal_path)) {
+                auto result = recover(journal, engine);
+                std::cerr << "Recovered " << result.messages << " messages from "
+                    << options.journal_path << (result.consistent ? "\n" : ", trades differ\n");
+            }
+            if (!writer.open(options.journal_path)) {
+                std::perror(options.journal_path);
+                return false;
+            }
+        }
+        JournaledEngine journaled(engine, writer);
+
+        engine.trackDeltas(options.print_deltas);
+        {
+            BasicOutputThread<typename Engine::Traits> output(std::cout, options.output_policy);
+            Order order;
+            for (unsigned long message_count = 1; reader.next(order); ++message_count) {
+                const auto& trades = writer.isOpen()
+                    ? journaled.process(order) : engine.process(order);
+                // Going on unjournaled would lose these messages on recovery
+                if (writer.failed()) {
+                    std::cerr << "Writing " << options.journal_path << " failed at message "
+                        << message_count << ", stopping\n";
+                    return false;
+                }
+                output.publishTrades(trades);
+                if constexpr (Engine::Stats::ENABLED) {
+                    if (stats_requested.exchange(false, std::memory_order_relaxed))
+                        Printer::print(engine.stats(), std::cerr);
+                }
+                if (!options.print_deltas) {
+                    output.publishBook(engine);
+                    continue;
+                }
+
+                output.publishDeltas(engine.deltas());
+                if ((options.snapshot_interval && message_count % options.snapshot_interval == 0)
+                    || snapshot_requested.exchange(false, std::memory_order_relaxed))
+                    output.publishBook(engine);
+            }
+            if (output.droppedBooks())
+                std::cerr << "Dropped " << output.droppedBooks() << " book dumps\n";
+            if (output.oversizedBooks())
+                std::cerr << "Skipped " << output.oversizedBooks()
+                    << " book dumps too large for the output queue\n";
+        }
+
+        if constexpr (Engine::Stats::ENABLED)
+            Printer::print(engine.stats(), std::cerr);
+        return !options.snapshot_path || saveSnapshot(engine, options.snapshot_path);
+    }
 }
 
-int main() {
-    MatchingEngine engine;
-    for (auto order = getOrder(); ; order = getOrder())
-        if (order) {
-            for (const auto &match : engine.process(*order))
-                Printer::print(match);
-            Printer::print(engine);
+// Usage: main [--binary] [--deltas] [--snapshot-every N] [--drop-books] [--latency]
+//             [--journal PATH] [--snapshot PATH] [input_file]
+//
+// Reads CSV orders from standard input by default and prints the trades and the
+// full book after every order. With --deltas only trades and level deltas are
+// printed, plus a full book every N messages or when SIGUSR1 is received. Output
+// is written by a separate thread. When it falls behind, matching waits for it,
+// or with --drop-books skips book dumps that don't fit in its queue.
+// --latency runs an instrumented engine and dumps its latency histograms to
+// standard error on exit and whenever SIGUSR2 is received. --journal rebuilds the
+// book from the journal at PATH if there is one, then journals every new order.
+// --snapshot loads the book from the snapshot at PATH if there is one, and saves
+// it there on exit. Combined with --journal only the journal tail is replayed.
+int main(int argc, char* argv[]) {
+    auto format = OrderFormat::CSV;
+    Options options;
+    bool measure_latency = false;
+    std::FILE* input = stdin;
+    for (int idx = 1; idx < argc; ++idx) {
+        if (std::strcmp(argv[idx], "--binary") == 0) {
+            format = OrderFormat::BINARY;
+        } else if (std::strcmp(argv[idx], "--deltas") == 0) {
+            options.print_deltas = true;
+        } else if (std::strcmp(argv[idx], "--snapshot-every") == 0 && idx + 1 < argc) {
+            options.snapshot_interval = std::strtoul(argv[++idx], nullptr, 10);
+        } else if (std::strcmp(argv[idx], "--drop-books") == 0) {
+            options.output_policy = BackpressurePolicy::DROP_BOOKS;
+        } else if (std::strcmp(argv[idx], "--latency") == 0) {
+            measure_latency = true;
+        } else if (std::strcmp(argv[idx], "--journal") == 0 && idx + 1 < argc) {
+            options.journal_path = argv[++idx];
+        } else if (std::strcmp(argv[idx], "--snapshot") == 0 && idx + 1 < argc) {
+            options.snapshot_path = argv[++idx];
+        } else if (!(input = std::fopen(argv[idx], "rb"))) {
+            std::perror(argv[idx]);
+            return 1;
         }
+    }
+
+#if defined(_WIN32)
+    if (input == stdin && format == OrderFormat::BINARY)
+        ::_setmode(::_fileno(stdin), _O_BINARY);
+#endif
+#if defined(SIGUSR1)
+    std::signal(SIGUSR1, requestSnapshot);
+#endif
+#if defined(SIGUSR2)
+    std::signal(SIGUSR2, requestStats);
+#endif
+
+    OrderReader reader(input, format);
+    bool ok = measure_latency
+        ? run<InstrumentedMatchingEngine>(reader, options)
+        : run<MatchingEngine>(reader, options);
+
+    if (input != stdin)
+        std::fclose(input);
+    return ok ? 0 : 1;
 }
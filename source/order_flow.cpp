@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "../include/order_flow.h"
+
+namespace {
+    constexpr Quantity MAX_QTY = 1000000;
+}
+
+OrderFlowGenerator::OrderFlowGenerator(const OrderFlowParams& params)
+    : params_(params)
+    , gen_(params.seed)
+    , walk_dist_(params.walk_probability)
+    , aggressive_dist_(params.aggressive_ratio)
+    , iceberg_dist_(params.iceberg_ratio)
+    // Mean offset of a quarter of the range keeps most liquidity near the mid
+    , offset_dist_(1.0 / (1.0 + params.price_range / 4.0))
+    , qty_dist_(std::log(static_cast<double>(params.median_qty)), params.qty_sigma)
+    , mid_(params.start_price) {
+    assert(params.price_range >= 0 && params.sweep_depth >= 0 && params.median_qty > 0);
+    assert(params.cancel_ratio >= 0.0 && params.amend_ratio >= 0.0
+        && params.cancel_ratio + params.amend_ratio <= 1.0);
+    [[maybe_unused]] int margin = params.price_range + params.sweep_depth + 1;
+    assert(params.start_price >= std::numeric_limits<Price>::min() + margin
+        && params.start_price <= std::numeric_limits<Price>::max() - margin);
+}
+
+Order OrderFlowGenerator::next() {
+    walk();
+
+    bool is_buy = gen_() & 1;
+    bool is_aggressive = aggressive_dist_(gen_);
+    Price offset;
+    Quantity qty;
+    if (is_aggressive) {
+        offset = static_cast<Price>(gen_() % (params_.sweep_depth + 1));
+        qty = drawQty(params_.sweep_size_factor);
+    } else {
+        offset = static_cast<Price>(std::min<int>(offset_dist_(gen_), params_.price_range));
+        qty = drawQty(1.0);
+    }
+    // Bids rest at or below the mid and asks above it, an aggressive order mirrors that
+    auto price = static_cast<Price>((is_buy != is_aggressive) ? mid_ - offset : mid_ + 1 + offset);
+
+    Order order{
+        .side = is_buy ? Order::Side::BUY : Order::Side::SELL,
+        .type = Order::Type::LIMIT,
+        .id = next_id_++,
+        .price = price,
+        .visible_qty = qty,
+        .peak_qty = qty,
+        .hidden_qty = 0
+    };
+    if (qty > 1 && iceberg_dist_(gen_)) {
+        order.type = Order::Type::ICEBERG;
+        order.peak_qty = std::max<Quantity>(1, qty / static_cast<Quantity>(2 + gen_() % 9));
+        order.visible_qty = order.peak_qty;
+        order.hidden_qty = qty - order.peak_qty;
+    }
+    return order;
+}
+
+OrderMessage OrderFlowGenerator::nextMessage() {
+    // Drawn only if asked for, so flows without cancels and amends stay as they were
+    if (params_.cancel_ratio + params_.amend_ratio <= 0.0 || next_id_ == 1)
+        return OrderMessage{.kind = OrderMessage::Kind::ORDER, .order = next()};
+    auto draw = message_dist_(gen_);
+    if (draw >= params_.cancel_ratio + params_.amend_ratio)
+        return OrderMessage{.kind = OrderMessage::Kind::ORDER, .order = next()};
+
+    auto recent_count = std::min<OrderId>(next_id_ - 1, RECENT_ORDER_COUNT);
+    auto id = static_cast<OrderId>(next_id_ - 1 - static_cast<OrderId>(gen_() % recent_count));
+    if (draw < params_.cancel_ratio) {
+        return OrderMessage{
+            .kind = OrderMessage::Kind::CANCEL,
+            .order = Order{.side = Order::Side::BUY, .type = Order::Type::LIMIT, .id = id,
+                .price = 0, .visible_qty = 0, .peak_qty = 0, .hidden_qty = 0}
+        };
+    }
+
+    // Somewhere on either side of the mid, so some amends trade on re-entry
+    walk();
+    auto offset = static_cast<Price>(std::min<int>(offset_dist_(gen_), params_.price_range));
+    auto price = static_cast<Price>((gen_() & 1) ? mid_ - offset : mid_ + 1 + offset);
+    auto qty = drawQty(1.0);
+    return OrderMessage{
+        .kind = OrderMessage::Kind::AMEND,
+        .order = Order{.side = Order::Side::BUY, .type = Order::Type::LIMIT, .id = id,
+            .price = price, .visible_qty = qty, .peak_qty = qty, .hidden_qty = 0}
+    };
+}
+
+void OrderFlowGenerator::write(OrderWriter& writer, size_t count) {
+    for (size_t idx = 0; idx < count; ++idx)
+        writer.write(nextMessage());
+    writer.flush();
+}
+
+Price OrderFlowGenerator::midPrice() const noexcept {
+    return mid_;
+}
+
+void OrderFlowGenerator::walk() {
+    if (!walk_dist_(gen_))
+        return;
+
+    // Reflect off the bounds so every generated price stays representable
+    int margin = params_.price_range + params_.sweep_depth + 1;
+    int step = (gen_() & 1) ? 1 : -1;
+    if (mid_ + step < std::numeric_limits<Price>::min() + margin
+        || mid_ + step > std::numeric_limits<Price>::max() - margin)
+        step = -step;
+    mid_ = static_cast<Price>(mid_ + step);
+}
+
+Quantity OrderFlowGenerator::drawQty(double factor) {
+    auto qty = std::lround(qty_dist_(gen_) * factor);
+    return static_cast<Quantity>(std::clamp<long>(qty, 1, MAX_QTY));
+}
@@ -0,0 +1,428 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+#if defined(_WIN32)
+  #include <io.h>
+#else
+  #include <unistd.h>
+#endif
+
+#include "../include/order_io.h"
+#include "../include/util.h"
+
+namespace {
+    Order makeOrder(Order::Side side, Order::Type type, Order::TimeInForce tif, OrderId id,
+        Price price, Price stop_price, Quantity qty, Quantity peak_qty) noexcept {
+        if (type != Order::Type::ICEBERG && type != Order::Type::STOP_LIMIT)
+            peak_qty = qty;
+        auto visible_qty = std::min(qty, peak_qty);
+        return Order{
+            .side = side,
+            .type = type,
+            .tif = tif,
+            .id = id,
+            .price = price,
+            .stop_price = stop_price,
+            .visible_qty = visible_qty,
+            .peak_qty = peak_qty,
+            .hidden_qty = qty - visible_qty
+        };
+    }
+
+    // The order a cancel or amend refers to, with the new price and total quantity
+    // of an amend
+    Order makeTarget(OrderId id, Price price, Quantity qty) noexcept {
+        return Order{
+            .side = Order::Side::BUY,
+            .type = Order::Type::LIMIT,
+            .id = id,
+            .price = price,
+            .visible_qty = qty,
+            .peak_qty = qty,
+            .hidden_qty = 0
+        };
+    }
+
+    const char* skipSpace(const char* it, const char* end) noexcept {
+        while (it != end && std::isspace(static_cast<unsigned char>(*it)))
+            ++it;
+        return it;
+    }
+
+    // Parses ",<number>" with optional whitespace around both
+    template <class T>
+    bool parseField(const char*& it, const char* end, T& value) noexcept {
+        it = skipSpace(it, end);
+        if (it == end || *it != ',')
+            return false;
+
+        it = skipSpace(it + 1, end);
+        auto [ptr, ec] = std::from_chars(it, end, value);
+        if (ec != std::errc{})
+            return false;
+        it = ptr;
+        return true;
+    }
+
+    // Parses ",<word>" with optional whitespace around both, the word running up
+    // to the next comma or whitespace
+    bool parseWord(const char*& it, const char* end, std::string_view& word) noexcept {
+        it = skipSpace(it, end);
+        if (it == end || *it != ',')
+            return false;
+
+        it = skipSpace(it + 1, end);
+        const auto* word_begin = it;
+        while (it != end && *it != ',' && !std::isspace(static_cast<unsigned char>(*it)))
+            ++it;
+        word = std::string_view(word_begin, static_cast<size_t>(it - word_begin));
+        return true;
+    }
+
+    // Loads a stored field, failing if it doesn't fit in T
+    template <class T, class Stored>
+    bool loadField(const char* src, T& value) noexcept {
+        auto stored = loadLittleEndian<Stored>(src);
+        if (!std::in_range<T>(stored))
+            return false;
+        value = static_cast<T>(stored);
+        return true;
+    }
+
+    constexpr std::string_view MARKET_WORD = "MKT";
+    constexpr std::string_view STOP_WORD = "STOP";
+    constexpr std::string_view TIF_WORDS[] = {"GTC", "IOC", "FOK", "POST"};
+
+    size_t readSome(std::FILE* file, char* dst, size_t size) noexcept {
+        for (;;) {
+#if defined(_WIN32)
+            auto count = ::_read(::_fileno(file), dst, static_cast<unsigned>(size));
+#else
+            auto count = ::read(::fileno(file), dst, size);
+#endif
+            if (count >= 0)
+                return static_cast<size_t>(count);
+            if (errno != EINTR)
+                return 0;
+        }
+    }
+}
+
+bool order_io::decodeBinary(const char* record, Order& order) noexcept {
+    OrderMessage message;
+    if (!decodeBinary(record, message) || message.kind != OrderMessage::Kind::ORDER)
+        return false;
+    order = message.order;
+    return true;
+}
+
+bool order_io::decodeBinary(const char* record, OrderMessage& message) noexcept {
+    auto kind_byte = static_cast<uint8_t>(record[3]);
+    if (kind_byte > static_cast<uint8_t>(OrderMessage::Kind::AMEND))
+        return false;
+    message.kind = static_cast<OrderMessage::Kind>(kind_byte);
+    if (message.kind != OrderMessage::Kind::ORDER) {
+        OrderId id;
+        Price price = 0;
+        Quantity qty = 0;
+        if (!loadField<OrderId, int64_t>(record + 8, id)
+            || (message.kind == OrderMessage::Kind::AMEND
+                && (!loadField<Price, int32_t>(record + 4, price)
+                    || !loadField<Quantity, int64_t>(record + 16, qty))))
+            return false;
+        message.order = makeTarget(id, price, qty);
+        return true;
+    }
+
+    auto side_byte = static_cast<uint8_t>(record[0]);
+    auto type_byte = static_cast<uint8_t>(record[1]);
+    auto tif_byte = static_cast<uint8_t>(record[2]);
+    if (side_byte > 1 || type_byte > static_cast<uint8_t>(Order::Type::STOP_LIMIT)
+        || tif_byte > static_cast<uint8_t>(Order::TimeInForce::POST_ONLY))
+        return false;
+
+    OrderId id;
+    Price price;
+    Price stop_price;
+    Quantity qty;
+    Quantity peak_qty;
+    if (!loadField<OrderId, int64_t>(record + 8, id)
+        || !loadField<Price, int32_t>(record + 4, price)
+        || !loadField<Price, int32_t>(record + 32, stop_price)
+        || !loadField<Quantity, int64_t>(record + 16, qty)
+        || !loadField<Quantity, int64_t>(record + 24, peak_qty))
+        return false;
+
+    message.order = makeOrder(side_byte ? Order::Side::SELL : Order::Side::BUY,
+        static_cast<Order::Type>(type_byte), static_cast<Order::TimeInForce>(tif_byte),
+        id, price, stop_price, qty, peak_qty);
+    return true;
+}
+
+void order_io::encodeBinary(const Order& order, char* record) noexcept {
+    record[0] = (order.side == Order::Side::SELL) ? 1 : 0;
+    record[1] = static_cast<char>(order.type);
+    record[2] = static_cast<char>(order.tif);
+    record[3] = 0;
+    storeLittleEndian<int32_t>(order.price, record + 4);
+    storeLittleEndian<int64_t>(order.id, record + 8);
+    storeLittleEndian<int64_t>(order.visible_qty + order.hidden_qty, record + 16);
+    storeLittleEndian<int64_t>(order.peak_qty, record + 24);
+    storeLittleEndian<int32_t>(order.stop_price, record + 32);
+    storeLittleEndian<uint32_t>(0, record + 36);
+}
+
+void order_io::encodeBinary(const OrderMessage& message, char* record) noexcept {
+    if (message.kind == OrderMessage::Kind::ORDER) {
+        encodeBinary(message.order, record);
+        return;
+    }
+
+    std::fill_n(record, BINARY_RECORD_SIZE, 0);
+    record[3] = static_cast<char>(message.kind);
+    storeLittleEndian<int64_t>(message.order.id, record + 8);
+    if (message.kind == OrderMessage::Kind::AMEND) {
+        storeLittleEndian<int32_t>(message.order.price, record + 4);
+        storeLittleEndian<int64_t>(message.order.visible_qty, record + 16);
+    }
+}
+
+bool order_io::parseCsv(const char* begin, const char* end, Order& order) noexcept {
+    OrderMessage message;
+    if (!parseCsv(begin, end, message) || message.kind != OrderMessage::Kind::ORDER)
+        return false;
+    order = message.order;
+    return true;
+}
+
+bool order_io::parseCsv(const char* begin, const char* end, OrderMessage& message) noexcept {
+    auto* it = skipSpace(begin, end);
+    if (it == end)
+        return false;
+
+    if (*it == 'C' || *it == 'A') {
+        message.kind = (*it == 'C') ? OrderMessage::Kind::CANCEL : OrderMessage::Kind::AMEND;
+        ++it;
+        OrderId id;
+        Price price = 0;
+        Quantity qty = 0;
+        if (!parseField(it, end, id)
+            || (message.kind == OrderMessage::Kind::AMEND
+                && (!parseField(it, end, price) || !parseField(it, end, qty))))
+            return false;
+        message.order = makeTarget(id, price, qty);
+        return true;
+    }
+    if (*it != 'B' && *it != 'S')
+        return false;
+
+    auto side = (*it == 'B') ? Order::Side::BUY : Order::Side::SELL;
+    ++it;
+
+    OrderId id;
+    Price price;
+    Quantity qty;
+    if (!parseField(it, end, id) || !parseField(it, end, price) || !parseField(it, end, qty))
+        return false;
+
+    Quantity peak_qty = qty;
+    auto has_peak = false;
+    if (auto peak_it = it; parseField(peak_it, end, peak_qty)) {
+        has_peak = true;
+        it = peak_it;
+    }
+
+    auto tif = Order::TimeInForce::GTC;
+    Price stop_price = 0;
+    auto market = false;
+    auto stop = false;
+    for (std::string_view word; parseWord(it, end, word);) {
+        if (word == MARKET_WORD) {
+            market = true;
+        } else if (word == STOP_WORD) {
+            if (!parseField(it, end, stop_price))
+                return false;
+            stop = true;
+        } else {
+            auto tif_word = std::find(std::begin(TIF_WORDS), std::end(TIF_WORDS), word);
+            if (tif_word == std::end(TIF_WORDS))
+                return false;
+            tif = static_cast<Order::TimeInForce>(tif_word - std::begin(TIF_WORDS));
+        }
+    }
+    // Only limit orders, stop-limits included, can show a peak
+    if (market && has_peak)
+        return false;
+
+    auto type = stop
+        ? (market ? Order::Type::STOP : Order::Type::STOP_LIMIT)
+        : (market ? Order::Type::MARKET : has_peak ? Order::Type::ICEBERG : Order::Type::LIMIT);
+    message.kind = OrderMessage::Kind::ORDER;
+    message.order = makeOrder(side, type, tif, id, price, stop_price, qty, peak_qty);
+    return true;
+}
+
+char* order_io::formatCsv(const Order& order, char* out) noexcept {
+    auto* end = out + MAX_CSV_LINE_SIZE;
+    *out++ = (order.side == Order::Side::BUY) ? 'B' : 'S';
+    *out++ = ',';
+    out = std::to_chars(out, end, order.id).ptr;
+    *out++ = ',';
+    out = std::to_chars(out, end, order.price).ptr;
+    *out++ = ',';
+    auto qty = order.visible_qty + order.hidden_qty;
+    out = std::to_chars(out, end, qty).ptr;
+    if (order.type == Order::Type::ICEBERG
+        || (order.type == Order::Type::STOP_LIMIT && order.peak_qty < qty)) {
+        *out++ = ',';
+        out = std::to_chars(out, end, order.peak_qty).ptr;
+    }
+    if (order.type == Order::Type::MARKET || order.type == Order::Type::STOP) {
+        *out++ = ',';
+        out = std::copy(std::begin(MARKET_WORD), std::end(MARKET_WORD), out);
+    }
+    if (order.type == Order::Type::STOP || order.type == Order::Type::STOP_LIMIT) {
+        *out++ = ',';
+        out = std::copy(std::begin(STOP_WORD), std::end(STOP_WORD), out);
+        *out++ = ',';
+        out = std::to_chars(out, end, order.stop_price).ptr;
+    }
+    if (order.tif != Order::TimeInForce::GTC) {
+        const auto& word = TIF_WORDS[static_cast<size_t>(order.tif)];
+        *out++ = ',';
+        out = std::copy(std::begin(word), std::end(word), out);
+    }
+    *out++ = '\n';
+    return out;
+}
+
+char* order_io::formatCsv(const OrderMessage& message, char* out) noexcept {
+    if (message.kind == OrderMessage::Kind::ORDER)
+        return formatCsv(message.order, out);
+
+    auto* end = out + MAX_CSV_LINE_SIZE;
+    *out++ = (message.kind == OrderMessage::Kind::CANCEL) ? 'C' : 'A';
+    *out++ = ',';
+    out = std::to_chars(out, end, message.order.id).ptr;
+    if (message.kind == OrderMessage::Kind::AMEND) {
+        *out++ = ',';
+        out = std::to_chars(out, end, message.order.price).ptr;
+        *out++ = ',';
+        out = std::to_chars(out, end, message.order.visible_qty).ptr;
+    }
+    *out++ = '\n';
+    return out;
+}
+
+OrderReader::OrderReader(std::FILE* file, OrderFormat format, size_t buffer_size)
+    : file_(file)
+    , format_(format)
+    , buffer_(std::max(buffer_size, order_io::BINARY_RECORD_SIZE)) {
+}
+
+bool OrderReader::next(Order& order) {
+    OrderMessage message;
+    while (next(message)) {
+        if (message.kind == OrderMessage::Kind::ORDER) {
+            order = message.order;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool OrderReader::next(OrderMessage& message) {
+    return (format_ == OrderFormat::BINARY) ? nextBinary(message) : nextCsv(message);
+}
+
+bool OrderReader::nextCsv(OrderMessage& message) {
+    for (;;) {
+        const auto* data = buffer_.data();
+        const auto* line_end =
+            static_cast<const char*>(std::memchr(data + begin_, '\n', end_ - begin_));
+        if (!line_end) {
+            if (refill())
+                continue;
+            if (begin_ == end_)
+                return false;
+            // Last line without a terminator
+            line_end = data + end_;
+        }
+
+        const auto* line_begin = data + begin_;
+        begin_ = std::min(static_cast<size_t>(line_end - data) + 1, end_);
+        if (order_io::parseCsv(line_begin, line_end, message))
+            return true;
+    }
+}
+
+bool OrderReader::nextBinary(OrderMessage& message) {
+    for (;;) {
+        while (end_ - begin_ < order_io::BINARY_RECORD_SIZE)
+            if (!refill())
+                return false;
+
+        const auto* record = buffer_.data() + begin_;
+        begin_ += order_io::BINARY_RECORD_SIZE;
+        if (order_io::decodeBinary(record, message))
+            return true;
+    }
+}
+
+bool OrderReader::refill() {
+    if (eof_)
+        return false;
+
+    if (begin_) {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+    // A single line longer than the whole buffer
+    if (end_ == buffer_.size())
+        buffer_.resize(buffer_.size() * 2);
+
+    auto count = readSome(file_, buffer_.data() + end_, buffer_.size() - end_);
+    end_ += count;
+    eof_ = (count == 0);
+    return !eof_;
+}
+
+OrderWriter::OrderWriter(std::FILE* file, OrderFormat format, size_t buffer_size)
+    : file_(file)
+    , format_(format)
+    , buffer_(std::max(buffer_size, order_io::MAX_CSV_LINE_SIZE)) {
+}
+
+OrderWriter::~OrderWriter() {
+    flush();
+}
+
+void OrderWriter::write(const Order& order) {
+    write(OrderMessage{.kind = OrderMessage::Kind::ORDER, .order = order});
+}
+
+void OrderWriter::write(const OrderMessage& message) {
+    if (buffer_.size() - size_ < order_io::MAX_CSV_LINE_SIZE)
+        flush();
+
+    auto* out = buffer_.data() + size_;
+    if (format_ == OrderFormat::BINARY) {
+        order_io::encodeBinary(message, out);
+        size_ += order_io::BINARY_RECORD_SIZE;
+    } else {
+        size_ = static_cast<size_t>(order_io::formatCsv(message, out) - buffer_.data());
+    }
+}
+
+void OrderWriter::flush() {
+    if (size_)
+        std::fwrite(buffer_.data(), 1, size_, file_);
+    std::fflush(file_);
+    size_ = 0;
+}
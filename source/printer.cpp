@@ -1,44 +1,38 @@
 #include <iomanip>
+#include <sstream>
 
 #include "../include/printer.h"
 
-void Printer::print(const Trade& trade, std::ostream& os) {
-    os << trade.buy_id << ','
-        << trade.sell_id << ','
-        << trade.price << ','
-        << trade.qty << '\n';
+void Printer::print(const LatencyStats& stats, std::ostream& os) {
+    os << std::left << std::setfill(' ') << std::setw(16) << "histogram" << std::right;
+    for (auto* column : {"count", "p50", "p99", "p99.9", "max"})
+        os << std::setw(12) << column;
+    os << '\n';
+
+    printHistogramRow("process_ns", stats.latency(Probe::PROCESS), os);
+    printHistogramRow("match_ns", stats.latency(Probe::MATCH), os);
+    printHistogramRow("consume_best_ns", stats.latency(Probe::CONSUME_BEST), os);
+    printHistogramRow("cancel_ns", stats.latency(Probe::CANCEL), os);
+    printHistogramRow("amend_ns", stats.latency(Probe::AMEND), os);
+    printHistogramRow("levels_touched", stats.levelsTouched(), os);
+    printHistogramRow("orders_filled", stats.ordersFilled(), os);
+    printHistogramRow("iceberg_refills", stats.icebergRefills(), os);
+
+    const auto& slowest = stats.slowestMessage();
+    os << "slowest message: " << slowest.latency_ns << " ns, "
+        << slowest.counters.levels_touched << " levels touched, "
+        << slowest.counters.orders_filled << " orders filled, "
+        << slowest.counters.iceberg_refills << " iceberg refills\n";
 }
 
-void Printer::print(const std::vector<Trade>& trades, std::ostream& os) {
-    for (const auto& trade: trades)
-        print(trade, os);
-}
-
-void Printer::print(const MatchingEngine& engine, std::ostream& os) {
-    printHeader(os);
-
-    os << std::right;
-
-    // +----------+-------------+-------+-------+-------------+----------+
-    for (size_t section_idx: SECTION_INDICES) {
-        const SectionInfo& section_info = TABLE_SECTIONS[section_idx];
-        printTextSection("", section_info.width, HORIZONTAL_EDGE_CHAR, os, CORNER_CHAR);
-    }
-    os << CORNER_CHAR << '\n';
-
-    auto buy_iter = engine.buyBegin();
-    auto sell_iter = engine.sellBegin();
-    while (buy_iter != engine.buyEnd() || sell_iter != engine.sellEnd()) {
-        printOrderSection(
-            buy_iter != engine.buyEnd() ? &(*buy_iter++) : nullptr, Order::Side::BUY, os);
-        printOrderSection(
-            sell_iter != engine.sellEnd() ? &(*sell_iter++) : nullptr, Order::Side::SELL, os);
-        os << VERTICAL_EDGE_CHAR << '\n';
-    }
-
-    // +-----------------------------------------------------------------+
-    printTextSection("", TOTAL_COLUMN_WIDTH, HORIZONTAL_EDGE_CHAR, os,
-        CORNER_CHAR, CORNER_CHAR, true);
+void Printer::printHistogramRow(
+    std::string_view name, const LatencyHistogram& histogram, std::ostream& os) {
+    os << std::left << std::setfill(' ') << std::setw(16) << name << std::right
+        << std::setw(12) << histogram.count()
+        << std::setw(12) << histogram.percentile(0.5)
+        << std::setw(12) << histogram.percentile(0.99)
+        << std::setw(12) << histogram.percentile(0.999)
+        << std::setw(12) << histogram.max() << '\n';
 }
 
 void Printer::printHeader(std::ostream& os) {
@@ -62,6 +56,31 @@ void Printer::printHeader(std::ostream& os) {
     os << VERTICAL_EDGE_CHAR << '\n';
 }
 
+const std::string& Printer::bookHeaderText() {
+    static const std::string text = [] {
+        std::ostringstream os;
+        printHeader(os);
+        os << std::right;
+        for (size_t section_idx: SECTION_INDICES) {
+            const SectionInfo& section_info = TABLE_SECTIONS[section_idx];
+            printTextSection("", section_info.width, HORIZONTAL_EDGE_CHAR, os, CORNER_CHAR);
+        }
+        os << CORNER_CHAR << '\n';
+        return os.str();
+    }();
+    return text;
+}
+
+const std::string& Printer::bookFooterText() {
+    static const std::string text = [] {
+        std::ostringstream os;
+        printTextSection("", TOTAL_COLUMN_WIDTH, HORIZONTAL_EDGE_CHAR, os,
+            CORNER_CHAR, CORNER_CHAR, true);
+        return os.str();
+    }();
+    return text;
+}
+
 void Printer::printTextSection(
     std::string_view text, size_t width, char fill_char, std::ostream& os,
     char prefix, char suffix, bool end_line) {
@@ -77,35 +96,20 @@ void Printer::printTextSection(
         os << '\n';
 }
 
-void Printer::printOrderSection(const Order* order, Order::Side side, std::ostream& os) {
-    assert((order ? order->side : side) == side);
-
-    auto [start_idx, end_idx] = (side == Order::Side::BUY)
-        ? std::pair{size_t{0}, SECTION_INDICES.size() / 2}
-        : std::pair{SECTION_INDICES.size() / 2, SECTION_INDICES.size()};
-    for (size_t i = start_idx; i < end_idx; ++i) {
-        const SectionInfo& section_info = TABLE_SECTIONS[SECTION_INDICES[i]];
-        auto field =
-            order ? intToString(section_info.getter(*order), section_info.format_number) : "";
-        printTextSection(field, section_info.width, SEPARATOR_CHAR, os, VERTICAL_EDGE_CHAR);
-    }
-}
-
-std::string Printer::intToString(int64_t num, bool format) {
-    auto result = std::to_string(num);
+std::string Printer::groupDigits(std::string digits, bool format) {
     if (!format)
-        return result;
+        return digits;
 
     constexpr size_t GROUP_SIZE = 3;
     constexpr char GROUP_SEPARATOR = ',';
 
-    bool negative = result[0] == '-';
+    bool negative = digits[0] == '-';
     std::string formated_result;
-    formated_result.reserve(result.size() + result.size() / GROUP_SIZE);
-    for (size_t idx = 0; idx < result.size(); ++idx) {
-        if (idx > static_cast<size_t>(negative) && (result.size() - idx) % GROUP_SIZE == 0)
+    formated_result.reserve(digits.size() + digits.size() / GROUP_SIZE);
+    for (size_t idx = 0; idx < digits.size(); ++idx) {
+        if (idx > static_cast<size_t>(negative) && (digits.size() - idx) % GROUP_SIZE == 0)
             formated_result.push_back(GROUP_SEPARATOR);
-        formated_result.push_back(result[idx]);
+        formated_result.push_back(digits[idx]);
     }
     return formated_result;
 }
\ No newline at end of file
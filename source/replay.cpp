@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "../include/engine_diff.h"
+#include "../include/matching_engine.h"
+#include "../include/order_io.h"
+
+namespace {
+    struct Options {
+        std::string_view lhs_name{"map"};
+        std::string_view rhs_name{"ladder"};
+        uint64_t full_check_interval{1000};
+        int repeat{3};
+    };
+
+    // Calls fn with the type identity of the engine the name selects. Returns false
+    // if no engine has that name.
+    template <class Fn>
+    bool withEngine(std::string_view name, Fn&& fn) {
+        if (name == "map")
+            fn(std::type_identity<MatchingEngine>{});
+        else if (name == "ladder")
+            fn(std::type_identity<LadderMatchingEngine>{});
+        else if (name == "ring")
+            fn(std::type_identity<RingMatchingEngine>{});
+        else
+            return false;
+        return true;
+    }
+
+    std::string_view kindText(Divergence::Kind kind) {
+        switch (kind) {
+        case Divergence::Kind::TRADES:
+            return "trades";
+        case Divergence::Kind::CANCEL:
+            return "cancel results";
+        case Divergence::Kind::DELTAS:
+            return "level deltas";
+        case Divergence::Kind::BOOK:
+            return "books";
+        }
+        return "";
+    }
+
+    template <class Engine>
+    void apply(Engine& engine, const OrderMessage& message) {
+        switch (message.kind) {
+        case OrderMessage::Kind::ORDER:
+            engine.process(message.order);
+            break;
+        case OrderMessage::Kind::CANCEL:
+            engine.cancel(message.order.id);
+            break;
+        case OrderMessage::Kind::AMEND:
+            engine.amend(message.order.id, message.order.price, message.order.visible_qty);
+            break;
+        }
+    }
+
+    // Messages per second over the whole stream, best of the runs so a noisy
+    // machine doesn't penalize either side
+    template <class Engine>
+    double measureThroughput(const std::vector<OrderMessage>& messages, int repeat) {
+        double best_rate = 0;
+        for (int run = 0; run < repeat; ++run) {
+            auto engine = std::make_unique<Engine>();
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& message : messages)
+                apply(*engine, message);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best_rate = std::max(best_rate, static_cast<double>(messages.size()) / elapsed.count());
+        }
+        return best_rate;
+    }
+
+    template <class LhsEngine, class RhsEngine>
+    bool replay(const std::vector<OrderMessage>& messages, const Options& options) {
+        {
+            auto lhs = std::make_unique<LhsEngine>();
+            auto rhs = std::make_unique<RhsEngine>();
+            EngineDiff diff(*lhs, *rhs, options.full_check_interval);
+            for (const auto& message : messages)
+                if (!diff.apply(message))
+                    break;
+            diff.compareBooks();
+
+            if (const auto& divergence = diff.divergence()) {
+                std::cout << options.lhs_name << " and " << options.rhs_name << ' '
+                    << kindText(divergence->kind) << " differ after message "
+                    << divergence->message;
+                if (divergence->message) {
+                    char line[order_io::MAX_CSV_LINE_SIZE];
+                    auto* end = order_io::formatCsv(messages[divergence->message - 1], line);
+                    std::cout << ": " << std::string_view(line, static_cast<size_t>(end - line));
+                } else {
+                    std::cout << '\n';
+                }
+                std::cout << "  " << divergence->detail;
+                return false;
+            }
+        }
+        std::cout << "Replayed " << messages.size() << " messages through " << options.lhs_name
+            << " and " << options.rhs_name << " with no divergence\n";
+
+        if (messages.empty() || options.repeat <= 0)
+            return true;
+        auto lhs_rate = measureThroughput<LhsEngine>(messages, options.repeat);
+        auto rhs_rate = measureThroughput<RhsEngine>(messages, options.repeat);
+        std::cout << std::fixed << std::setprecision(0)
+            << options.lhs_name << ": " << lhs_rate << " messages/s\n"
+            << options.rhs_name << ": " << rhs_rate << " messages/s, "
+            << std::setprecision(2) << rhs_rate / lhs_rate << "x\n";
+        return true;
+    }
+}
+
+// Usage: replay [--binary] [--engines A,B] [--full-every N] [--repeat N] [input_file]
+//
+// Differential test of two engine layouts, map, ladder or ring, map and ladder by
+// default. Reads the whole message stream, orders, cancels and amends, CSV from
+// standard input by default, then feeds it to both engines in lockstep. After
+// every message their trades or cancel results and level deltas must match, and
+// every N messages (1000 by default, 0 for only at
+// the end) their books are compared order by order. The first divergence is
+// reported along with the message that caused it. If there's none, the stream is
+// replayed through each engine alone to compare throughput, best of --repeat runs
+// (3 by default, 0 to skip). Exits with 1 on a divergence.
+int main(int argc, char* argv[]) {
+    auto format = OrderFormat::CSV;
+    Options options;
+    std::FILE* input = stdin;
+    for (int idx = 1; idx < argc; ++idx) {
+        bool has_value = idx + 1 < argc;
+        if (std::strcmp(argv[idx], "--binary") == 0) {
+            format = OrderFormat::BINARY;
+        } else if (std::strcmp(argv[idx], "--engines") == 0 && has_value) {
+            std::string_view names = argv[++idx];
+            auto comma = names.find(',');
+            if (comma == std::string_view::npos) {
+                std::cerr << "Expected two engines separated by a comma\n";
+                return 1;
+            }
+            options.lhs_name = names.substr(0, comma);
+            options.rhs_name = names.substr(comma + 1);
+        } else if (std::strcmp(argv[idx], "--full-every") == 0 && has_value) {
+            options.full_check_interval = std::strtoull(argv[++idx], nullptr, 10);
+        } else if (std::strcmp(argv[idx], "--repeat") == 0 && has_value) {
+            options.repeat = std::atoi(argv[++idx]);
+        } else if (!(input = std::fopen(argv[idx], "rb"))) {
+            std::perror(argv[idx]);
+            return 1;
+        }
+    }
+
+    std::vector<OrderMessage> messages;
+    {
+        OrderReader reader(input, format);
+        OrderMessage message;
+        while (reader.next(message))
+            messages.push_back(message);
+    }
+    if (input != stdin)
+        std::fclose(input);
+
+    bool agree = false;
+    bool known = withEngine(options.lhs_name, [&](auto lhs) {
+        bool rhs_known = withEngine(options.rhs_name, [&](auto rhs) {
+            agree = replay<typename decltype(lhs)::type, typename decltype(rhs)::type>(
+                messages, options);
+        });
+        if (!rhs_known)
+            std::cerr << "Unknown engine " << options.rhs_name << '\n';
+    });
+    if (!known)
+        std::cerr << "Unknown engine " << options.lhs_name << '\n';
+    return agree ? 0 : 1;
+}
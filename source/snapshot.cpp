@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "../include/snapshot.h"
+#include "../include/util.h"
+
+namespace {
+    constexpr char MAGIC[8] = {'L', 'O', 'B', 'S', 'N', 'A', 'P', '1'};
+
+    // Prices are stored 32 bits wide whatever the width of Price
+    bool loadPrice(const char* in, Price& price) noexcept {
+        auto stored = loadLittleEndian<int32_t>(in);
+        if (!std::in_range<Price>(stored))
+            return false;
+        price = static_cast<Price>(stored);
+        return true;
+    }
+}
+
+void snapshot_io::encodeHeader(const Header& header, char* out) noexcept {
+    std::memcpy(out, MAGIC, sizeof(MAGIC));
+    storeLittleEndian(VERSION, out + 8);
+    storeLittleEndian(uint32_t{0}, out + 12);
+    storeLittleEndian(header.seq, out + 16);
+    storeLittleEndian(header.order_count, out + 24);
+    storeLittleEndian(header.buy_level_count, out + 32);
+    storeLittleEndian(header.sell_level_count, out + 36);
+    storeLittleEndian(header.stop_count, out + 40);
+    storeLittleEndian(static_cast<int32_t>(header.last_trade_price), out + 48);
+    out[52] = header.has_traded ? 1 : 0;
+    out[53] = out[54] = out[55] = 0;
+}
+
+bool snapshot_io::decodeHeader(const char* in, Header& header) noexcept {
+    if (std::memcmp(in, MAGIC, sizeof(MAGIC)) != 0 || loadLittleEndian<uint32_t>(in + 8) != VERSION)
+        return false;
+    header.seq = loadLittleEndian<uint64_t>(in + 16);
+    header.order_count = loadLittleEndian<uint64_t>(in + 24);
+    header.buy_level_count = loadLittleEndian<uint32_t>(in + 32);
+    header.sell_level_count = loadLittleEndian<uint32_t>(in + 36);
+    header.stop_count = loadLittleEndian<uint64_t>(in + 40);
+    header.has_traded = in[52] != 0;
+    return loadPrice(in + 48, header.last_trade_price);
+}
+
+void snapshot_io::encodeLevel(Price price, uint32_t order_count, char* out) noexcept {
+    storeLittleEndian(static_cast<int32_t>(price), out);
+    storeLittleEndian(order_count, out + 4);
+}
+
+bool snapshot_io::decodeLevelPrice(const char* in, Price& price) noexcept {
+    return loadPrice(in, price);
+}
+
+uint32_t snapshot_io::decodeLevelOrderCount(const char* in) noexcept {
+    return loadLittleEndian<uint32_t>(in + 4);
+}
+
+void snapshot_io::encodeOrder(const Order& order, char* out) noexcept {
+    out[0] = (order.type == Order::Type::ICEBERG) ? 1 : 0;
+    out[1] = static_cast<char>(order.tif);
+    out[2] = out[3] = 0;
+    storeLittleEndian(static_cast<int32_t>(order.id), out + 4);
+    storeLittleEndian(static_cast<int32_t>(order.visible_qty), out + 8);
+    storeLittleEndian(static_cast<int32_t>(order.peak_qty), out + 12);
+    storeLittleEndian(static_cast<int32_t>(order.hidden_qty), out + 16);
+}
+
+bool snapshot_io::decodeOrder(
+    const char* in, Order::Side side, Price price, Order& order) noexcept {
+    auto type_byte = static_cast<uint8_t>(in[0]);
+    auto tif_byte = static_cast<uint8_t>(in[1]);
+    if (type_byte > static_cast<uint8_t>(Order::Type::ICEBERG)
+        || tif_byte > static_cast<uint8_t>(Order::TimeInForce::POST_ONLY))
+        return false;
+    order = Order{
+        .side = side,
+        .type = static_cast<Order::Type>(type_byte),
+        .tif = static_cast<Order::TimeInForce>(tif_byte),
+        .id = static_cast<OrderId>(loadLittleEndian<int32_t>(in + 4)),
+        .price = price,
+        .visible_qty = static_cast<Quantity>(loadLittleEndian<int32_t>(in + 8)),
+        .peak_qty = static_cast<Quantity>(loadLittleEndian<int32_t>(in + 12)),
+        .hidden_qty = static_cast<Quantity>(loadLittleEndian<int32_t>(in + 16))
+    };
+    return true;
+}
+
+void snapshot_io::encodeStop(const Order& order, char* out) noexcept {
+    out[0] = (order.side == Order::Side::SELL) ? 1 : 0;
+    out[1] = static_cast<char>(order.type);
+    out[2] = static_cast<char>(order.tif);
+    out[3] = 0;
+    storeLittleEndian(static_cast<int32_t>(order.id), out + 4);
+    storeLittleEndian(static_cast<int32_t>(order.price), out + 8);
+    storeLittleEndian(static_cast<int32_t>(order.stop_price), out + 12);
+    storeLittleEndian(static_cast<int32_t>(order.visible_qty + order.hidden_qty), out + 16);
+    storeLittleEndian(static_cast<int32_t>(order.peak_qty), out + 20);
+}
+
+bool snapshot_io::decodeStop(const char* in, Order& order) noexcept {
+    auto side_byte = static_cast<uint8_t>(in[0]);
+    auto type_byte = static_cast<uint8_t>(in[1]);
+    auto tif_byte = static_cast<uint8_t>(in[2]);
+    Price price;
+    Price stop_price;
+    if (side_byte > 1 || type_byte > static_cast<uint8_t>(Order::Type::STOP_LIMIT)
+        || tif_byte > static_cast<uint8_t>(Order::TimeInForce::POST_ONLY)
+        || !loadPrice(in + 8, price) || !loadPrice(in + 12, stop_price))
+        return false;
+
+    auto qty = static_cast<Quantity>(loadLittleEndian<int32_t>(in + 16));
+    auto peak_qty = static_cast<Quantity>(loadLittleEndian<int32_t>(in + 20));
+    auto visible_qty = std::min(qty, peak_qty);
+    order = Order{
+        .side = side_byte ? Order::Side::SELL : Order::Side::BUY,
+        .type = static_cast<Order::Type>(type_byte),
+        .tif = static_cast<Order::TimeInForce>(tif_byte),
+        .id = static_cast<OrderId>(loadLittleEndian<int32_t>(in + 4)),
+        .price = price,
+        .stop_price = stop_price,
+        .visible_qty = visible_qty,
+        .peak_qty = peak_qty,
+        .hidden_qty = qty - visible_qty
+    };
+    return true;
+}
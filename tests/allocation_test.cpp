@@ -0,0 +1,50 @@
+#include "../include/matching_engine.h"
+#include "test_orders.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <new>
+
+// Counts every global allocation in this test's own binary
+namespace {
+    std::atomic<size_t> allocation_count{0};
+    // The replacements forward to the library's aligned forms at the default
+    // alignment, so no pointer from an operator new ever reaches free
+    constexpr std::align_val_t DEFAULT_ALIGNMENT{__STDCPP_DEFAULT_NEW_ALIGNMENT__};
+}
+
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size, DEFAULT_ALIGNMENT);
+}
+
+void operator delete(void* ptr) noexcept {
+    ::operator delete(ptr, DEFAULT_ALIGNMENT);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    ::operator delete(ptr, DEFAULT_ALIGNMENT);
+}
+
+TEST(AllocationTest, SweepsDoNotAllocate) {
+    MatchingEngine engine;
+    // Warm up the trade buffer with a sweep as large as the measured ones
+    auto rest = [&engine](OrderId first_id) {
+        for (OrderId id = first_id; id < first_id + 16; ++id)
+            engine.process(
+                makeOrder(Order::Side::SELL, id, static_cast<Price>(100 + id % 4), 100, 10));
+    };
+    rest(0);
+    engine.process(makeOrder(Order::Side::BUY, 1000, 110, 1600, 1600));
+
+    rest(16);
+    auto before = allocation_count.load(std::memory_order_relaxed);
+    // Fills every iceberg ten times across four levels
+    const auto& trades = engine.process(makeOrder(Order::Side::BUY, 1001, 110, 1600, 1600));
+    auto after = allocation_count.load(std::memory_order_relaxed);
+
+    EXPECT_EQ(trades.size(), 16u);
+    for (const auto& trade : trades)
+        EXPECT_EQ(trade.qty, 100);
+    EXPECT_EQ(after, before);
+}
@@ -0,0 +1,144 @@
+#include "../include/engine_diff.h"
+#include "../include/matching_engine.h"
+#include "../include/order_flow.h"
+#include "test_orders.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <memory>
+
+TEST(EngineDiffTest, LayoutsAgreeOnGeneratedFlow) {
+    OrderFlowParams params;
+    params.iceberg_ratio = 0.2;
+    params.sweep_size_factor = 4.0;
+    OrderFlowGenerator generator(params);
+
+    auto map_engine = std::make_unique<MatchingEngine>();
+    auto ladder_engine = std::make_unique<LadderMatchingEngine>();
+    EngineDiff ladder_diff(*map_engine, *ladder_engine);
+    // Only compares whole books on request, the deltas cover the rest
+    auto other_map_engine = std::make_unique<MatchingEngine>();
+    auto ring_engine = std::make_unique<RingMatchingEngine>();
+    EngineDiff ring_diff(*other_map_engine, *ring_engine, 0);
+    for (int idx = 0; idx < 5000; ++idx) {
+        auto order = generator.next();
+        ASSERT_TRUE(ladder_diff.process(order)) << ladder_diff.divergence()->detail;
+        ASSERT_TRUE(ring_diff.process(order)) << ring_diff.divergence()->detail;
+    }
+    EXPECT_TRUE(ring_diff.compareBooks());
+    EXPECT_EQ(ladder_diff.messageCount(), 5000);
+    EXPECT_FALSE(ladder_diff.divergence());
+}
+
+TEST(EngineDiffTest, ReportsFirstDivergence) {
+    // The engines start out with different books, which only shows once they trade
+    MatchingEngine lhs;
+    LadderMatchingEngine rhs;
+    lhs.process(makeOrder(Order::Side::SELL, 1, 100, 3));
+    rhs.process(makeOrder(Order::Side::SELL, 1, 100, 5));
+
+    EngineDiff diff(lhs, rhs, 0);
+    EXPECT_TRUE(diff.process(makeOrder(Order::Side::BUY, 2, 90, 10)));
+    EXPECT_FALSE(diff.process(makeOrder(Order::Side::BUY, 3, 100, 4)));
+    ASSERT_TRUE(diff.divergence());
+    EXPECT_EQ(diff.divergence()->message, 2);
+    EXPECT_EQ(diff.divergence()->kind, Divergence::Kind::TRADES);
+    EXPECT_EQ(diff.divergence()->detail, "trade 1 of the message is 3,1,100,3\n  vs 3,1,100,4\n");
+
+    // Nothing is processed once diverged
+    EXPECT_FALSE(diff.process(makeOrder(Order::Side::BUY, 4, 100, 4)));
+    EXPECT_EQ(diff.messageCount(), 2);
+    EXPECT_FALSE(lhs.contains(4));
+}
+
+TEST(EngineDiffTest, ComparesBooksOrderByOrder) {
+    // Same levels, but the orders at 100 rest in a different sequence
+    MatchingEngine lhs;
+    MatchingEngine rhs;
+    lhs.process(makeOrder(Order::Side::BUY, 1, 100, 5));
+    lhs.process(makeOrder(Order::Side::BUY, 2, 100, 5));
+    rhs.process(makeOrder(Order::Side::BUY, 2, 100, 5));
+    rhs.process(makeOrder(Order::Side::BUY, 1, 100, 5));
+
+    EngineDiff diff(lhs, rhs, 0);
+    EXPECT_TRUE(diff.process(makeOrder(Order::Side::SELL, 3, 110, 5)));
+    EXPECT_FALSE(diff.compareBooks());
+    ASSERT_TRUE(diff.divergence());
+    EXPECT_EQ(diff.divergence()->message, 1);
+    EXPECT_EQ(diff.divergence()->kind, Divergence::Kind::BOOK);
+    EXPECT_EQ(diff.divergence()->detail,
+        "buy order 1 is id 1 at 100, 5 visible, 0 hidden, peak 5\n"
+        "  vs id 2 at 100, 5 visible, 0 hidden, peak 5\n");
+}
+
+TEST(EngineDiffTest, LayoutsAgreeOnCancelsAndAmends) {
+    OrderFlowParams params;
+    params.iceberg_ratio = 0.2;
+    params.cancel_ratio = 0.3;
+    params.amend_ratio = 0.15;
+    OrderFlowGenerator generator(params);
+
+    // Through a replay file, as replay --engines map,ring reads it
+    auto* file = std::tmpfile();
+    {
+        OrderWriter writer(file, OrderFormat::CSV);
+        generator.write(writer, 20000);
+    }
+    std::rewind(file);
+
+    auto map_engine = std::make_unique<MatchingEngine>();
+    auto ring_engine = std::make_unique<RingMatchingEngine>();
+    EngineDiff diff(*map_engine, *ring_engine, 100);
+    OrderReader reader(file, OrderFormat::CSV);
+    int resting_cancels = 0;
+    int amends = 0;
+    for (OrderMessage message; reader.next(message);) {
+        if (message.kind == OrderMessage::Kind::CANCEL && map_engine->contains(message.order.id))
+            ++resting_cancels;
+        amends += (message.kind == OrderMessage::Kind::AMEND);
+        ASSERT_TRUE(diff.apply(message)) << diff.divergence()->detail;
+    }
+    std::fclose(file);
+    EXPECT_TRUE(diff.compareBooks());
+    EXPECT_EQ(diff.messageCount(), 20000);
+    // Most cancels leave a tombstone behind the front of their level
+    EXPECT_GT(resting_cancels, 1000);
+    EXPECT_GT(amends, 1000);
+}
+
+TEST(EngineDiffTest, LayoutsAgreeWhileTombstonesPile) {
+    // The first order keeps the front while the ones behind it come and go, so the
+    // ring level packs its tombstones again and again
+    auto map_engine = std::make_unique<MatchingEngine>();
+    auto ring_engine = std::make_unique<RingMatchingEngine>();
+    EngineDiff diff(*map_engine, *ring_engine);
+    ASSERT_TRUE(diff.process(makeOrder(Order::Side::SELL, 1, 100, 10)));
+    ASSERT_TRUE(diff.process(makeOrder(Order::Side::SELL, 2, 100, 10)));
+    for (OrderId id = 3; id <= 2000; ++id) {
+        ASSERT_TRUE(diff.process(makeOrder(Order::Side::SELL, id, 100, 10)));
+        ASSERT_TRUE(diff.cancel(id - 1)) << diff.divergence()->detail;
+        // Lowering keeps the slot, raising removes the order and re-enters it
+        if (id % 10 == 0) {
+            ASSERT_TRUE(diff.amend(id, 100, 5)) << diff.divergence()->detail;
+            ASSERT_TRUE(diff.amend(id, 100, 15)) << diff.divergence()->detail;
+        }
+    }
+    // Takes the front, then moves the last order to a new price
+    ASSERT_TRUE(diff.process(makeOrder(Order::Side::BUY, 3000, 100, 10)));
+    ASSERT_TRUE(diff.amend(2000, 99, 10)) << diff.divergence()->detail;
+    EXPECT_EQ(map_engine->orderCount(), 1u);
+    EXPECT_TRUE(diff.compareBooks());
+}
+
+TEST(EngineDiffTest, ReportsCancelDivergence) {
+    MatchingEngine lhs;
+    RingMatchingEngine rhs;
+    lhs.process(makeOrder(Order::Side::BUY, 1, 100, 5));
+
+    EngineDiff diff(lhs, rhs, 0);
+    EXPECT_FALSE(diff.cancel(1));
+    ASSERT_TRUE(diff.divergence());
+    EXPECT_EQ(diff.divergence()->message, 1);
+    EXPECT_EQ(diff.divergence()->kind, Divergence::Kind::CANCEL);
+    EXPECT_EQ(diff.divergence()->detail, "cancel of 1 found the order\n  vs nothing\n");
+}
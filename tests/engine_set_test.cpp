@@ -0,0 +1,148 @@
+#include "../include/matching_engine_set.h"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr SymbolId SYMBOL_COUNT = 16;
+
+    std::vector<SymbolOrder> makeFeed(unsigned seed, int order_count) {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<SymbolId> symbol_dist(0, SYMBOL_COUNT - 1);
+        std::uniform_int_distribution<int> price_dist(95, 105);
+        std::uniform_int_distribution<int> qty_dist(1, 50);
+
+        std::vector<SymbolOrder> feed;
+        for (OrderId id = 1; id <= order_count; ++id) {
+            auto qty = qty_dist(gen);
+            auto peak = (id % 5 == 0) ? std::max(qty / 4, 1) : qty;
+            feed.push_back(SymbolOrder{
+                .symbol = symbol_dist(gen),
+                .order = Order{
+                    .side = (gen() % 2) ? Order::Side::BUY : Order::Side::SELL,
+                    .type = (peak < qty) ? Order::Type::ICEBERG : Order::Type::LIMIT,
+                    .id = id,
+                    .price = static_cast<Price>(price_dist(gen)),
+                    .visible_qty = peak,
+                    .peak_qty = peak,
+                    .hidden_qty = qty - peak
+                }
+            });
+        }
+        return feed;
+    }
+
+    bool sameTrade(const Trade& lhs, const Trade& rhs) {
+        return lhs.buy_id == rhs.buy_id && lhs.sell_id == rhs.sell_id &&
+            lhs.price == rhs.price && lhs.qty == rhs.qty;
+    }
+}
+
+TEST(SpscRingTest, PreservesOrderAcrossThreads) {
+    constexpr uint64_t ITEM_COUNT = 200'000;
+    auto ring = std::make_unique<SpscRing<uint64_t, 1024>>();
+
+    std::thread producer([&ring] {
+        for (uint64_t item = 0; item < ITEM_COUNT; ++item)
+            while (!ring->tryPush(item))
+                std::this_thread::yield();
+    });
+
+    uint64_t expected = 0;
+    while (expected < ITEM_COUNT) {
+        uint64_t item;
+        if (ring->tryPop(item))
+            ASSERT_EQ(item, expected++);
+        else
+            std::this_thread::yield();
+    }
+    producer.join();
+    EXPECT_TRUE(ring->empty());
+}
+
+TEST(MatchingEngineSetTest, MatchesPerSymbolEngines) {
+    auto feed = makeFeed(7, 20000);
+
+    std::vector<std::vector<Trade>> expected(SYMBOL_COUNT);
+    {
+        std::vector<std::unique_ptr<MatchingEngine>> engines;
+        for (SymbolId symbol = 0; symbol < SYMBOL_COUNT; ++symbol)
+            engines.push_back(std::make_unique<MatchingEngine>(1024));
+        for (const auto& [symbol, order] : feed)
+            for (const auto& trade : engines[symbol]->process(order))
+                expected[symbol].push_back(trade);
+    }
+
+    // Each symbol is only ever handled by its own worker thread
+    std::vector<std::vector<Trade>> actual(SYMBOL_COUNT);
+    {
+        MatchingEngineSet engine_set(3, [&actual](SymbolId symbol, std::span<const Trade> trades) {
+            actual[symbol].insert(std::end(actual[symbol]), std::begin(trades), std::end(trades));
+        });
+        for (const auto& [symbol, order] : feed)
+            engine_set.submit(symbol, order);
+        engine_set.drain();
+    }
+
+    for (SymbolId symbol = 0; symbol < SYMBOL_COUNT; ++symbol) {
+        ASSERT_EQ(actual[symbol].size(), expected[symbol].size());
+        for (size_t idx = 0; idx < expected[symbol].size(); ++idx)
+            EXPECT_TRUE(sameTrade(actual[symbol][idx], expected[symbol][idx]));
+    }
+}
+
+TEST(MatchingEngineSetTest, RoutesCancelsAndAmends) {
+    auto feed = makeFeed(11, 20000);
+
+    // After every order, maybe cancel or amend an earlier one, so some of each land
+    // on orders still resting and some on orders already gone
+    std::vector<std::vector<Trade>> expected(SYMBOL_COUNT);
+    std::vector<std::vector<Trade>> actual(SYMBOL_COUNT);
+    size_t cancelled = 0;
+    {
+        std::vector<std::unique_ptr<MatchingEngine>> engines;
+        for (SymbolId symbol = 0; symbol < SYMBOL_COUNT; ++symbol)
+            engines.push_back(std::make_unique<MatchingEngine>(1024));
+        MatchingEngineSet engine_set(3, [&actual](SymbolId symbol, std::span<const Trade> trades) {
+            actual[symbol].insert(std::end(actual[symbol]), std::begin(trades), std::end(trades));
+        });
+
+        std::mt19937 gen(13);
+        std::uniform_int_distribution<int> price_dist(95, 105);
+        std::uniform_int_distribution<int> qty_dist(0, 50);
+        for (size_t idx = 0; idx < feed.size(); ++idx) {
+            auto& engine = *engines[feed[idx].symbol];
+            for (const auto& trade : engine.process(feed[idx].order))
+                expected[feed[idx].symbol].push_back(trade);
+            engine_set.submit(feed[idx].symbol, feed[idx].order);
+
+            const auto& [symbol, order] = feed[gen() % (idx + 1)];
+            switch (gen() % 4) {
+            case 0:
+                cancelled += engines[symbol]->cancel(order.id);
+                engine_set.cancel(symbol, order.id);
+                break;
+            case 1: {
+                auto price = static_cast<Price>(price_dist(gen));
+                auto qty = qty_dist(gen);
+                for (const auto& trade : engines[symbol]->amend(order.id, price, qty))
+                    expected[symbol].push_back(trade);
+                engine_set.amend(symbol, order.id, price, qty);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+        engine_set.drain();
+    }
+    EXPECT_GT(cancelled, 0u);
+
+    for (SymbolId symbol = 0; symbol < SYMBOL_COUNT; ++symbol) {
+        ASSERT_EQ(actual[symbol].size(), expected[symbol].size());
+        for (size_t idx = 0; idx < expected[symbol].size(); ++idx)
+            EXPECT_TRUE(sameTrade(actual[symbol][idx], expected[symbol][idx]));
+    }
+}
@@ -1,11 +1,19 @@
 
 #include "../include/matching_engine.h"
+#include "../include/output_thread.h"
 #include "../include/printer.h"
+#include "test_orders.h"
 
 #include <gtest/gtest.h>
+#include <deque>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <span>
 #include <sstream>
 #include <streambuf>
+#include <vector>
 
 class MatchingEngineFixture: public ::testing::Test {
 protected:
@@ -22,32 +30,6 @@ protected:
     MatchingEngine engine;
 };
 
-Order makeOrder(Order::Side side, OrderId id, Price price, Quantity qty,
-    Quantity iceberg_peak_qty = 0) {
-    Order::Type type = Order::Type::LIMIT;
-    Quantity visible_qty = qty,
-        peak_qty = qty,
-        hidden_qty = 0;
-
-    if (iceberg_peak_qty) {
-        type = Order::Type::ICEBERG;
-        hidden_qty = visible_qty;
-        peak_qty = iceberg_peak_qty;
-        visible_qty = std::min(hidden_qty, peak_qty);
-        hidden_qty -= visible_qty;
-    }
-
-    return Order{
-        .side = side,
-        .type = type,
-        .id = id,
-        .price = price,
-        .visible_qty = visible_qty,
-        .peak_qty = peak_qty,
-        .hidden_qty = hidden_qty
-    };
-}
-
 TEST_F(MatchingEngineFixture, AggressiveIcebergOrder) {
     Printer::print(engine.process(makeOrder(Order::Side::BUY, 100322, 5103, 7500)));
     EXPECT_EQ(buffer.str(), "");
@@ -395,3 +377,985 @@ TEST_F(MatchingEngineFixture, ComplexExample3) {
     );
     buffer.str("");
 }
+
+
+TEST_F(MatchingEngineFixture, CancelOrder) {
+    engine.process(makeOrder(Order::Side::BUY, 1, 100, 10));
+    engine.process(makeOrder(Order::Side::BUY, 2, 100, 20));
+    engine.process(makeOrder(Order::Side::BUY, 3, 99, 30));
+    engine.process(makeOrder(Order::Side::SELL, 4, 101, 40));
+
+    EXPECT_TRUE(engine.cancel(2));
+    EXPECT_TRUE(engine.cancel(4));
+    EXPECT_FALSE(engine.cancel(4));
+    EXPECT_FALSE(engine.contains(2));
+    EXPECT_TRUE(engine.contains(1));
+
+    Printer::print(engine);
+    EXPECT_EQ(buffer.str(),
+    "+-----------------------------------------------------------------+\n"
+    "| BUY                            | SELL                           |\n"
+    "| Id       | Volume      | Price | Price | Volume      | Id       |\n"
+    "+----------+-------------+-------+-------+-------------+----------+\n"
+    "|         1|           10|    100|       |             |          |\n"
+    "|         3|           30|     99|       |             |          |\n"
+    "+-----------------------------------------------------------------+\n"
+    );
+    buffer.str("");
+
+    Printer::print(engine.process(makeOrder(Order::Side::SELL, 5, 99, 40)));
+    EXPECT_EQ(buffer.str(),
+    "1,5,100,10\n"
+    "3,5,99,30\n"
+    );
+}
+
+
+TEST_F(MatchingEngineFixture, RejectsDuplicateIds) {
+    engine.process(makeOrder(Order::Side::BUY, 1, 100, 10));
+    engine.process(makeOrder(Order::Side::SELL, 2, 105, 10));
+
+    // Neither a crossing nor a resting order may reuse a resting id
+    EXPECT_TRUE(engine.process(makeOrder(Order::Side::SELL, 1, 100, 10)).empty());
+    EXPECT_TRUE(engine.process(makeOrder(Order::Side::BUY, 2, 101, 20)).empty());
+    EXPECT_EQ(engine.orderCount(), 2u);
+    EXPECT_EQ(engine.sequence(), 4u);
+
+    // Cancelling the id still reaches the first order, after which it's free again
+    EXPECT_TRUE(engine.cancel(1));
+    EXPECT_FALSE(engine.cancel(1));
+    engine.process(makeOrder(Order::Side::BUY, 1, 99, 30));
+    Printer::print(engine);
+    EXPECT_EQ(buffer.str(),
+    "+-----------------------------------------------------------------+\n"
+    "| BUY                            | SELL                           |\n"
+    "| Id       | Volume      | Price | Price | Volume      | Id       |\n"
+    "+----------+-------------+-------+-------+-------------+----------+\n"
+    "|         1|           30|     99|    105|           10|         2|\n"
+    "+-----------------------------------------------------------------+\n"
+    );
+}
+
+TEST_F(MatchingEngineFixture, CancelRefilledIceberg) {
+    engine.process(makeOrder(Order::Side::SELL, 1, 100, 30, 10));
+    engine.process(makeOrder(Order::Side::SELL, 2, 100, 10));
+    Printer::print(engine.process(makeOrder(Order::Side::BUY, 3, 100, 10)));
+    EXPECT_EQ(buffer.str(), "3,1,100,10\n");
+    buffer.str("");
+
+    EXPECT_TRUE(engine.cancel(1));
+    Printer::print(engine);
+    EXPECT_EQ(buffer.str(),
+    "+-----------------------------------------------------------------+\n"
+    "| BUY                            | SELL                           |\n"
+    "| Id       | Volume      | Price | Price | Volume      | Id       |\n"
+    "+----------+-------------+-------+-------+-------------+----------+\n"
+    "|          |             |       |    100|           10|         2|\n"
+    "+-----------------------------------------------------------------+\n"
+    );
+}
+
+
+TEST_F(MatchingEngineFixture, AmendOrder) {
+    engine.process(makeOrder(Order::Side::SELL, 1, 100, 10));
+    engine.process(makeOrder(Order::Side::SELL, 2, 100, 20));
+    engine.process(makeOrder(Order::Side::SELL, 3, 101, 30));
+
+    // Lowering the quantity keeps time priority
+    Printer::print(engine.amend(1, 100, 5));
+    // Raising the quantity loses it
+    Printer::print(engine.amend(2, 100, 25));
+    Printer::print(engine.amend(42, 100, 25));
+    Printer::print(engine);
+    EXPECT_EQ(buffer.str(),
+    "+-----------------------------------------------------------------+\n"
+    "| BUY                            | SELL                           |\n"
+    "| Id       | Volume      | Price | Price | Volume      | Id       |\n"
+    "+----------+-------------+-------+-------+-------------+----------+\n"
+    "|          |             |       |    100|            5|         1|\n"
+    "|          |             |       |    100|           25|         2|\n"
+    "|          |             |       |    101|           30|         3|\n"
+    "+-----------------------------------------------------------------+\n"
+    );
+    buffer.str("");
+
+    engine.process(makeOrder(Order::Side::BUY, 4, 99, 15));
+    // Changing the price re-enters the order, which may trade
+    Printer::print(engine.amend(3, 99, 30));
+    Printer::print(engine.amend(1, 100, 0));
+    Printer::print(engine);
+    EXPECT_EQ(buffer.str(),
+    "4,3,99,15\n"
+    "+-----------------------------------------------------------------+\n"
+    "| BUY                            | SELL                           |\n"
+    "| Id       | Volume      | Price | Price | Volume      | Id       |\n"
+    "+----------+-------------+-------+-------+-------------+----------+\n"
+    "|          |             |       |     99|           15|         3|\n"
+    "|          |             |       |    100|           25|         2|\n"
+    "+-----------------------------------------------------------------+\n"
+    );
+}
+
+
+Order withTif(Order order, Order::TimeInForce tif) {
+    order.tif = tif;
+    return order;
+}
+
+TEST_F(MatchingEngineFixture, ImmediateOrCancel) {
+    engine.process(makeOrder(Order::Side::SELL, 1, 100, 10));
+    engine.process(makeOrder(Order::Side::SELL, 2, 101, 10));
+
+    // The remainder is dropped instead of resting at 100
+    Printer::print(engine.process(
+        withTif(makeOrder(Order::Side::BUY, 3, 100, 25), Order::TimeInForce::IOC)));
+    EXPECT_FALSE(engine.contains(3));
+    Printer::print(engine);
+    EXPECT_EQ(buffer.str(),
+    "3,1,100,10\n"
+    "+-----------------------------------------------------------------+\n"
+    "| BUY                            | SELL                           |\n"
+    "| Id       | Volume      | Price | Price | Volume      | Id       |\n"
+    "+----------+-------------+-------+-------+-------------+----------+\n"
+    "|          |             |       |    101|           10|         2|\n"
+    "+-----------------------------------------------------------------+\n"
+    );
+}
+
+
+TEST_F(MatchingEngineFixture, FillOrKill) {
+    engine.process(makeOrder(Order::Side::SELL, 1, 100, 10, 5));
+    engine.process(makeOrder(Order::Side::SELL, 2, 101, 10));
+    engine.process(makeOrder(Order::Side::SELL, 3, 102, 10));
+
+    // 20 can fill up to 101, hidden quantity included, but not 25
+    EXPECT_TRUE(engine.process(
+        withTif(makeOrder(Order::Side::BUY, 4, 101, 25), Order::TimeInForce::FOK)).empty());
+    EXPECT_FALSE(engine.contains(4));
+    EXPECT_EQ(engine.depthAt(Order::Side::SELL, 100).hidden_qty, 5);
+
+    Printer::print(engine.process(
+        withTif(makeOrder(Order::Side::BUY, 5, 101, 20), Order::TimeInForce::FOK)));
+    Printer::print(engine);
+    EXPECT_EQ(buffer.str(),
+    "5,1,100,10\n"
+    "5,2,101,10\n"
+    "+-----------------------------------------------------------------+\n"
+    "| BUY                            | SELL                           |\n"
+    "| Id       | Volume      | Price | Price | Volume      | Id       |\n"
+    "+----------+-------------+-------+-------+-------------+----------+\n"
+    "|          |             |       |    102|           10|         3|\n"
+    "+-----------------------------------------------------------------+\n"
+    );
+}
+
+
+TEST_F(MatchingEngineFixture, MarketOrder) {
+    engine.process(makeOrder(Order::Side::BUY, 1, 100, 10));
+    engine.process(makeOrder(Order::Side::BUY, 2, -500, 10));
+
+    // The price is ignored, and what's left after the book runs dry doesn't rest
+    auto market = makeOrder(Order::Side::SELL, 3, 30000, 25);
+    market.type = Order::Type::MARKET;
+    Printer::print(engine.process(market));
+    EXPECT_FALSE(engine.contains(3));
+    EXPECT_EQ(engine.bestBid().order_count, 0u);
+    EXPECT_EQ(engine.bestAsk().order_count, 0u);
+    EXPECT_EQ(buffer.str(),
+    "1,3,100,10\n"
+    "2,3,-500,10\n"
+    );
+}
+
+
+TEST_F(MatchingEngineFixture, PostOnly) {
+    engine.process(makeOrder(Order::Side::SELL, 1, 100, 10));
+
+    EXPECT_TRUE(engine.process(
+        withTif(makeOrder(Order::Side::BUY, 2, 100, 10), Order::TimeInForce::POST_ONLY)).empty());
+    EXPECT_FALSE(engine.contains(2));
+    EXPECT_TRUE(engine.process(
+        withTif(makeOrder(Order::Side::BUY, 3, 99, 10), Order::TimeInForce::POST_ONLY)).empty());
+    EXPECT_TRUE(engine.contains(3));
+
+    // Re-entering at a crossing price drops it rather than trading
+    EXPECT_TRUE(engine.amend(3, 100, 10).empty());
+    EXPECT_FALSE(engine.contains(3));
+    EXPECT_EQ(engine.bestAsk().visible_qty, 10);
+}
+
+
+TEST(TimeInForceTest, FillOrKillIsAllOrNothing) {
+    MatchingEngine engine;
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> price_dist(90, 110);
+    std::uniform_int_distribution<int> qty_dist(1, 100);
+    for (OrderId id = 1; id <= 5000; ++id) {
+        auto side = (id % 2) ? Order::Side::BUY : Order::Side::SELL;
+        auto qty = qty_dist(gen) * ((id % 5) ? 1 : 10);
+        auto order = makeOrder(side, id, static_cast<Price>(price_dist(gen)), qty,
+            (id % 3) ? 0 : qty_dist(gen));
+        if (id % 5 == 0)
+            order.tif = Order::TimeInForce::FOK;
+
+        Quantity traded_qty = 0;
+        for (const auto& trade : engine.process(order))
+            traded_qty += trade.qty;
+        if (order.tif == Order::TimeInForce::FOK) {
+            EXPECT_TRUE(traded_qty == 0 || traded_qty == qty);
+            EXPECT_FALSE(engine.contains(id));
+        }
+    }
+}
+
+Order makeStop(Order::Side side, OrderId id, Price stop_price, Quantity qty, Price limit_price = 0) {
+    auto order = makeOrder(side, id, limit_price, qty);
+    order.type = limit_price ? Order::Type::STOP_LIMIT : Order::Type::STOP;
+    order.stop_price = stop_price;
+    return order;
+}
+
+TEST_F(MatchingEngineFixture, StopCascade) {
+    for (OrderId id = 1; id <= 4; ++id)
+        engine.process(makeOrder(Order::Side::SELL, id, static_cast<Price>(99 + id), 10));
+    engine.process(makeOrder(Order::Side::BUY, 5, 95, 10));
+    engine.process(makeStop(Order::Side::BUY, 6, 101, 10));
+    engine.process(makeStop(Order::Side::BUY, 7, 102, 15, 102));
+    EXPECT_EQ(engine.stopCount(), 2u);
+
+    // A trade short of both stop prices fires nothing
+    Printer::print(engine.process(makeOrder(Order::Side::BUY, 8, 100, 10)));
+    EXPECT_EQ(engine.stopCount(), 2u);
+    // Trading at 101 fires the stop market order, whose own trade at 102 fires the
+    // stop-limit order, all within the one message
+    Printer::print(engine.process(makeOrder(Order::Side::BUY, 9, 101, 5)));
+    EXPECT_EQ(engine.stopCount(), 0u);
+    Printer::print(engine);
+    EXPECT_EQ(buffer.str(),
+    "8,1,100,10\n"
+    "9,2,101,5\n"
+    "6,2,101,5\n"
+    "6,3,102,5\n"
+    "7,3,102,5\n"
+    "+-----------------------------------------------------------------+\n"
+    "| BUY                            | SELL                           |\n"
+    "| Id       | Volume      | Price | Price | Volume      | Id       |\n"
+    "+----------+-------------+-------+-------+-------------+----------+\n"
+    "|         7|           10|    102|    103|           10|         4|\n"
+    "|         5|           10|     95|       |             |          |\n"
+    "+-----------------------------------------------------------------+\n"
+    );
+    buffer.str("");
+
+    // A stop the last trade has already passed enters at once
+    Printer::print(engine.process(makeStop(Order::Side::SELL, 10, 103, 10)));
+    EXPECT_EQ(buffer.str(), "7,10,102,10\n");
+
+    engine.process(makeStop(Order::Side::SELL, 11, 90, 10));
+    EXPECT_EQ(engine.stopCount(), 1u);
+    EXPECT_TRUE(engine.cancel(11));
+    EXPECT_FALSE(engine.cancel(11));
+    EXPECT_EQ(engine.stopCount(), 0u);
+}
+
+TEST_F(MatchingEngineFixture, RejectsDuplicateStopIds) {
+    engine.process(makeOrder(Order::Side::SELL, 1, 100, 10));
+    engine.process(makeStop(Order::Side::BUY, 2, 110, 10));
+
+    // A stop may not reuse a resting or a waiting id, nor an order a waiting one
+    engine.process(makeStop(Order::Side::SELL, 1, 90, 10));
+    engine.process(makeStop(Order::Side::BUY, 2, 120, 10));
+    EXPECT_TRUE(engine.process(makeOrder(Order::Side::BUY, 2, 100, 5)).empty());
+    EXPECT_EQ(engine.stopCount(), 1u);
+    EXPECT_EQ(engine.orderCount(), 1u);
+
+    // Cancelling the id removes the one stop that waits under it
+    EXPECT_TRUE(engine.cancel(2));
+    EXPECT_FALSE(engine.cancel(2));
+    EXPECT_EQ(engine.stopCount(), 0u);
+}
+
+
+TEST_F(MatchingEngineFixture, FiredStopsTradeSeparately) {
+    engine.process(makeOrder(Order::Side::SELL, 1, 100, 30, 10));
+    engine.process(makeStop(Order::Side::BUY, 2, 100, 10));
+    engine.process(makeStop(Order::Side::BUY, 3, 100, 10));
+
+    // Each order of the cascade gets its own trade with the refilled iceberg
+    Printer::print(engine.process(makeOrder(Order::Side::BUY, 4, 100, 10)));
+    EXPECT_EQ(buffer.str(),
+    "4,1,100,10\n"
+    "2,1,100,10\n"
+    "3,1,100,10\n"
+    );
+}
+
+template <class Engine>
+std::string runRandomFlow(Engine& engine, unsigned seed, int order_count) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> side_dist(0, 1);
+    std::uniform_int_distribution<int> price_dist(90, 110);
+    std::uniform_int_distribution<int> qty_dist(1, 100);
+    std::uniform_int_distribution<int> action_dist(0, 9);
+    // Half the orders keep GTC, the rest spread over every time in force
+    std::uniform_int_distribution<int> tif_dist(0, 7);
+
+    std::stringstream output;
+    for (OrderId id = 1; id <= order_count; ++id) {
+        auto action = action_dist(gen);
+        if (action == 0) {
+            engine.cancel(static_cast<OrderId>(gen() % id));
+            continue;
+        }
+        if (action == 1) {
+            Printer::print(engine.amend(static_cast<OrderId>(gen() % id),
+                static_cast<Price>(price_dist(gen)), qty_dist(gen)), output);
+            continue;
+        }
+
+        auto side = side_dist(gen) ? Order::Side::BUY : Order::Side::SELL;
+        auto price = static_cast<Price>(price_dist(gen));
+        auto qty = qty_dist(gen) * 10;
+        auto peak = (action < 4) ? qty_dist(gen) : 0;
+        auto order = makeOrder(side, id, price, qty, peak);
+        if (action == 4)
+            order.type = Order::Type::MARKET;
+        if (action == 5) {
+            order.type = (gen() % 2) ? Order::Type::STOP : Order::Type::STOP_LIMIT;
+            order.stop_price = static_cast<Price>(price_dist(gen));
+        }
+        if (auto tif = tif_dist(gen); tif < 4)
+            order.tif = static_cast<Order::TimeInForce>(tif);
+        Printer::print(engine.process(order), output);
+        Printer::print(engine, output);
+    }
+    return output.str();
+}
+
+
+TEST(PriceLadderTest, MatchesLevelMap) {
+    for (unsigned seed = 0; seed < 3; ++seed) {
+        MatchingEngine map_engine;
+        LadderMatchingEngine ladder_engine;
+        EXPECT_EQ(runRandomFlow(map_engine, seed, 1000), runRandomFlow(ladder_engine, seed, 1000));
+    }
+}
+
+
+TEST(PriceLadderTest, ExtremePrices) {
+    constexpr auto MIN_PRICE = std::numeric_limits<Price>::min();
+    constexpr auto MAX_PRICE = std::numeric_limits<Price>::max();
+
+    LadderMatchingEngine engine;
+    engine.process(makeOrder(Order::Side::BUY, 1, MIN_PRICE, 10));
+    engine.process(makeOrder(Order::Side::BUY, 2, 0, 10));
+    engine.process(makeOrder(Order::Side::SELL, 3, MAX_PRICE, 10));
+    engine.process(makeOrder(Order::Side::SELL, 4, 1, 10));
+
+    std::stringstream output;
+    Printer::print(engine.process(makeOrder(Order::Side::SELL, 5, MIN_PRICE, 30)), output);
+    Printer::print(engine.process(makeOrder(Order::Side::BUY, 6, MAX_PRICE, 30)), output);
+    Printer::print(engine, output);
+    EXPECT_EQ(output.str(),
+    "2,5,0,10\n"
+    "1,5,-32768,10\n"
+    "6,5,-32768,10\n"
+    "6,4,1,10\n"
+    "6,3,32767,10\n"
+    "+-----------------------------------------------------------------+\n"
+    "| BUY                            | SELL                           |\n"
+    "| Id       | Volume      | Price | Price | Volume      | Id       |\n"
+    "+----------+-------------+-------+-------+-------------+----------+\n"
+    "+-----------------------------------------------------------------+\n"
+    );
+}
+
+
+TEST(RingPriceLevelTest, MatchesLinkedLevels) {
+    using RingLadderMatchingEngine = BasicMatchingEngine<
+        BookConfig<PriceLadder, std::allocator, NullStats, DefaultOrderTraits, RingPriceLevel>>;
+    for (unsigned seed = 0; seed < 3; ++seed) {
+        MatchingEngine linked_engine;
+        RingMatchingEngine ring_engine;
+        RingLadderMatchingEngine ring_ladder_engine;
+        auto expected = runRandomFlow(linked_engine, seed, 1000);
+        EXPECT_EQ(runRandomFlow(ring_engine, seed, 1000), expected);
+        EXPECT_EQ(runRandomFlow(ring_ladder_engine, seed, 1000), expected);
+    }
+}
+
+
+TEST(RingPriceLevelTest, TombstonesAndGrowth) {
+    using Level = RingPriceLevel<std::allocator<OrderNode>>;
+    std::allocator<OrderNode> alloc;
+    Level level(100, alloc);
+
+    // Positions taken before the buffer grows still find their orders after
+    std::vector<Level::Handle> handles;
+    for (OrderId id = 1; id <= 20; ++id)
+        handles.push_back(level.pushBack(makeOrder(Order::Side::SELL, id, 100, id)));
+    EXPECT_EQ(level.node(handles[9]).id, 10);
+
+    for (size_t idx = 1; idx < 20; idx += 2)
+        level.erase(handles[idx]);
+    EXPECT_EQ(level.orderCount(), 10);
+    EXPECT_EQ(level.visibleQty(), 100);
+
+    std::vector<OrderId> ids;
+    for (const auto& node : level)
+        ids.push_back(node.id);
+    EXPECT_EQ(ids, (std::vector<OrderId>{1, 3, 5, 7, 9, 11, 13, 15, 17, 19}));
+
+    // Popping the front skips the tombstone behind it
+    level.popFront();
+    EXPECT_EQ(level.front().id, 3);
+
+    // A rotated order moves to a new position behind the last one
+    auto rotated = level.rotateFront();
+    EXPECT_EQ(level.node(rotated).id, 3);
+    EXPECT_EQ(level.front().id, 5);
+
+    while (!level.empty())
+        level.popFront();
+    EXPECT_EQ(level.visibleQty(), 0);
+    EXPECT_EQ(level.begin(), level.end());
+}
+
+TEST(RingPriceLevelTest, PacksTombstonesBetweenLiveOrders) {
+    using Level = RingPriceLevel<std::allocator<OrderNode>>;
+    std::allocator<OrderNode> alloc;
+    Level level(100, alloc);
+
+    // The front order stays while the ones behind it come and go, each cancelled
+    // once the next one arrived, so its tombstone never reaches either end
+    std::deque<Level::Handle> handles;
+    auto push = [&](OrderId id) {
+        handles.push_back(level.pushBack(makeOrder(Order::Side::SELL, id, 100, 10)));
+        level.trackHandle(handles.back());
+    };
+    push(1);
+    push(2);
+    for (OrderId id = 3; id <= 10000; ++id) {
+        push(id);
+        level.erase(handles[handles.size() - 2]);
+    }
+    EXPECT_EQ(level.orderCount(), 2);
+    EXPECT_LE(level.capacity(), Level::INITIAL_CAPACITY);
+
+    // The tracked handles followed their orders as they were packed
+    EXPECT_EQ(level.node(handles.front()).id, 1);
+    EXPECT_EQ(level.node(handles.back()).id, 10000);
+    std::vector<OrderId> ids;
+    for (const auto& node : level)
+        ids.push_back(node.id);
+    EXPECT_EQ(ids, (std::vector<OrderId>{1, 10000}));
+}
+
+WideMatchingEngine::Order widen(const Order& order) {
+    return WideMatchingEngine::Order{
+        .side = order.side,
+        .type = order.type,
+        .id = static_cast<WideMatchingEngine::OrderId>(order.id),
+        .price = order.price,
+        .visible_qty = order.visible_qty,
+        .peak_qty = order.peak_qty,
+        .hidden_qty = order.hidden_qty
+    };
+}
+
+TEST(WideLayoutTest, MatchesNarrowLayout) {
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> side_dist(0, 1);
+    std::uniform_int_distribution<int> price_dist(90, 110);
+    std::uniform_int_distribution<int> qty_dist(1, 100);
+
+    MatchingEngine narrow_engine;
+    WideMatchingEngine wide_engine;
+    std::stringstream narrow_output, wide_output;
+    for (OrderId id = 1; id <= 1000; ++id) {
+        auto side = side_dist(gen) ? Order::Side::BUY : Order::Side::SELL;
+        auto order = makeOrder(side, id, static_cast<Price>(price_dist(gen)),
+            qty_dist(gen) * 10, (id % 3 == 0) ? qty_dist(gen) : 0);
+        Printer::print(narrow_engine.process(order), narrow_output);
+        Printer::print(wide_engine.process(widen(order)), wide_output);
+    }
+    Printer::print(narrow_engine, narrow_output);
+    Printer::print(wide_engine, wide_output);
+    EXPECT_EQ(wide_output.str(), narrow_output.str());
+}
+
+TEST(WideLayoutTest, HoldsValuesBeyondTheNarrowLayout) {
+    using WideOrder = WideMatchingEngine::Order;
+    constexpr WideMatchingEngine::OrderId BIG_ID = 1ull << 40;
+    constexpr WideMatchingEngine::Price HIGH_PRICE = 5'000'000;
+    constexpr WideMatchingEngine::Quantity BIG_QTY = 10'000'000'000;
+
+    WideMatchingEngine engine;
+    auto resting = WideOrder{.side = Order::Side::SELL, .type = Order::Type::ICEBERG,
+        .id = BIG_ID, .price = HIGH_PRICE, .visible_qty = BIG_QTY, .peak_qty = BIG_QTY,
+        .hidden_qty = 2 * BIG_QTY};
+    EXPECT_TRUE(engine.process(resting).empty());
+    EXPECT_EQ(engine.depthAt(Order::Side::SELL, HIGH_PRICE).hidden_qty, 2 * BIG_QTY);
+
+    auto aggressive = WideOrder{.side = Order::Side::BUY, .type = Order::Type::LIMIT,
+        .id = BIG_ID + 1, .price = HIGH_PRICE + 1, .visible_qty = 2 * BIG_QTY,
+        .peak_qty = 2 * BIG_QTY, .hidden_qty = 0};
+    const auto& trades = engine.process(aggressive);
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_EQ(trades[0].buy_id, BIG_ID + 1);
+    EXPECT_EQ(trades[0].sell_id, BIG_ID);
+    EXPECT_EQ(trades[0].price, HIGH_PRICE);
+    EXPECT_EQ(trades[0].qty, 2 * BIG_QTY);
+    EXPECT_EQ(engine.bestAsk().visible_qty, BIG_QTY);
+    EXPECT_EQ(engine.bestBid().order_count, 0);
+
+    std::stringstream output;
+    Printer::print(trades, output);
+    EXPECT_EQ(output.str(), "1099511627777,1099511627776,5000000,20000000000\n");
+}
+
+
+template <class Engine>
+void expectRenderMatchesPrint(const Engine& engine, std::vector<char>& buffer) {
+    std::ostringstream printed;
+    Printer::print(engine, printed);
+    std::ostringstream rendered;
+    Printer::printFast(engine, buffer, rendered);
+    ASSERT_EQ(rendered.str(), printed.str());
+}
+
+TEST(FastRendererTest, MatchesPrint) {
+    // Starting empty makes the buffer grow while rendering
+    std::vector<char> buffer;
+    MatchingEngine engine;
+    expectRenderMatchesPrint(engine, buffer);
+
+    // Grouping at every digit count, a negative price and fields wider than their
+    // columns, which push the row over just as setw does
+    std::vector<Order> orders{
+        makeOrder(Order::Side::BUY, 1, -32768, 1),
+        makeOrder(Order::Side::BUY, 22, -5, 12),
+        makeOrder(Order::Side::BUY, 2147483647, 999, 123),
+        makeOrder(Order::Side::BUY, 4444, 1000, 1234),
+        makeOrder(Order::Side::BUY, 55555, 32767, 2147483647),
+        makeOrder(Order::Side::SELL, 6, 32767, 123456789, 1234567),
+        makeOrder(Order::Side::BUY, -7, 0, 12345)
+    };
+    for (const auto& order : orders) {
+        engine.process(order);
+        expectRenderMatchesPrint(engine, buffer);
+    }
+
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> price_dist(-1100, 1100);
+    std::uniform_int_distribution<int> qty_dist(1, 1'000'000);
+    for (OrderId id = 100; id < 3000; ++id) {
+        auto side = (id % 2) ? Order::Side::BUY : Order::Side::SELL;
+        engine.process(makeOrder(side, id, static_cast<Price>(price_dist(gen)), qty_dist(gen),
+            (id % 3) ? 0 : qty_dist(gen)));
+    }
+    expectRenderMatchesPrint(engine, buffer);
+
+    WideMatchingEngine wide_engine;
+    wide_engine.process(WideMatchingEngine::Order{.side = Order::Side::SELL,
+        .type = Order::Type::LIMIT, .id = std::numeric_limits<uint64_t>::max(),
+        .price = std::numeric_limits<int32_t>::min(),
+        .visible_qty = std::numeric_limits<int64_t>::max(),
+        .peak_qty = std::numeric_limits<int64_t>::max(), .hidden_qty = 0});
+    expectRenderMatchesPrint(wide_engine, buffer);
+}
+
+TEST(OutputThreadTest, MatchesSynchronousPrint) {
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> price_dist(95, 105);
+    std::uniform_int_distribution<int> qty_dist(1, 1'000'000);
+
+    MatchingEngine engine;
+    engine.trackDeltas(true);
+    std::ostringstream expected;
+    std::ostringstream actual;
+    {
+        // A ring much smaller than a book, so publishing waits on the output thread
+        BasicOutputThread<DefaultOrderTraits, 64> output(actual);
+        for (OrderId id = 1; id <= 2000; ++id) {
+            auto side = (gen() % 2) ? Order::Side::BUY : Order::Side::SELL;
+            auto qty = qty_dist(gen);
+            const auto& trades = engine.process(makeOrder(side, id,
+                static_cast<Price>(price_dist(gen)), qty, (id % 3) ? 0 : qty / 4 + 1));
+            Printer::print(trades, expected);
+            output.publishTrades(trades);
+            Printer::print(engine.deltas(), expected);
+            output.publishDeltas(engine.deltas());
+            if (id % 50 == 0) {
+                Printer::print(engine, expected);
+                EXPECT_TRUE(output.publishBook(engine));
+            }
+        }
+    }
+    EXPECT_EQ(actual.str(), expected.str());
+}
+
+TEST(OutputThreadTest, DropsBooksButKeepsTrades) {
+    MatchingEngine engine;
+    for (OrderId id = 1; id <= 32; ++id)
+        engine.process(makeOrder(Order::Side::SELL, id, static_cast<Price>(100 + id), 10));
+
+    std::ostringstream expected;
+    std::ostringstream actual;
+    {
+        // The book never fits in the ring, so every dump is skipped
+        BasicOutputThread<DefaultOrderTraits, 16> output(actual, BackpressurePolicy::DROP_BOOKS);
+        for (OrderId id = 100; id < 116; ++id) {
+            const auto& trades = engine.process(makeOrder(Order::Side::BUY, id, 200, 5));
+            Printer::print(trades, expected);
+            output.publishTrades(trades);
+            EXPECT_FALSE(output.publishBook(engine));
+        }
+        EXPECT_EQ(output.oversizedBooks(), 16);
+        EXPECT_EQ(output.droppedBooks(), 0);
+    }
+    EXPECT_EQ(actual.str(), expected.str());
+}
+
+TEST(OutputThreadTest, BooksFitByTheirDeeperSide) {
+    // 24 orders, but the dump is only 12 rows, one per depth
+    MatchingEngine engine;
+    for (OrderId id = 1; id <= 12; ++id) {
+        engine.process(makeOrder(Order::Side::BUY, id, static_cast<Price>(100 - id), 10));
+        engine.process(makeOrder(Order::Side::SELL, id + 100, static_cast<Price>(100 + id), 10));
+    }
+
+    std::ostringstream expected;
+    Printer::print(engine, expected);
+    std::ostringstream actual;
+    {
+        BasicOutputThread<DefaultOrderTraits, 16> output(actual, BackpressurePolicy::DROP_BOOKS);
+        EXPECT_TRUE(output.publishBook(engine));
+    }
+    EXPECT_EQ(actual.str(), expected.str());
+}
+
+TEST(PoolAllocatorTest, GrowsAndReusesSlots) {
+    MatchingEngine engine(4);
+    EXPECT_EQ(engine.nodeAllocator().stats().capacity, 4);
+
+    for (OrderId id = 1; id <= 10; ++id)
+        engine.process(makeOrder(Order::Side::BUY, id, static_cast<Price>(100 + id % 3), 10));
+
+    auto stats = engine.nodeAllocator().stats();
+    EXPECT_EQ(stats.in_use, 10);
+    EXPECT_EQ(stats.high_water_mark, 10);
+    EXPECT_EQ(stats.capacity, 16);
+    EXPECT_EQ(stats.slab_growths, 2);
+
+    std::stringstream output;
+    Printer::print(engine.process(makeOrder(Order::Side::SELL, 11, 100, 95)), output);
+    for (OrderId id = 12; id <= 20; ++id)
+        engine.process(makeOrder(Order::Side::SELL, id, 200, 10));
+
+    stats = engine.nodeAllocator().stats();
+    EXPECT_EQ(stats.in_use, 10);
+    EXPECT_EQ(stats.high_water_mark, 10);
+    EXPECT_EQ(stats.slab_growths, 2);
+}
+
+
+TEST_F(MatchingEngineFixture, IcebergRefillKeepsNode) {
+    engine.process(makeOrder(Order::Side::SELL, 1, 100, 100000, 10));
+    engine.process(makeOrder(Order::Side::SELL, 2, 100, 5));
+    Printer::print(engine.process(makeOrder(Order::Side::BUY, 3, 100, 99995)));
+    EXPECT_EQ(buffer.str(),
+    "3,1,100,99990\n"
+    "3,2,100,5\n");
+    buffer.str("");
+
+    EXPECT_EQ(engine.nodeAllocator().stats().high_water_mark, 2);
+    Printer::print(engine);
+    EXPECT_EQ(buffer.str(),
+    "+-----------------------------------------------------------------+\n"
+    "| BUY                            | SELL                           |\n"
+    "| Id       | Volume      | Price | Price | Volume      | Id       |\n"
+    "+----------+-------------+-------+-------+-------------+----------+\n"
+    "|          |             |       |    100|           10|         1|\n"
+    "+-----------------------------------------------------------------+\n"
+    );
+}
+
+
+TEST_F(MatchingEngineFixture, LevelDeltas) {
+    engine.trackDeltas(true);
+
+    engine.process(makeOrder(Order::Side::SELL, 1, 100, 50, 10));
+    Printer::print(engine.deltas());
+    engine.process(makeOrder(Order::Side::SELL, 2, 100, 10));
+    Printer::print(engine.deltas());
+    engine.process(makeOrder(Order::Side::SELL, 3, 101, 5));
+    Printer::print(engine.deltas());
+    EXPECT_EQ(buffer.str(),
+    "S,100,10,1\n"
+    "S,100,20,2\n"
+    "S,101,5,1\n"
+    );
+    buffer.str("");
+
+    Printer::print(engine.process(makeOrder(Order::Side::BUY, 4, 101, 70)));
+    Printer::print(engine.deltas());
+    EXPECT_EQ(buffer.str(),
+    "4,1,100,50\n"
+    "4,2,100,10\n"
+    "4,3,101,5\n"
+    "S,100,0,0\n"
+    "S,101,0,0\n"
+    "B,101,5,1\n"
+    );
+    buffer.str("");
+
+    engine.amend(4, 101, 3);
+    Printer::print(engine.deltas());
+    engine.cancel(4);
+    Printer::print(engine.deltas());
+    EXPECT_EQ(buffer.str(),
+    "B,101,3,1\n"
+    "B,101,0,0\n"
+    );
+}
+
+
+TEST(LevelDeltaTest, ReplayRebuildsBook) {
+    using Level = std::pair<Quantity, uint32_t>;
+    using Book = std::map<std::pair<Order::Side, Price>, Level>;
+
+    auto aggregate = [](const MatchingEngine& engine) {
+        Book book;
+        for (auto iter = engine.buyBegin(); iter != engine.buyEnd(); ++iter) {
+            auto& [qty, count] = book[{Order::Side::BUY, iter->price}];
+            qty += iter->visible_qty;
+            ++count;
+        }
+        for (auto iter = engine.sellBegin(); iter != engine.sellEnd(); ++iter) {
+            auto& [qty, count] = book[{Order::Side::SELL, iter->price}];
+            qty += iter->visible_qty;
+            ++count;
+        }
+        return book;
+    };
+
+    MatchingEngine engine;
+    engine.trackDeltas(true);
+    Book replayed;
+    auto apply = [&replayed](const std::vector<LevelDelta>& deltas) {
+        for (const auto& delta : deltas) {
+            if (delta.order_count)
+                replayed[{delta.side, delta.price}] = {delta.qty, delta.order_count};
+            else
+                replayed.erase({delta.side, delta.price});
+        }
+    };
+
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> price_dist(95, 105);
+    std::uniform_int_distribution<int> qty_dist(1, 50);
+    for (OrderId id = 1; id <= 3000; ++id) {
+        switch (gen() % 6) {
+        case 0:
+            engine.cancel(static_cast<OrderId>(gen() % id));
+            break;
+        case 1:
+            engine.amend(static_cast<OrderId>(gen() % id),
+                static_cast<Price>(price_dist(gen)), qty_dist(gen));
+            break;
+        default:
+            engine.process(makeOrder(gen() % 2 ? Order::Side::BUY : Order::Side::SELL, id,
+                static_cast<Price>(price_dist(gen)), qty_dist(gen) * 4, (id % 3) ? 0 : 10));
+        }
+        apply(engine.deltas());
+        ASSERT_EQ(replayed, aggregate(engine));
+    }
+}
+
+
+TEST_F(MatchingEngineFixture, DepthQueries) {
+    engine.process(makeOrder(Order::Side::BUY, 1, 100, 30));
+    engine.process(makeOrder(Order::Side::BUY, 2, 100, 50, 20));
+    engine.process(makeOrder(Order::Side::BUY, 3, 99, 10));
+    engine.process(makeOrder(Order::Side::BUY, 4, 98, 5));
+    engine.process(makeOrder(Order::Side::SELL, 5, 100, 40));
+
+    auto depth = engine.depthAt(Order::Side::BUY, 100);
+    EXPECT_EQ(depth.visible_qty, 10);
+    EXPECT_EQ(depth.hidden_qty, 30);
+    EXPECT_EQ(depth.order_count, 1u);
+    EXPECT_EQ(engine.depthAt(Order::Side::SELL, 100).order_count, 0u);
+
+    auto top = engine.topN(Order::Side::BUY, 2);
+    ASSERT_EQ(top.size(), 2u);
+    EXPECT_EQ(top[0].price, 100);
+    EXPECT_EQ(top[1].price, 99);
+    EXPECT_EQ(top[1].visible_qty, 10);
+    EXPECT_EQ(engine.topN(Order::Side::BUY, 10).size(), 3u);
+    EXPECT_TRUE(engine.topN(Order::Side::SELL, 10).empty());
+
+    engine.amend(3, 99, 4);
+    EXPECT_EQ(engine.depthAt(Order::Side::BUY, 99).visible_qty, 4);
+    engine.cancel(2);
+    EXPECT_EQ(engine.topN(Order::Side::BUY, 1)[0].price, 99);
+}
+
+
+template <class Iterator>
+std::vector<LevelDepth> sumLevels(Iterator begin, Iterator end) {
+    std::vector<LevelDepth> levels;
+    for (auto iter = begin; iter != end; ++iter) {
+        if (levels.empty() || levels.back().price != iter->price)
+            levels.push_back(LevelDepth{
+                .price = iter->price, .visible_qty = 0, .hidden_qty = 0, .order_count = 0});
+        levels.back().visible_qty += iter->visible_qty;
+        levels.back().hidden_qty += iter->hidden_qty;
+        ++levels.back().order_count;
+    }
+    return levels;
+}
+
+template <class Engine>
+void expectTotalsMatchOrders(const Engine& engine) {
+    for (auto side : {Order::Side::BUY, Order::Side::SELL}) {
+        auto walked = (side == Order::Side::BUY)
+            ? sumLevels(engine.buyBegin(), engine.buyEnd())
+            : sumLevels(engine.sellBegin(), engine.sellEnd());
+
+        auto top = engine.topN(side, walked.size() + 1);
+        ASSERT_EQ(top.size(), walked.size());
+        for (size_t idx = 0; idx < top.size(); ++idx) {
+            EXPECT_EQ(top[idx].price, walked[idx].price);
+            EXPECT_EQ(top[idx].visible_qty, walked[idx].visible_qty);
+            EXPECT_EQ(top[idx].hidden_qty, walked[idx].hidden_qty);
+            EXPECT_EQ(top[idx].order_count, walked[idx].order_count);
+        }
+    }
+}
+
+TEST(DepthTest, TotalsMatchOrderWalk) {
+    MatchingEngine map_engine;
+    LadderMatchingEngine ladder_engine;
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> price_dist(95, 105);
+    std::uniform_int_distribution<int> qty_dist(1, 50);
+    for (OrderId id = 1; id <= 3000; ++id) {
+        auto kind = gen() % 6;
+        auto target = static_cast<OrderId>(gen() % id);
+        auto side = gen() % 2 ? Order::Side::BUY : Order::Side::SELL;
+        auto price = static_cast<Price>(price_dist(gen));
+        auto qty = qty_dist(gen);
+        auto order = makeOrder(side, id, price, qty * 4, (id % 3) ? 0 : 10);
+        if (kind == 0) {
+            map_engine.cancel(target);
+            ladder_engine.cancel(target);
+        } else if (kind == 1) {
+            map_engine.amend(target, price, qty);
+            ladder_engine.amend(target, price, qty);
+        } else {
+            map_engine.process(order);
+            ladder_engine.process(order);
+        }
+        expectTotalsMatchOrders(map_engine);
+        expectTotalsMatchOrders(ladder_engine);
+    }
+}
+
+
+TEST_F(MatchingEngineFixture, CachedTopOfBook) {
+    EXPECT_EQ(engine.bestBid().order_count, 0u);
+    EXPECT_EQ(engine.bestAsk().order_count, 0u);
+
+    engine.process(makeOrder(Order::Side::BUY, 1, 99, 10));
+    engine.process(makeOrder(Order::Side::BUY, 2, 100, 20));
+    engine.process(makeOrder(Order::Side::SELL, 3, 102, 30));
+    engine.process(makeOrder(Order::Side::SELL, 4, 101, 40));
+    EXPECT_EQ(engine.bestBid().price, 100);
+    EXPECT_EQ(engine.bestBid().visible_qty, 20);
+    EXPECT_EQ(engine.bestAsk().price, 101);
+
+    // Removing a level behind the best keeps the cache, removing the best moves it
+    engine.cancel(3);
+    EXPECT_EQ(engine.bestAsk().price, 101);
+    engine.cancel(2);
+    EXPECT_EQ(engine.bestBid().price, 99);
+
+    EXPECT_TRUE(engine.process(makeOrder(Order::Side::SELL, 5, 100, 5)).empty());
+    EXPECT_EQ(engine.bestAsk().price, 100);
+    engine.process(makeOrder(Order::Side::BUY, 6, 100, 5));
+    EXPECT_EQ(engine.bestAsk().price, 101);
+    engine.process(makeOrder(Order::Side::BUY, 7, 101, 40));
+    EXPECT_EQ(engine.bestAsk().order_count, 0u);
+}
+
+
+TEST(TopOfBookTest, CrossesAtPriceLimits) {
+    for (auto price : {std::numeric_limits<Price>::min(), std::numeric_limits<Price>::max()}) {
+        MatchingEngine engine;
+        EXPECT_TRUE(engine.process(makeOrder(Order::Side::BUY, 1, price, 10)).empty());
+        EXPECT_TRUE(engine.process(makeOrder(Order::Side::SELL, 2, price, 4)).size() == 1);
+        EXPECT_EQ(engine.bestBid().visible_qty, 6);
+    }
+}
+
+
+TEST(ProcessBatchTest, MatchesPerOrderProcessing) {
+    std::mt19937 gen(17);
+    std::uniform_int_distribution<int> price_dist(95, 105);
+    std::uniform_int_distribution<int> qty_dist(1, 50);
+    std::vector<Order> orders;
+    for (OrderId id = 1; id <= 2000; ++id)
+        orders.push_back(makeOrder(gen() % 2 ? Order::Side::BUY : Order::Side::SELL, id,
+            static_cast<Price>(price_dist(gen)), qty_dist(gen) * 4, (id % 3) ? 0 : 10));
+
+    MatchingEngine expected_engine;
+    std::stringstream expected;
+    for (const auto& order : orders) {
+        const auto& trades = expected_engine.process(order);
+        if (!trades.empty())
+            expected << expected_engine.sequence() << '\n';
+        Printer::print(trades, expected);
+    }
+
+    MatchingEngine engine;
+    std::stringstream actual;
+    uint64_t last_seq = 0;
+    auto sink = [&](uint64_t seq, std::span<const Trade> trades) {
+        EXPECT_GT(seq, last_seq);
+        last_seq = seq;
+        actual << seq << '\n';
+        for (const auto& trade : trades)
+            Printer::print(trade, actual);
+    };
+    // Split into uneven batches so prefetching crosses batch boundaries
+    size_t trade_count = 0;
+    for (size_t begin = 0; begin < orders.size(); begin += 333)
+        trade_count += engine.processBatch(
+            std::span{orders}.subspan(begin, std::min<size_t>(333, orders.size() - begin)), sink);
+
+    EXPECT_EQ(actual.str(), expected.str());
+    EXPECT_GT(trade_count, 0u);
+    EXPECT_EQ(engine.sequence(), orders.size());
+}
+
+
+TEST(ProcessBatchTest, RingSinkSequencesTrades) {
+    SpscRing<SequencedTrade, 64> ring;
+    TradeRingSink sink(ring);
+    MatchingEngine engine;
+
+    std::vector<Order> orders{
+        makeOrder(Order::Side::SELL, 1, 100, 10),
+        makeOrder(Order::Side::SELL, 2, 101, 10),
+        makeOrder(Order::Side::BUY, 3, 101, 15),
+        makeOrder(Order::Side::BUY, 4, 101, 5)
+    };
+    EXPECT_EQ(engine.processBatch(orders, sink), 3u);
+
+    std::vector<std::pair<uint64_t, OrderId>> received;
+    SequencedTrade trade;
+    while (ring.tryPop(trade))
+        received.emplace_back(trade.seq, trade.trade.sell_id);
+    EXPECT_EQ(received, (std::vector<std::pair<uint64_t, OrderId>>{{3, 1}, {3, 2}, {4, 2}}));
+}
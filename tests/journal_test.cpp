@@ -0,0 +1,271 @@
+#include "../include/journaled_engine.h"
+#include "../include/matching_engine.h"
+#include "../include/order_flow.h"
+#include "../include/printer.h"
+#include "test_orders.h"
+
+#include <gtest/gtest.h>
+#include <csignal>
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__)
+  #include <sys/resource.h>
+#endif
+
+namespace {
+    // Removes the file on both ends so a failed run leaves nothing behind for the next
+    class TempPath {
+    public:
+        explicit TempPath(const std::string& name)
+            : path_((std::filesystem::temp_directory_path() / ("lob_" + name + ".jrnl")).string()) {
+            std::filesystem::remove(path_);
+        }
+        ~TempPath() { std::filesystem::remove(path_); }
+
+        [[nodiscard]] const std::string& str() const noexcept { return path_; }
+
+    private:
+        std::string path_;
+    };
+
+    JournalRecord makeRecord(uint64_t seq, OrderId id) {
+        return JournalRecord{
+            .seq = seq,
+            .kind = JournalRecord::Kind::ORDER,
+            .side = (id % 2) ? Order::Side::SELL : Order::Side::BUY,
+            .type = (id % 3) ? Order::Type::LIMIT : Order::Type::ICEBERG,
+            .tif = static_cast<Order::TimeInForce>((id + 2) % 4),
+            .price = static_cast<Price>(-100 + id),
+            .id = id,
+            .sell_id = 0,
+            .qty = 1000 + id,
+            .peak_qty = 10 + id
+        };
+    }
+
+    void expectRecord(const JournalRecord& record, const JournalRecord& expected) {
+        EXPECT_EQ(record.seq, expected.seq);
+        EXPECT_EQ(record.kind, expected.kind);
+        EXPECT_EQ(record.side, expected.side);
+        EXPECT_EQ(record.type, expected.type);
+        EXPECT_EQ(record.tif, expected.tif);
+        EXPECT_EQ(record.price, expected.price);
+        EXPECT_EQ(record.id, expected.id);
+        EXPECT_EQ(record.sell_id, expected.sell_id);
+        EXPECT_EQ(record.qty, expected.qty);
+        EXPECT_EQ(record.peak_qty, expected.peak_qty);
+    }
+
+#if defined(__linux__)
+    // Caps the size of files this process writes, so growing a journal fails
+    class FileSizeLimit {
+    public:
+        explicit FileSizeLimit(uintmax_t size) {
+            // Exceeding the limit then fails the call instead of killing the process
+            old_handler_ = std::signal(SIGXFSZ, SIG_IGN);
+            ::getrlimit(RLIMIT_FSIZE, &old_limit_);
+            auto limit = old_limit_;
+            limit.rlim_cur = static_cast<rlim_t>(size);
+            ::setrlimit(RLIMIT_FSIZE, &limit);
+        }
+        ~FileSizeLimit() {
+            ::setrlimit(RLIMIT_FSIZE, &old_limit_);
+            std::signal(SIGXFSZ, old_handler_);
+        }
+
+        FileSizeLimit(const FileSizeLimit&) = delete;
+        FileSizeLimit& operator=(const FileSizeLimit&) = delete;
+
+    private:
+        rlimit old_limit_{};
+        void (*old_handler_)(int){nullptr};
+    };
+#endif
+
+    std::string render(const MatchingEngine& engine) {
+        std::ostringstream os;
+        Printer::print(engine, os);
+        return os.str();
+    }
+}
+
+TEST(JournalTest, RoundTripsAndGrows) {
+    TempPath path("round_trip");
+    {
+        // A capacity of 3 makes the file double a few times
+        JournalWriter writer;
+        ASSERT_TRUE(writer.open(path.str(), 3, 2));
+        for (OrderId id = 1; id <= 20; ++id)
+            ASSERT_TRUE(writer.append(makeRecord(static_cast<uint64_t>(id) << 40, id)));
+        EXPECT_EQ(writer.size(), 20);
+    }
+
+    JournalReader reader;
+    ASSERT_TRUE(reader.open(path.str()));
+    JournalRecord record;
+    for (OrderId id = 1; id <= 20; ++id) {
+        ASSERT_TRUE(reader.next(record));
+        expectRecord(record, makeRecord(static_cast<uint64_t>(id) << 40, id));
+    }
+    EXPECT_FALSE(reader.next(record));
+}
+
+TEST(JournalTest, ReopenAppendsAfterLastRecord) {
+    TempPath path("reopen");
+    JournalWriter writer;
+    ASSERT_TRUE(writer.open(path.str(), 16));
+    for (OrderId id = 1; id <= 5; ++id)
+        writer.append(makeRecord(id, id));
+    writer.close();
+
+    ASSERT_TRUE(writer.open(path.str(), 16));
+    EXPECT_EQ(writer.size(), 5);
+    for (OrderId id = 6; id <= 40; ++id)
+        writer.append(makeRecord(id, id));
+    writer.close();
+
+    JournalReader reader;
+    ASSERT_TRUE(reader.open(path.str()));
+    JournalRecord record;
+    for (OrderId id = 1; id <= 40; ++id) {
+        ASSERT_TRUE(reader.next(record));
+        EXPECT_EQ(record.id, id);
+    }
+    EXPECT_FALSE(reader.next(record));
+}
+
+TEST(JournalTest, RejectsForeignFiles) {
+    TempPath path("foreign");
+    {
+        std::FILE* file = std::fopen(path.str().c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        std::string junk(128, 'x');
+        std::fwrite(junk.data(), 1, junk.size(), file);
+        std::fclose(file);
+    }
+    JournalWriter writer;
+    EXPECT_FALSE(writer.open(path.str()));
+    JournalReader reader;
+    EXPECT_FALSE(reader.open(path.str()));
+}
+
+TEST(JournalTest, RecoveryRebuildsTheBook) {
+    TempPath path("recovery");
+    MatchingEngine engine(1 << 14);
+    uint64_t trade_count = 0;
+    {
+        JournalWriter writer;
+        ASSERT_TRUE(writer.open(path.str(), 1024));
+        JournaledEngine journaled(engine, writer);
+
+        OrderFlowParams params;
+        params.iceberg_ratio = 0.2;
+        params.sweep_size_factor = 3.0;
+        OrderFlowGenerator generator(params);
+        for (OrderId id = 1; id <= 5000; ++id) {
+            auto order = generator.next();
+            trade_count += journaled.process(order).size();
+            if (id % 7 == 0)
+                journaled.cancel(id - 3);
+            if (id % 11 == 0)
+                trade_count += journaled.amend(id - 5, order.price, 50).size();
+        }
+    }
+
+    MatchingEngine recovered(1 << 14);
+    JournalReader reader;
+    ASSERT_TRUE(reader.open(path.str()));
+    auto result = recover(reader, recovered);
+    EXPECT_TRUE(result.consistent);
+    EXPECT_EQ(result.messages, engine.sequence());
+    EXPECT_EQ(result.last_seq, engine.sequence());
+    EXPECT_EQ(result.trades, trade_count);
+    EXPECT_GT(result.trades, 0);
+    EXPECT_EQ(recovered.sequence(), engine.sequence());
+    EXPECT_EQ(render(recovered), render(engine));
+}
+
+TEST(JournalTest, RecoveryFlagsDivergentTrades) {
+    TempPath path("divergent");
+    {
+        JournalWriter writer;
+        ASSERT_TRUE(writer.open(path.str()));
+        writer.append(makeRecord(1, 2));
+        auto trade = makeRecord(1, 2);
+        trade.kind = JournalRecord::Kind::TRADE;
+        writer.append(trade);
+    }
+
+    // A lone resting order trades with nothing
+    MatchingEngine engine(16);
+    JournalReader reader;
+    ASSERT_TRUE(reader.open(path.str()));
+    auto result = recover(reader, engine);
+    EXPECT_FALSE(result.consistent);
+    EXPECT_EQ(result.messages, 1);
+    EXPECT_EQ(result.trades, 1);
+    EXPECT_TRUE(engine.contains(2));
+}
+
+#if defined(__linux__)
+TEST(JournalTest, FailedGrowthKeepsTheJournal) {
+    TempPath path("full");
+    JournalWriter writer;
+    ASSERT_TRUE(writer.open(path.str(), 4));
+    {
+        FileSizeLimit limit(std::filesystem::file_size(path.str()));
+        for (OrderId id = 1; id <= 4; ++id)
+            EXPECT_TRUE(writer.append(makeRecord(id, id)));
+        EXPECT_FALSE(writer.append(makeRecord(5, 5)));
+        EXPECT_TRUE(writer.failed());
+        EXPECT_TRUE(writer.isOpen());
+    }
+    // Stays failed once the file could grow again, so nothing follows the gap
+    EXPECT_FALSE(writer.append(makeRecord(5, 5)));
+    writer.close();
+
+    JournalReader reader;
+    ASSERT_TRUE(reader.open(path.str()));
+    JournalRecord record;
+    for (OrderId id = 1; id <= 4; ++id) {
+        ASSERT_TRUE(reader.next(record));
+        expectRecord(record, makeRecord(id, id));
+    }
+    EXPECT_FALSE(reader.next(record));
+}
+#endif
+
+#if defined(__linux__)
+TEST(JournalTest, RejectsMessagesItCantJournal) {
+    TempPath path("rejected");
+    MatchingEngine engine;
+    {
+        JournalWriter writer;
+        ASSERT_TRUE(writer.open(path.str(), 4));
+        JournaledEngine journaled(engine, writer);
+        FileSizeLimit limit(std::filesystem::file_size(path.str()));
+
+        // Resting orders trade nothing, so each takes one record
+        for (OrderId id = 1; id <= 4; ++id)
+            EXPECT_TRUE(journaled.process(makeOrder(Order::Side::BUY, id, 100, 10)).empty());
+        EXPECT_FALSE(journaled.failed());
+        EXPECT_TRUE(journaled.process(makeOrder(Order::Side::SELL, 5, 100, 10)).empty());
+        EXPECT_TRUE(journaled.failed());
+        EXPECT_FALSE(journaled.cancel(1));
+        EXPECT_TRUE(journaled.amend(2, 100, 5).empty());
+    }
+    EXPECT_EQ(engine.sequence(), 4);
+    EXPECT_EQ(engine.orderCount(), 4);
+    EXPECT_TRUE(engine.contains(1));
+
+    MatchingEngine recovered;
+    JournalReader reader;
+    ASSERT_TRUE(reader.open(path.str()));
+    auto result = recover(reader, recovered);
+    EXPECT_TRUE(result.consistent);
+    EXPECT_EQ(result.messages, 4);
+    EXPECT_EQ(render(recovered), render(engine));
+}
+#endif
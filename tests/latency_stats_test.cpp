@@ -0,0 +1,75 @@
+#include "../include/matching_engine.h"
+#include "test_orders.h"
+
+#include <gtest/gtest.h>
+
+TEST(LatencyHistogramTest, PercentilesWithinBucketError) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.percentile(0.5), 0u);
+
+    for (uint64_t value = 1; value <= 10000; ++value)
+        histogram.record(value);
+    EXPECT_EQ(histogram.count(), 10000u);
+    EXPECT_EQ(histogram.max(), 10000u);
+
+    for (double quantile : {0.5, 0.9, 0.99, 0.999}) {
+        auto exact = static_cast<double>(quantile * 10000);
+        auto reported = static_cast<double>(histogram.percentile(quantile));
+        EXPECT_GE(reported, exact);
+        EXPECT_LE(reported, exact * (1.0 + 1.0 / 32));
+    }
+    EXPECT_EQ(histogram.percentile(1.0), 10000u);
+
+    // Small values get exact buckets
+    histogram.reset();
+    histogram.record(7);
+    EXPECT_EQ(histogram.percentile(0.5), 7u);
+
+    histogram.record(UINT64_MAX);
+    EXPECT_EQ(histogram.percentile(1.0), UINT64_MAX);
+}
+
+TEST(LatencyStatsTest, CountsWorkPerMessage) {
+    InstrumentedMatchingEngine engine;
+    engine.process(makeOrder(Order::Side::SELL, 1, 100, 10));
+    engine.process(makeOrder(Order::Side::SELL, 2, 100, 10));
+    engine.process(makeOrder(Order::Side::SELL, 3, 101, 10));
+    engine.process(makeOrder(Order::Side::SELL, 4, 102, 30, 10));
+
+    // Fills orders 1-3 and the first peak of the iceberg, refilling it once
+    engine.process(makeOrder(Order::Side::BUY, 5, 102, 40));
+
+    const auto& stats = engine.stats();
+    EXPECT_EQ(stats.latency(Probe::PROCESS).count(), 5u);
+    EXPECT_EQ(stats.latency(Probe::MATCH).count(), 5u);
+    EXPECT_EQ(stats.latency(Probe::CONSUME_BEST).count(), 4u);
+
+    EXPECT_EQ(stats.levelsTouched().max(), 3u);
+    EXPECT_EQ(stats.ordersFilled().max(), 3u);
+    EXPECT_EQ(stats.icebergRefills().max(), 1u);
+    EXPECT_GT(stats.slowestMessage().latency_ns, 0u);
+
+    // Passive messages touch nothing
+    EXPECT_EQ(stats.levelsTouched().percentile(0.5), 0u);
+}
+
+TEST(LatencyStatsTest, TimesCancelsAndAmends) {
+    InstrumentedMatchingEngine engine;
+    engine.process(makeOrder(Order::Side::SELL, 1, 100, 10));
+    engine.process(makeOrder(Order::Side::SELL, 2, 101, 10));
+    engine.process(makeOrder(Order::Side::BUY, 3, 99, 10));
+    EXPECT_TRUE(engine.cancel(1));
+    EXPECT_FALSE(engine.cancel(1));
+
+    // Repricing the bid through the ask fills order 2
+    engine.amend(3, 101, 10);
+
+    const auto& stats = engine.stats();
+    EXPECT_EQ(stats.latency(Probe::PROCESS).count(), 3u);
+    EXPECT_EQ(stats.latency(Probe::CANCEL).count(), 2u);
+    EXPECT_EQ(stats.latency(Probe::AMEND).count(), 1u);
+    EXPECT_EQ(stats.levelsTouched().count(), 6u);
+    EXPECT_EQ(stats.ordersFilled().max(), 1u);
+}
+
+static_assert(!MatchingEngine::Stats::ENABLED);
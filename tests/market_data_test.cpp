@@ -0,0 +1,124 @@
+#include "../include/market_data.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr size_t DEPTH = 5;
+    using View = BasicMarketDataView<DefaultOrderTraits, DEPTH>;
+    using BookTop = View::BookTop;
+
+    bool sameLevel(const LevelDepth& lhs, const LevelDepth& rhs) {
+        return lhs.price == rhs.price && lhs.visible_qty == rhs.visible_qty &&
+            lhs.hidden_qty == rhs.hidden_qty && lhs.order_count == rhs.order_count;
+    }
+
+    bool sameTop(const BookTop& lhs, const BookTop& rhs) {
+        if (lhs.seq != rhs.seq || lhs.bid_count != rhs.bid_count
+            || lhs.ask_count != rhs.ask_count)
+            return false;
+        for (size_t idx = 0; idx < DEPTH; ++idx)
+            if (!sameLevel(lhs.bids[idx], rhs.bids[idx])
+                || !sameLevel(lhs.asks[idx], rhs.asks[idx]))
+                return false;
+        return true;
+    }
+
+    // Every field follows from the sequence number, so a copy mixing two
+    // publishes can't pass for either
+    BookTop makeTop(uint64_t seq) {
+        BookTop top{};
+        top.seq = seq;
+        top.bid_count = static_cast<uint32_t>(seq % (DEPTH + 1));
+        top.ask_count = static_cast<uint32_t>((seq * 7) % (DEPTH + 1));
+        for (uint32_t idx = 0; idx < top.bid_count; ++idx)
+            top.bids[idx] = LevelDepth{.price = static_cast<Price>(seq - idx),
+                .visible_qty = static_cast<Quantity>(seq), .hidden_qty = static_cast<Quantity>(idx),
+                .order_count = idx + 1};
+        for (uint32_t idx = 0; idx < top.ask_count; ++idx)
+            top.asks[idx] = LevelDepth{.price = static_cast<Price>(seq + idx + 1),
+                .visible_qty = static_cast<Quantity>(seq * 3), .hidden_qty = 0,
+                .order_count = idx + 2};
+        return top;
+    }
+}
+
+TEST(MarketDataViewTest, MatchesEngineTopN) {
+    View view;
+    auto initial = view.read();
+    EXPECT_EQ(initial.seq, 0);
+    EXPECT_EQ(initial.bid_count, 0);
+    EXPECT_EQ(initial.ask_count, 0);
+
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> price_dist(95, 105);
+    std::uniform_int_distribution<int> qty_dist(1, 100);
+    MatchingEngine engine;
+    for (OrderId id = 1; id <= 3000; ++id) {
+        if (id % 4 == 0) {
+            engine.cancel(static_cast<OrderId>(gen() % id));
+        } else {
+            auto qty = qty_dist(gen);
+            engine.process(Order{
+                .side = (gen() % 2) ? Order::Side::BUY : Order::Side::SELL,
+                .type = Order::Type::LIMIT,
+                .id = id,
+                .price = static_cast<Price>(price_dist(gen)),
+                .visible_qty = qty,
+                .peak_qty = qty,
+                .hidden_qty = 0
+            });
+        }
+        view.publish(engine);
+
+        BookTop expected{};
+        expected.seq = engine.sequence();
+        expected.bid_count = static_cast<uint32_t>(
+            engine.topN(Order::Side::BUY, std::span{expected.bids}));
+        expected.ask_count = static_cast<uint32_t>(
+            engine.topN(Order::Side::SELL, std::span{expected.asks}));
+        ASSERT_TRUE(sameTop(view.read(), expected)) << "after message " << expected.seq;
+        EXPECT_EQ(view.version() % 2, 0);
+    }
+}
+
+TEST(MarketDataViewTest, ReadersNeverSeeTornSnapshots) {
+    constexpr uint64_t PUBLISH_COUNT = 500'000;
+    constexpr int READER_COUNT = 3;
+    auto view = std::make_unique<View>();
+    std::atomic<bool> failed{false};
+    std::atomic<uint64_t> reads{0};
+
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < READER_COUNT; ++reader) {
+        readers.emplace_back([&view, &failed, &reads] {
+            uint64_t last_seq = 0;
+            uint64_t read_count = 0;
+            while (last_seq < PUBLISH_COUNT) {
+                BookTop top;
+                if (!view->tryRead(top))
+                    continue;
+                ++read_count;
+                if (top.seq < last_seq || !sameTop(top, makeTop(top.seq))) {
+                    failed.store(true);
+                    return;
+                }
+                last_seq = top.seq;
+            }
+            reads.fetch_add(read_count);
+        });
+    }
+
+    for (uint64_t seq = 1; seq <= PUBLISH_COUNT; ++seq)
+        view->publish(makeTop(seq));
+    for (auto& reader : readers)
+        reader.join();
+
+    EXPECT_FALSE(failed.load());
+    EXPECT_GE(reads.load(), READER_COUNT);
+    EXPECT_EQ(view->version(), 2 * PUBLISH_COUNT);
+}
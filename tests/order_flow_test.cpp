@@ -0,0 +1,85 @@
+#include "../include/order_flow.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <vector>
+
+namespace {
+    std::vector<Order> generate(const OrderFlowParams& params, size_t count) {
+        OrderFlowGenerator generator(params);
+        std::vector<Order> orders;
+        for (size_t idx = 0; idx < count; ++idx)
+            orders.push_back(generator.next());
+        return orders;
+    }
+
+    bool sameOrder(const Order& lhs, const Order& rhs) {
+        return lhs.side == rhs.side && lhs.type == rhs.type && lhs.id == rhs.id
+            && lhs.price == rhs.price && lhs.visible_qty == rhs.visible_qty
+            && lhs.peak_qty == rhs.peak_qty && lhs.hidden_qty == rhs.hidden_qty;
+    }
+}
+
+TEST(OrderFlowTest, SameSeedSameFlow) {
+    OrderFlowParams params;
+    params.iceberg_ratio = 0.3;
+    auto first = generate(params, 5000);
+    auto second = generate(params, 5000);
+    for (size_t idx = 0; idx < first.size(); ++idx)
+        ASSERT_TRUE(sameOrder(first[idx], second[idx])) << idx;
+
+    params.seed = 2;
+    auto other = generate(params, 5000);
+    size_t same_count = 0;
+    for (size_t idx = 0; idx < first.size(); ++idx)
+        same_count += sameOrder(first[idx], other[idx]);
+    EXPECT_LT(same_count, first.size() / 10);
+}
+
+TEST(OrderFlowTest, PricesFollowTheMid) {
+    OrderFlowParams params;
+    params.price_range = 10;
+    params.sweep_depth = 2;
+    params.walk_probability = 0.5;
+    params.iceberg_ratio = 0.5;
+
+    OrderFlowGenerator generator(params);
+    for (OrderId id = 1; id <= 20000; ++id) {
+        auto order = generator.next();
+        auto mid = generator.midPrice();
+        ASSERT_EQ(order.id, id);
+        ASSERT_GE(order.price, mid - params.price_range);
+        ASSERT_LE(order.price, mid + 1 + params.price_range);
+        ASSERT_GT(order.visible_qty, 0);
+        ASSERT_LE(order.visible_qty, order.peak_qty);
+        if (order.type == Order::Type::LIMIT) {
+            ASSERT_EQ(order.hidden_qty, 0);
+        }
+    }
+}
+
+TEST(OrderFlowTest, WritesReplayFile) {
+    OrderFlowParams params;
+    params.iceberg_ratio = 0.3;
+    auto expected = generate(params, 3000);
+
+    for (auto format : {OrderFormat::CSV, OrderFormat::BINARY}) {
+        auto* file = std::tmpfile();
+        {
+            OrderFlowGenerator generator(params);
+            OrderWriter writer(file, format);
+            generator.write(writer, expected.size());
+        }
+        std::rewind(file);
+
+        OrderReader reader(file, format);
+        Order order;
+        size_t count = 0;
+        while (reader.next(order)) {
+            ASSERT_LT(count, expected.size());
+            EXPECT_TRUE(sameOrder(order, expected[count++]));
+        }
+        EXPECT_EQ(count, expected.size());
+        std::fclose(file);
+    }
+}
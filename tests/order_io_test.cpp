@@ -0,0 +1,219 @@
+#include "../include/order_io.h"
+#include "../include/util.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+    std::FILE* makeInput(std::string_view contents) {
+        auto* file = std::tmpfile();
+        std::fwrite(contents.data(), 1, contents.size(), file);
+        std::rewind(file);
+        return file;
+    }
+
+    std::vector<Order> readAll(std::FILE* file, OrderFormat format, size_t buffer_size) {
+        OrderReader reader(file, format, buffer_size);
+        std::vector<Order> orders;
+        Order order;
+        while (reader.next(order))
+            orders.push_back(order);
+        return orders;
+    }
+
+    void expectOrder(const Order& order, Order::Side side, Order::Type type, OrderId id,
+        Price price, Quantity visible_qty, Quantity peak_qty, Quantity hidden_qty) {
+        EXPECT_EQ(order.side, side);
+        EXPECT_EQ(order.type, type);
+        EXPECT_EQ(order.id, id);
+        EXPECT_EQ(order.price, price);
+        EXPECT_EQ(order.visible_qty, visible_qty);
+        EXPECT_EQ(order.peak_qty, peak_qty);
+        EXPECT_EQ(order.hidden_qty, hidden_qty);
+    }
+}
+
+TEST(OrderIoTest, ReadsCsv) {
+    // A tiny buffer forces lines to straddle refills
+    for (size_t buffer_size : {size_t{1}, size_t{7}, OrderReader::DEFAULT_BUFFER_SIZE}) {
+        auto* file = makeInput(
+            "# comment\n"
+            "B,100322,5103,7500\r\n"
+            "\n"
+            " S , 100345 , 5103 , 100000 , 10000 \n"
+            "S,7,-5,3");
+        auto orders = readAll(file, OrderFormat::CSV, buffer_size);
+        std::fclose(file);
+
+        ASSERT_EQ(orders.size(), 3);
+        expectOrder(orders[0], Order::Side::BUY, Order::Type::LIMIT, 100322, 5103, 7500, 7500, 0);
+        expectOrder(orders[1], Order::Side::SELL, Order::Type::ICEBERG, 100345, 5103,
+            10000, 10000, 90000);
+        expectOrder(orders[2], Order::Side::SELL, Order::Type::LIMIT, 7, -5, 3, 3, 0);
+    }
+}
+
+TEST(OrderIoTest, ReadsCsvOrderTypes) {
+    auto* file = makeInput(
+        "B,1,0,5,MKT,IOC\n"
+        "S,2,10,50,20 , POST\n"
+        "S,3,10,5,MKT\n"
+        "B,4,10,5,DAY\n"
+        "B,5,10,5,20,MKT\n"
+        "B,6,11,5,FOK\n"
+        "S,7,0,5,MKT,STOP,95\n"
+        "B,8,102,50,10,STOP,101,IOC\n"
+        "B,9,102,50,STOP\n");
+    auto orders = readAll(file, OrderFormat::CSV, OrderReader::DEFAULT_BUFFER_SIZE);
+    std::fclose(file);
+
+    // Unknown words, a market iceberg and a stop without its price are rejected
+    ASSERT_EQ(orders.size(), 6);
+    expectOrder(orders[0], Order::Side::BUY, Order::Type::MARKET, 1, 0, 5, 5, 0);
+    EXPECT_EQ(orders[0].tif, Order::TimeInForce::IOC);
+    expectOrder(orders[1], Order::Side::SELL, Order::Type::ICEBERG, 2, 10, 20, 20, 30);
+    EXPECT_EQ(orders[1].tif, Order::TimeInForce::POST_ONLY);
+    expectOrder(orders[2], Order::Side::SELL, Order::Type::MARKET, 3, 10, 5, 5, 0);
+    EXPECT_EQ(orders[2].tif, Order::TimeInForce::GTC);
+    expectOrder(orders[3], Order::Side::BUY, Order::Type::LIMIT, 6, 11, 5, 5, 0);
+    EXPECT_EQ(orders[3].tif, Order::TimeInForce::FOK);
+    expectOrder(orders[4], Order::Side::SELL, Order::Type::STOP, 7, 0, 5, 5, 0);
+    EXPECT_EQ(orders[4].stop_price, 95);
+    expectOrder(orders[5], Order::Side::BUY, Order::Type::STOP_LIMIT, 8, 102, 10, 10, 40);
+    EXPECT_EQ(orders[5].stop_price, 101);
+    EXPECT_EQ(orders[5].tif, Order::TimeInForce::IOC);
+}
+
+TEST(OrderIoTest, RoundTrips) {
+    std::vector<Order> orders{
+        Order{Order::Side::BUY, Order::Type::LIMIT, Order::TimeInForce::GTC, 1, 100, 0, 50, 50, 0},
+        Order{Order::Side::SELL, Order::Type::ICEBERG, Order::TimeInForce::POST_ONLY,
+            2147483647, -32768, 0, 10, 10, 90},
+        Order{Order::Side::BUY, Order::Type::ICEBERG, Order::TimeInForce::IOC,
+            3, 32767, 0, 7, 10, 0},
+        Order{Order::Side::SELL, Order::Type::MARKET, Order::TimeInForce::FOK, 4, 0, 0, 20, 20, 0},
+        Order{Order::Side::BUY, Order::Type::STOP, Order::TimeInForce::GTC, 5, 0, -7, 20, 20, 0},
+        Order{Order::Side::SELL, Order::Type::STOP_LIMIT, Order::TimeInForce::IOC,
+            6, 98, 99, 5, 5, 15}
+    };
+
+    for (auto format : {OrderFormat::CSV, OrderFormat::BINARY}) {
+        auto* file = std::tmpfile();
+        {
+            OrderWriter writer(file, format, 1);
+            for (const auto& order : orders)
+                writer.write(order);
+        }
+        std::rewind(file);
+        auto read_orders = readAll(file, format, 40);
+        std::fclose(file);
+
+        ASSERT_EQ(read_orders.size(), orders.size());
+        for (size_t idx = 0; idx < orders.size(); ++idx) {
+            const auto& order = orders[idx];
+            auto total_qty = order.visible_qty + order.hidden_qty;
+            auto visible_qty = std::min(total_qty, order.peak_qty);
+            expectOrder(read_orders[idx], order.side, order.type, order.id, order.price,
+                visible_qty, order.peak_qty, total_qty - visible_qty);
+            EXPECT_EQ(read_orders[idx].tif, order.tif);
+            EXPECT_EQ(read_orders[idx].stop_price, order.stop_price);
+        }
+    }
+}
+
+TEST(OrderIoTest, SkipsInvalidBinaryRecords) {
+    Order order{Order::Side::SELL, Order::Type::ICEBERG, Order::TimeInForce::IOC,
+        7, 100, 0, 10, 10, 40};
+    char valid[order_io::BINARY_RECORD_SIZE];
+    order_io::encodeBinary(order, valid);
+
+    // Each one breaks a single field: the enums, then values that don't fit in Order
+    std::vector<std::string> records;
+    auto corrupt = [&records, &valid](auto&& change) {
+        std::string record(valid, sizeof(valid));
+        change(record.data());
+        records.push_back(record);
+    };
+    corrupt([](char* record) { record[0] = 2; });
+    corrupt([](char* record) { record[1] = 5; });
+    corrupt([](char* record) { record[2] = 4; });
+    corrupt([](char* record) { storeLittleEndian<int32_t>(40000, record + 4); });
+    corrupt([](char* record) { storeLittleEndian<int64_t>(int64_t{1} << 31, record + 8); });
+    corrupt([](char* record) { storeLittleEndian<int64_t>(-(int64_t{1} << 40), record + 16); });
+    corrupt([](char* record) { storeLittleEndian<int64_t>(int64_t{1} << 32, record + 24); });
+    corrupt([](char* record) { storeLittleEndian<int32_t>(-40000, record + 32); });
+
+    Order decoded;
+    std::string input;
+    for (const auto& record : records) {
+        EXPECT_FALSE(order_io::decodeBinary(record.data(), decoded));
+        input += record;
+        input.append(valid, sizeof(valid));
+    }
+    auto* file = makeInput(input);
+    auto orders = readAll(file, OrderFormat::BINARY, OrderReader::DEFAULT_BUFFER_SIZE);
+    std::fclose(file);
+
+    ASSERT_EQ(orders.size(), records.size());
+    for (const auto& read_order : orders) {
+        expectOrder(read_order, Order::Side::SELL, Order::Type::ICEBERG, 7, 100, 10, 10, 40);
+        EXPECT_EQ(read_order.tif, Order::TimeInForce::IOC);
+    }
+}
+
+TEST(OrderIoTest, ReadsCancelsAndAmends) {
+    std::vector<OrderMessage> messages{
+        OrderMessage{.kind = OrderMessage::Kind::ORDER, .order = Order{Order::Side::BUY,
+            Order::Type::ICEBERG, Order::TimeInForce::GTC, 1, 100, 0, 10, 10, 40}},
+        OrderMessage{.kind = OrderMessage::Kind::CANCEL, .order = Order{Order::Side::BUY,
+            Order::Type::LIMIT, Order::TimeInForce::GTC, 2147483647, 0, 0, 0, 0, 0}},
+        OrderMessage{.kind = OrderMessage::Kind::AMEND, .order = Order{Order::Side::BUY,
+            Order::Type::LIMIT, Order::TimeInForce::GTC, 3, -32768, 0, 25, 25, 0}}
+    };
+
+    for (auto format : {OrderFormat::CSV, OrderFormat::BINARY}) {
+        auto* file = std::tmpfile();
+        {
+            OrderWriter writer(file, format, 1);
+            for (const auto& message : messages)
+                writer.write(message);
+        }
+
+        std::rewind(file);
+        OrderReader reader(file, format, 40);
+        std::vector<OrderMessage> read_messages;
+        for (OrderMessage message; reader.next(message);)
+            read_messages.push_back(message);
+        ASSERT_EQ(read_messages.size(), messages.size());
+        for (size_t idx = 0; idx < messages.size(); ++idx) {
+            EXPECT_EQ(read_messages[idx].kind, messages[idx].kind);
+            EXPECT_EQ(read_messages[idx].order.id, messages[idx].order.id);
+            EXPECT_EQ(read_messages[idx].order.price, messages[idx].order.price);
+            EXPECT_EQ(read_messages[idx].order.visible_qty, messages[idx].order.visible_qty);
+        }
+
+        // Readers of plain orders pass over the rest
+        std::rewind(file);
+        auto orders = readAll(file, format, 40);
+        std::fclose(file);
+        ASSERT_EQ(orders.size(), 1);
+        expectOrder(orders[0], Order::Side::BUY, Order::Type::ICEBERG, 1, 100, 10, 10, 40);
+    }
+
+    OrderMessage message;
+    std::string_view amend = " A , 7 , 101 , 30 ";
+    ASSERT_TRUE(order_io::parseCsv(amend.data(), amend.data() + amend.size(), message));
+    EXPECT_EQ(message.kind, OrderMessage::Kind::AMEND);
+    EXPECT_EQ(message.order.id, 7);
+    EXPECT_EQ(message.order.price, 101);
+    EXPECT_EQ(message.order.visible_qty, 30);
+    std::string_view cancel_without_id = "C";
+    EXPECT_FALSE(order_io::parseCsv(
+        cancel_without_id.data(), cancel_without_id.data() + cancel_without_id.size(), message));
+    std::string_view amend_without_qty = "A,7,101";
+    EXPECT_FALSE(order_io::parseCsv(
+        amend_without_qty.data(), amend_without_qty.data() + amend_without_qty.size(), message));
+}
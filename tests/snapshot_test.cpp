@@ -0,0 +1,294 @@
+#include "../include/journaled_engine.h"
+#include "../include/matching_engine.h"
+#include "../include/order_flow.h"
+#include "../include/printer.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    template <class Engine>
+    std::string render(const Engine& engine) {
+        std::ostringstream os;
+        Printer::print(engine, os);
+        return os.str();
+    }
+
+    template <class Engine>
+    std::vector<Order> restingOrders(const Engine& engine) {
+        std::vector<Order> orders(engine.buyBegin(), engine.buyEnd());
+        orders.insert(std::end(orders), engine.sellBegin(), engine.sellEnd());
+        return orders;
+    }
+
+    bool sameOrder(const Order& lhs, const Order& rhs) {
+        return lhs.side == rhs.side && lhs.type == rhs.type && lhs.id == rhs.id
+            && lhs.price == rhs.price && lhs.visible_qty == rhs.visible_qty
+            && lhs.peak_qty == rhs.peak_qty && lhs.hidden_qty == rhs.hidden_qty;
+    }
+
+    template <class Engine>
+    void fill(Engine& engine, size_t count) {
+        OrderFlowParams params;
+        params.iceberg_ratio = 0.3;
+        OrderFlowGenerator generator(params);
+        for (size_t idx = 0; idx < count; ++idx)
+            engine.process(generator.next());
+    }
+
+    template <class Engine>
+    std::FILE* save(const Engine& engine) {
+        auto* file = std::tmpfile();
+        EXPECT_TRUE(engine.saveSnapshot(file));
+        std::rewind(file);
+        return file;
+    }
+}
+
+template <class Engine>
+void checkRoundTrip() {
+    Engine engine;
+    fill(engine, 20000);
+    // Partly filled icebergs carry their own peak and hidden quantities
+    auto resting = restingOrders(engine);
+    ASSERT_TRUE(std::any_of(std::begin(resting), std::end(resting), [](const Order& order) {
+        return order.type == Order::Type::ICEBERG && order.hidden_qty > 0
+            && order.visible_qty < order.peak_qty;
+    }));
+
+    auto* file = save(engine);
+    Engine loaded;
+    ASSERT_TRUE(loaded.loadSnapshot(file));
+    std::fclose(file);
+
+    EXPECT_EQ(loaded.sequence(), engine.sequence());
+    auto loaded_resting = restingOrders(loaded);
+    ASSERT_EQ(loaded_resting.size(), resting.size());
+    for (size_t idx = 0; idx < resting.size(); ++idx)
+        ASSERT_TRUE(sameOrder(loaded_resting[idx], resting[idx])) << idx;
+    for (auto side : {Order::Side::BUY, Order::Side::SELL}) {
+        auto depth = engine.topN(side, 1000);
+        auto loaded_depth = loaded.topN(side, 1000);
+        ASSERT_EQ(loaded_depth.size(), depth.size());
+        for (size_t idx = 0; idx < depth.size(); ++idx) {
+            EXPECT_EQ(loaded_depth[idx].price, depth[idx].price);
+            EXPECT_EQ(loaded_depth[idx].visible_qty, depth[idx].visible_qty);
+            EXPECT_EQ(loaded_depth[idx].hidden_qty, depth[idx].hidden_qty);
+            EXPECT_EQ(loaded_depth[idx].order_count, depth[idx].order_count);
+        }
+    }
+
+    // Both keep matching the same way afterwards
+    OrderFlowParams params;
+    params.seed = 7;
+    params.aggressive_ratio = 0.5;
+    params.sweep_size_factor = 5.0;
+    OrderFlowGenerator generator(params);
+    for (int idx = 0; idx < 2000; ++idx) {
+        auto order = generator.next();
+        order.id += 1000000;
+        const auto& trades = engine.process(order);
+        const auto& loaded_trades = loaded.process(order);
+        ASSERT_EQ(loaded_trades.size(), trades.size());
+        for (size_t trade_idx = 0; trade_idx < trades.size(); ++trade_idx) {
+            EXPECT_EQ(loaded_trades[trade_idx].buy_id, trades[trade_idx].buy_id);
+            EXPECT_EQ(loaded_trades[trade_idx].sell_id, trades[trade_idx].sell_id);
+            EXPECT_EQ(loaded_trades[trade_idx].qty, trades[trade_idx].qty);
+        }
+    }
+    EXPECT_EQ(render(loaded), render(engine));
+}
+
+TEST(SnapshotTest, RoundTripsTheBook) {
+    checkRoundTrip<MatchingEngine>();
+    checkRoundTrip<LadderMatchingEngine>();
+    checkRoundTrip<RingMatchingEngine>();
+}
+
+TEST(SnapshotTest, RoundTripsAnEmptyBook) {
+    MatchingEngine engine;
+    engine.cancel(1);
+    auto* file = save(engine);
+    MatchingEngine loaded;
+    ASSERT_TRUE(loaded.loadSnapshot(file));
+    std::fclose(file);
+    EXPECT_EQ(loaded.sequence(), 1);
+    EXPECT_EQ(loaded.bestBid().order_count, 0);
+    EXPECT_EQ(loaded.bestAsk().order_count, 0);
+}
+
+TEST(SnapshotTest, RejectsBadSnapshots) {
+    MatchingEngine engine;
+    fill(engine, 1000);
+    // A stop far above the book, so it waits
+    engine.process(Order{
+        .side = Order::Side::BUY,
+        .type = Order::Type::STOP,
+        .id = 1'000'000,
+        .price = 0,
+        .stop_price = std::numeric_limits<Price>::max(),
+        .visible_qty = 10,
+        .peak_qty = 10,
+        .hidden_qty = 0
+    });
+    ASSERT_EQ(engine.stopCount(), 1u);
+    auto* file = save(engine);
+    std::string bytes(1 << 20, '\0');
+    bytes.resize(std::fread(bytes.data(), 1, bytes.size(), file));
+    std::fclose(file);
+
+    auto load = [](const std::string& snapshot) {
+        auto* file = std::tmpfile();
+        std::fwrite(snapshot.data(), 1, snapshot.size(), file);
+        std::rewind(file);
+        MatchingEngine loaded;
+        bool ok = loaded.loadSnapshot(file);
+        std::fclose(file);
+        EXPECT_TRUE(ok || (loaded.sequence() == 0 && loaded.bestBid().order_count == 0));
+        return ok;
+    };
+    EXPECT_TRUE(load(bytes));
+    EXPECT_FALSE(load(bytes.substr(0, bytes.size() - 1)));
+    EXPECT_FALSE(load(bytes.substr(0, snapshot_io::HEADER_SIZE - 1)));
+
+    auto bad_version = bytes;
+    bad_version[8] = static_cast<char>(snapshot_io::VERSION + 1);
+    EXPECT_FALSE(load(bad_version));
+
+    // Giving the first bid level the price of the second breaks the price order
+    auto level_bytes = snapshot_io::LEVEL_HEADER_SIZE;
+    auto first = bytes.data() + snapshot_io::HEADER_SIZE;
+    auto second_offset = level_bytes + snapshot_io::decodeLevelOrderCount(first) * snapshot_io::ORDER_SIZE;
+    auto out_of_order = bytes;
+    std::copy_n(bytes.data() + snapshot_io::HEADER_SIZE + second_offset, 4,
+        out_of_order.data() + snapshot_io::HEADER_SIZE);
+    EXPECT_FALSE(load(out_of_order));
+
+    // Giving the first order of the second bid level, or the stop, the id of the
+    // first bid order makes it appear twice
+    constexpr size_t ID_OFFSET = 4;
+    const auto* first_id = first + level_bytes + ID_OFFSET;
+    auto repeated_order = bytes;
+    std::copy_n(first_id, 4,
+        repeated_order.data() + snapshot_io::HEADER_SIZE + second_offset + level_bytes + ID_OFFSET);
+    EXPECT_FALSE(load(repeated_order));
+    auto repeated_stop = bytes;
+    std::copy_n(first_id, 4,
+        repeated_stop.data() + repeated_stop.size() - snapshot_io::STOP_SIZE + ID_OFFSET);
+    EXPECT_FALSE(load(repeated_stop));
+
+    // Fields a save never writes: a price Price can't hold, an unknown type or
+    // time in force, and more shown than the peak
+    auto patched = [&](size_t offset, int32_t value) {
+        auto snapshot = bytes;
+        storeLittleEndian(value, snapshot.data() + offset);
+        return snapshot;
+    };
+    auto first_order = snapshot_io::HEADER_SIZE + level_bytes;
+    EXPECT_FALSE(load(patched(snapshot_io::HEADER_SIZE, 1 << 20)));
+    EXPECT_FALSE(load(patched(48, 1 << 20)));  // the last trade price
+    auto unknown_type = bytes;
+    unknown_type[first_order] = static_cast<char>(Order::Type::MARKET);
+    EXPECT_FALSE(load(unknown_type));
+    auto unknown_tif = bytes;
+    unknown_tif[first_order + 1] = 9;
+    EXPECT_FALSE(load(unknown_tif));
+    auto first_peak = loadLittleEndian<int32_t>(bytes.data() + first_order + 12);
+    EXPECT_FALSE(load(patched(first_order + 8, first_peak + 1)));
+}
+
+TEST(SnapshotTest, RoundTripsStops) {
+    MatchingEngine engine;
+    fill(engine, 5000);
+    // Stops on both sides of the last trade, some limits and some icebergs
+    for (OrderId id = 1'000'000; id < 1'000'200; ++id) {
+        auto order = engine.bestBid();
+        Order stop{
+            .side = (id % 2) ? Order::Side::BUY : Order::Side::SELL,
+            .type = (id % 3) ? Order::Type::STOP : Order::Type::STOP_LIMIT,
+            .tif = (id % 5) ? Order::TimeInForce::GTC : Order::TimeInForce::IOC,
+            .id = id,
+            .price = order.price,
+            .stop_price = static_cast<Price>(order.price + ((id % 2) ? 20 : -20) + id % 7),
+            .visible_qty = 10,
+            .peak_qty = 10,
+            .hidden_qty = (id % 4) ? 0 : 30
+        };
+        engine.process(stop);
+    }
+    auto stop_count = engine.stopCount();
+    ASSERT_GT(stop_count, 0u);
+
+    auto* file = save(engine);
+    MatchingEngine loaded;
+    ASSERT_TRUE(loaded.loadSnapshot(file));
+    std::fclose(file);
+    EXPECT_EQ(loaded.stopCount(), engine.stopCount());
+
+    // Sweeping both sides fires the same stops in the same order
+    for (auto side : {Order::Side::BUY, Order::Side::SELL}) {
+        Order sweep{
+            .side = side,
+            .type = Order::Type::MARKET,
+            .id = 2'000'000 + static_cast<OrderId>(side),
+            .price = 0,
+            .visible_qty = 1'000'000,
+            .peak_qty = 1'000'000,
+            .hidden_qty = 0
+        };
+        auto trades = engine.process(sweep);
+        auto loaded_trades = loaded.process(sweep);
+        ASSERT_EQ(loaded_trades.size(), trades.size());
+        for (size_t idx = 0; idx < trades.size(); ++idx) {
+            EXPECT_EQ(loaded_trades[idx].buy_id, trades[idx].buy_id);
+            EXPECT_EQ(loaded_trades[idx].sell_id, trades[idx].sell_id);
+            EXPECT_EQ(loaded_trades[idx].price, trades[idx].price);
+            EXPECT_EQ(loaded_trades[idx].qty, trades[idx].qty);
+        }
+    }
+    EXPECT_LT(engine.stopCount(), stop_count);
+    EXPECT_EQ(loaded.stopCount(), engine.stopCount());
+    EXPECT_EQ(render(loaded), render(engine));
+}
+
+TEST(SnapshotTest, SnapshotPlusJournalTailMatchesFullReplay) {
+    auto path = (std::filesystem::temp_directory_path() / "lob_snapshot_tail.jrnl").string();
+    std::filesystem::remove(path);
+
+    MatchingEngine engine(1 << 14);
+    std::FILE* snapshot = nullptr;
+    {
+        JournalWriter writer;
+        ASSERT_TRUE(writer.open(path));
+        JournaledEngine journaled(engine, writer);
+        OrderFlowParams params;
+        params.iceberg_ratio = 0.2;
+        OrderFlowGenerator generator(params);
+        for (int idx = 0; idx < 6000; ++idx) {
+            if (idx == 4000)
+                snapshot = save(engine);
+            journaled.process(generator.next());
+        }
+    }
+
+    MatchingEngine recovered(1 << 14);
+    ASSERT_TRUE(recovered.loadSnapshot(snapshot));
+    std::fclose(snapshot);
+    EXPECT_EQ(recovered.sequence(), 4000);
+
+    JournalReader reader;
+    ASSERT_TRUE(reader.open(path));
+    auto result = recover(reader, recovered);
+    EXPECT_TRUE(result.consistent);
+    EXPECT_EQ(result.messages, 2000);
+    EXPECT_EQ(result.last_seq, 6000);
+    EXPECT_EQ(render(recovered), render(engine));
+    reader.close();
+    std::filesystem::remove(path);
+}